@@ -26,6 +26,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
@@ -80,6 +81,41 @@ std::error_code collectReplacementsFromDirectory(
   return ErrorCode;
 }
 
+/// \brief Splits a stream of YAML documents into the individual documents.
+///
+/// Documents are separated by lines starting with the '---' directives end
+/// marker, which can't appear at the start of a line inside a document. The
+/// buffer is only scanned, not parsed, so the documents can be deserialized
+/// independently of each other.
+static void splitDocuments(StringRef Buffer,
+                           SmallVectorImpl<StringRef> &Documents) {
+  size_t Begin = 0;
+  for (size_t Pos = 0; Pos < Buffer.size();) {
+    size_t LineEnd = std::min(Buffer.find('\n', Pos), Buffer.size());
+    StringRef Line = Buffer.slice(Pos, LineEnd);
+    if ((Line.rtrim() == "---" || Line.startswith("--- ")) &&
+        !Buffer.slice(Begin, Pos).trim().empty()) {
+      Documents.push_back(Buffer.slice(Begin, Pos));
+      Begin = Pos;
+    }
+    Pos = LineEnd + 1;
+  }
+  if (!Buffer.drop_front(Begin).trim().empty())
+    Documents.push_back(Buffer.drop_front(Begin));
+}
+
+namespace {
+/// \brief A YAML document of a diagnostics file and the result of
+/// deserializing it.
+struct DiagnosticsDocument {
+  explicit DiagnosticsDocument(StringRef Text) : Text(Text), Parsed(false) {}
+
+  StringRef Text;
+  tooling::TranslationUnitDiagnostics TU;
+  bool Parsed;
+};
+} // end anonymous namespace
+
 std::error_code
 collectReplacementsFromDirectory(const llvm::StringRef Directory,
                                  TUDiagnostics &TUs, TUReplacementFiles &TUFiles,
@@ -89,6 +125,7 @@ collectReplacementsFromDirectory(const llvm::StringRef Directory,
 
   std::error_code ErrorCode;
 
+  size_t FirstFile = TUFiles.size();
   for (recursive_directory_iterator I(Directory, ErrorCode), E;
        I != E && !ErrorCode; I.increment(ErrorCode)) {
     if (filename(I->path())[0] == '.') {
@@ -101,27 +138,55 @@ collectReplacementsFromDirectory(const llvm::StringRef Directory,
       continue;
 
     TUFiles.push_back(I->path());
+  }
 
+  // A file can contain a stream of documents, one per translation unit, which
+  // are written by clang-tidy as soon as each translation unit is processed.
+  // The files are mapped and split into their documents up front, which only
+  // scans for document markers, and every document is then deserialized as a
+  // separate task.
+  ArrayRef<std::string> Files = makeArrayRef(TUFiles).drop_front(FirstFile);
+  std::vector<std::unique_ptr<MemoryBuffer>> Buffers;
+  std::vector<std::vector<DiagnosticsDocument>> FileDocuments(Files.size());
+  for (size_t I = 0, E = Files.size(); I != E; ++I) {
     ErrorOr<std::unique_ptr<MemoryBuffer>> Out =
-        MemoryBuffer::getFile(I->path());
+        MemoryBuffer::getFile(Files[I]);
     if (std::error_code BufferError = Out.getError()) {
-      errs() << "Error reading " << I->path() << ": " << BufferError.message()
+      errs() << "Error reading " << Files[I] << ": " << BufferError.message()
              << "\n";
       continue;
     }
+    SmallVector<StringRef, 4> Documents;
+    splitDocuments(Out.get()->getBuffer(), Documents);
+    for (StringRef Text : Documents)
+      FileDocuments[I].emplace_back(Text);
+    Buffers.push_back(std::move(Out.get()));
+  }
 
-    yaml::Input YIn(Out.get()->getBuffer(), nullptr, &eatDiagnostics);
-    tooling::TranslationUnitDiagnostics TU;
-    YIn >> TU;
-    if (YIn.error()) {
-      // File doesn't appear to be a header change description. Ignore it.
-      continue;
-    }
-
-    // Only keep files that properly parse.
-    TUs.push_back(TU);
+  {
+    ThreadPool Pool;
+    for (std::vector<DiagnosticsDocument> &Documents : FileDocuments)
+      for (DiagnosticsDocument &Document : Documents)
+        Pool.async([&Document] {
+          yaml::Input YIn(Document.Text, nullptr, &eatDiagnostics);
+          YIn >> Document.TU;
+          Document.Parsed = !YIn.error();
+        });
+    Pool.wait();
   }
 
+  // Merge the results in the order of the traversal to keep the output
+  // deterministic.
+  for (std::vector<DiagnosticsDocument> &Documents : FileDocuments)
+    for (DiagnosticsDocument &Document : Documents) {
+      // Document doesn't appear to be a change description. Ignore it and the
+      // rest of the file.
+      if (!Document.Parsed)
+        break;
+      // Only keep documents that properly parse.
+      TUs.push_back(std::move(Document.TU));
+    }
+
   return ErrorCode;
 }
 
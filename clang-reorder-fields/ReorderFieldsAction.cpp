@@ -96,10 +96,10 @@ addReplacement(SourceRange Old, SourceRange New, const ASTContext &Context,
 /// At the moment reodering of fields with
 /// different accesses (public/protected/private) is not supported.
 /// \returns true on success.
-static bool reorderFieldsInDefinition(
-    const CXXRecordDecl *Definition, ArrayRef<unsigned> NewFieldsOrder,
-    const ASTContext &Context,
-    std::map<std::string, tooling::Replacements> &Replacements) {
+static bool reorderFieldsInDefinition(const CXXRecordDecl *Definition,
+                                      ArrayRef<unsigned> NewFieldsOrder,
+                                      RangeReplacer Replace,
+                                      raw_ostream &ErrorOS) {
   assert(Definition && "Definition is null");
 
   SmallVector<const FieldDecl *, 10> Fields;
@@ -110,8 +110,8 @@ static bool reorderFieldsInDefinition(
   for (const auto *Field : Definition->fields()) {
     const auto FieldIndex = Field->getFieldIndex();
     if (Field->getAccess() != Fields[NewFieldsOrder[FieldIndex]]->getAccess()) {
-      llvm::errs() << "Currently reodering of fields with different accesses "
-                      "is not supported\n";
+      ErrorOS << "Currently reodering of fields with different accesses "
+                 "is not supported\n";
       return false;
     }
   }
@@ -120,9 +120,8 @@ static bool reorderFieldsInDefinition(
     const auto FieldIndex = Field->getFieldIndex();
     if (FieldIndex == NewFieldsOrder[FieldIndex])
       continue;
-    addReplacement(Field->getSourceRange(),
-                   Fields[NewFieldsOrder[FieldIndex]]->getSourceRange(),
-                   Context, Replacements);
+    Replace(Field->getSourceRange(),
+            Fields[NewFieldsOrder[FieldIndex]]->getSourceRange());
   }
   return true;
 }
@@ -131,10 +130,9 @@ static bool reorderFieldsInDefinition(
 ///
 /// A constructor can have initializers for an arbitrary subset of the class's fields.
 /// Thus, we need to ensure that we reorder just the initializers that are present.
-static void reorderFieldsInConstructor(
-    const CXXConstructorDecl *CtorDecl, ArrayRef<unsigned> NewFieldsOrder,
-    const ASTContext &Context,
-    std::map<std::string, tooling::Replacements> &Replacements) {
+static void reorderFieldsInConstructor(const CXXConstructorDecl *CtorDecl,
+                                       ArrayRef<unsigned> NewFieldsOrder,
+                                       RangeReplacer Replace) {
   assert(CtorDecl && "Constructor declaration is null");
   if (CtorDecl->isImplicit() || CtorDecl->getNumCtorInitializers() <= 1)
     return;
@@ -168,19 +166,18 @@ static void reorderFieldsInConstructor(
          NewWrittenInitializersOrder.size());
   for (unsigned i = 0, e = NewWrittenInitializersOrder.size(); i < e; ++i)
     if (OldWrittenInitializersOrder[i] != NewWrittenInitializersOrder[i])
-      addReplacement(OldWrittenInitializersOrder[i]->getSourceRange(),
-                     NewWrittenInitializersOrder[i]->getSourceRange(), Context,
-                     Replacements);
+      Replace(OldWrittenInitializersOrder[i]->getSourceRange(),
+              NewWrittenInitializersOrder[i]->getSourceRange());
 }
 
 /// \brief Reorders initializers in the brace initialization of an aggregate.
 ///
 /// At the moment partial initialization is not supported.
 /// \returns true on success
-static bool reorderFieldsInInitListExpr(
-    const InitListExpr *InitListEx, ArrayRef<unsigned> NewFieldsOrder,
-    const ASTContext &Context,
-    std::map<std::string, tooling::Replacements> &Replacements) {
+static bool reorderFieldsInInitListExpr(const InitListExpr *InitListEx,
+                                        ArrayRef<unsigned> NewFieldsOrder,
+                                        RangeReplacer Replace,
+                                        raw_ostream &ErrorOS) {
   assert(InitListEx && "Init list expression is null");
   // We care only about InitListExprs which originate from source code. 
   // Implicit InitListExprs are created by the semantic analyzer.
@@ -194,15 +191,38 @@ static bool reorderFieldsInInitListExpr(
   if (!InitListEx->getNumInits())
     return true;
   if (InitListEx->getNumInits() != NewFieldsOrder.size()) {
-    llvm::errs() << "Currently only full initialization is supported\n";
+    ErrorOS << "Currently only full initialization is supported\n";
     return false;
   }
   for (unsigned i = 0, e = InitListEx->getNumInits(); i < e; ++i)
     if (i != NewFieldsOrder[i])
-      addReplacement(
-          InitListEx->getInit(i)->getSourceRange(),
-          InitListEx->getInit(NewFieldsOrder[i])->getSourceRange(), Context,
-          Replacements);
+      Replace(InitListEx->getInit(i)->getSourceRange(),
+              InitListEx->getInit(NewFieldsOrder[i])->getSourceRange());
+  return true;
+}
+
+bool reorderFields(const CXXRecordDecl *Definition,
+                   ArrayRef<unsigned> NewFieldsOrder, ASTContext &Context,
+                   RangeReplacer Replace, raw_ostream &ErrorOS) {
+  if (!reorderFieldsInDefinition(Definition, NewFieldsOrder, Replace, ErrorOS))
+    return false;
+  for (const auto *C : Definition->ctors())
+    if (const auto *D =
+            dyn_cast_or_null<CXXConstructorDecl>(C->getDefinition()))
+      reorderFieldsInConstructor(D, NewFieldsOrder, Replace);
+
+  // We only need to reorder init list expressions for aggregate types.
+  // For other types the order of constructor parameters is used,
+  // which we don't change at the moment.
+  // Now (v0) partial initialization is not supported.
+  if (Definition->isAggregate())
+    for (auto Result : match(
+             initListExpr(hasType(equalsNode(Definition))).bind("initListExpr"),
+             Context))
+      if (!reorderFieldsInInitListExpr(
+              Result.getNodeAs<InitListExpr>("initListExpr"), NewFieldsOrder,
+              Replace, ErrorOS))
+        return false;
   return true;
 }
 
@@ -230,27 +250,11 @@ public:
         getNewFieldsOrder(RD, DesiredFieldsOrder);
     if (NewFieldsOrder.empty())
       return;
-    if (!reorderFieldsInDefinition(RD, NewFieldsOrder, Context, Replacements))
-      return;
-    for (const auto *C : RD->ctors())
-      if (const auto *D = dyn_cast<CXXConstructorDecl>(C->getDefinition()))
-        reorderFieldsInConstructor(cast<const CXXConstructorDecl>(D),
-                                   NewFieldsOrder, Context, Replacements);
-
-    // We only need to reorder init list expressions for aggregate types.
-    // For other types the order of constructor parameters is used,
-    // which we don't change at the moment.
-    // Now (v0) partial initialization is not supported.
-    if (RD->isAggregate())
-      for (auto Result :
-           match(initListExpr(hasType(equalsNode(RD))).bind("initListExpr"),
-                 Context))
-        if (!reorderFieldsInInitListExpr(
-                Result.getNodeAs<InitListExpr>("initListExpr"), NewFieldsOrder,
-                Context, Replacements)) {
-          Replacements.clear();
-          return;
-        }
+    auto Replace = [&](SourceRange Old, SourceRange New) {
+      addReplacement(Old, New, Context, Replacements);
+    };
+    if (!reorderFields(RD, NewFieldsOrder, Context, Replace, llvm::errs()))
+      Replacements.clear();
   }
 };
 } // end anonymous namespace
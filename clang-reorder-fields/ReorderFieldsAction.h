@@ -9,20 +9,44 @@
 ///
 /// \file
 /// This file contains the declarations of the ReorderFieldsAction class and
-/// the FieldPosition struct.
+/// the reorderFields function.
 ///
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_REORDER_FIELDS_ACTION_H
 #define LLVM_CLANG_TOOLS_EXTRA_CLANG_REORDER_FIELDS_ACTION_H
 
+#include "clang/Basic/SourceLocation.h"
 #include "clang/Tooling/Refactoring.h"
+#include "llvm/ADT/STLExtras.h"
 
 namespace clang {
 class ASTConsumer;
+class ASTContext;
+class CXXRecordDecl;
 
 namespace reorder_fields {
 
+/// \brief Called to replace the source range \p Old by the source text of the
+/// range \p New.
+typedef llvm::function_ref<void(SourceRange Old, SourceRange New)>
+    RangeReplacer;
+
+/// \brief Computes the source changes which permute the fields of
+/// \p Definition, its constructor initializer lists and the brace
+/// initializations of the record.
+///
+/// The I-th element of \p NewFieldsOrder is the index of the field to be
+/// placed at position I.
+///
+/// \returns false if the permutation is not supported, with the reason written
+/// to \p ErrorOS. \p Replace may have been called already in that case, so the
+/// caller should discard the changes.
+bool reorderFields(const CXXRecordDecl *Definition,
+                   llvm::ArrayRef<unsigned> NewFieldsOrder,
+                   ASTContext &Context, RangeReplacer Replace,
+                   llvm::raw_ostream &ErrorOS);
+
 class ReorderFieldsAction {
   llvm::StringRef RecordName;
   llvm::ArrayRef<std::string> DesiredFieldsOrder;
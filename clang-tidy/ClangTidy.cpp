@@ -39,11 +39,22 @@
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/ReplacementsYaml.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
 #include <algorithm>
+#include <chrono>
+#include <set>
 #include <utility>
 
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
 using namespace clang::ast_matchers;
 using namespace clang::driver;
 using namespace clang::tooling;
@@ -267,13 +278,136 @@ class ClangTidyASTConsumer : public MultiplexConsumer {
 public:
   ClangTidyASTConsumer(std::vector<std::unique_ptr<ASTConsumer>> Consumers,
                        std::unique_ptr<ast_matchers::MatchFinder> Finder,
-                       std::vector<std::unique_ptr<ClangTidyCheck>> Checks)
+                       std::vector<std::unique_ptr<ClangTidyCheck>> Checks,
+                       ClangTidyContext &Context, Preprocessor &PP)
       : MultiplexConsumer(std::move(Consumers)), Finder(std::move(Finder)),
-        Checks(std::move(Checks)) {}
+        Checks(std::move(Checks)), Context(Context), PP(PP) {}
+
+  void HandleTranslationUnit(ASTContext &Ctx) override {
+    MultiplexConsumer::HandleTranslationUnit(Ctx);
+    // Later translation units can skip the headers analyzed here, unless the
+    // analysis was incomplete.
+    if (!Ctx.getDiagnostics().hasUncompilableErrorOccurred())
+      Context.markHeadersAnalyzed(Ctx.getSourceManager(),
+                                  PP.getHeaderSearchInfo());
+  }
 
 private:
   std::unique_ptr<ast_matchers::MatchFinder> Finder;
   std::vector<std::unique_ptr<ClangTidyCheck>> Checks;
+  ClangTidyContext &Context;
+  Preprocessor &PP;
+};
+
+// Records the preprocessor state each header of the translation unit depends
+// on: the headers included before it, and the definitions of the macros it
+// uses which aren't defined by the header itself. Together with the analysis
+// configuration this identifies how the header was expanded, so a header is
+// only deduplicated against translation units which expand it the same way.
+class HeaderInclusionStateCollector : public PPCallbacks {
+public:
+  HeaderInclusionStateCollector(ClangTidyContext &Context, Preprocessor &PP)
+      : Context(Context), PP(PP), SM(PP.getSourceManager()) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile) {
+      FileID FID = SM.getFileID(Loc);
+      const FileEntry *File = SM.getFileEntryForID(FID);
+      if (!File || FID == SM.getMainFileID())
+        return;
+      States[FID].IncludedBefore = IncludedHeaders;
+      IncludedHeaders += File->getName();
+      IncludedHeaders += '\n';
+    } else if (Reason == ExitFile) {
+      // The code of a header depends on everything the headers it includes
+      // depend on.
+      auto Exited = States.find(PrevFID);
+      auto Including = States.find(SM.getFileID(Loc));
+      if (Exited != States.end() && Including != States.end())
+        Including->second.MacroDependencies.insert(
+            Exited->second.MacroDependencies.begin(),
+            Exited->second.MacroDependencies.end());
+    }
+  }
+
+  void MacroExpands(const Token &MacroNameTok, const MacroDefinition &MD,
+                    SourceRange Range, const MacroArgs *Args) override {
+    addMacroDependency(MacroNameTok, MD.getMacroInfo());
+  }
+
+  void Defined(const Token &MacroNameTok, const MacroDefinition &MD,
+               SourceRange Range) override {
+    addMacroDependency(MacroNameTok, MD.getMacroInfo());
+  }
+
+  void Ifdef(SourceLocation Loc, const Token &MacroNameTok,
+             const MacroDefinition &MD) override {
+    addMacroDependency(MacroNameTok, MD.getMacroInfo());
+  }
+
+  void Ifndef(SourceLocation Loc, const Token &MacroNameTok,
+              const MacroDefinition &MD) override {
+    addMacroDependency(MacroNameTok, MD.getMacroInfo());
+  }
+
+  void MacroDefined(const Token &MacroNameTok,
+                    const MacroDirective *MD) override {
+    // A header testing a macro it defines itself, like its include guard,
+    // doesn't depend on the macro being undefined before.
+    auto State = States.find(SM.getFileID(MacroNameTok.getLocation()));
+    if (State != States.end())
+      State->second.MacroDependencies.erase(
+          "!" + MacroNameTok.getIdentifierInfo()->getName().str());
+  }
+
+  void EndOfMainFile() override {
+    llvm::DenseMap<FileID, std::string> InclusionStates;
+    for (const auto &State : States) {
+      std::string &InclusionState = InclusionStates[State.first];
+      InclusionState = State.second.IncludedBefore;
+      for (const std::string &Dependency : State.second.MacroDependencies)
+        InclusionState += Dependency + '\n';
+    }
+    Context.setHeaderInclusionStates(std::move(InclusionStates));
+  }
+
+private:
+  struct HeaderState {
+    std::string IncludedBefore;
+    std::set<std::string> MacroDependencies;
+  };
+
+  void addMacroDependency(const Token &MacroNameTok, const MacroInfo *MI) {
+    FileID FID = SM.getFileID(SM.getExpansionLoc(MacroNameTok.getLocation()));
+    auto State = States.find(FID);
+    if (State == States.end() || (MI && MI->isBuiltinMacro()))
+      return;
+    std::string Dependency = MacroNameTok.getIdentifierInfo()->getName();
+    if (!MI) {
+      State->second.MacroDependencies.insert("!" + Dependency);
+      return;
+    }
+    if (SM.getFileID(SM.getExpansionLoc(MI->getDefinitionLoc())) == FID)
+      return;
+    if (MI->isFunctionLike()) {
+      Dependency += '(';
+      for (auto I = MI->arg_begin(), E = MI->arg_end(); I != E; ++I)
+        Dependency += (*I)->getName().str() + ',';
+      Dependency += ')';
+    }
+    Dependency += '=';
+    for (const Token &Tok : MI->tokens())
+      Dependency += PP.getSpelling(Tok) + ' ';
+    State->second.MacroDependencies.insert(std::move(Dependency));
+  }
+
+  ClangTidyContext &Context;
+  Preprocessor &PP;
+  const SourceManager &SM;
+  std::string IncludedHeaders;
+  llvm::DenseMap<FileID, HeaderState> States;
 };
 
 } // namespace
@@ -348,6 +482,25 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
   if (WorkingDir)
     Context.setCurrentBuildDirectory(WorkingDir.get());
 
+  if (Context.getGlobalOptions().DeduplicateHeaders) {
+    // Everything that can change the analysis of a header: the compiler
+    // options (language options, macros, header search, target) and the
+    // clang-tidy options of this translation unit.
+    const ClangTidyOptions &Opts = Context.getOptions();
+    std::string Configuration = Compiler.getInvocation().getModuleHash();
+    Configuration += '\n' + *Opts.Checks + '\n' + *Opts.WarningsAsErrors +
+                     '\n' + *Opts.HeaderFilterRegex + '\n' +
+                     (*Opts.SystemHeaders ? "1" : "0");
+    for (const auto &Option : Opts.CheckOptions)
+      Configuration += '\n' + Option.first + '=' + Option.second;
+    Context.setAnalysisConfiguration(Configuration);
+    // The preprocessor state at the inclusion point of each header is added
+    // to its key separately.
+    Compiler.getPreprocessor().addPPCallbacks(
+        llvm::make_unique<HeaderInclusionStateCollector>(
+            Context, Compiler.getPreprocessor()));
+  }
+
   std::vector<std::unique_ptr<ClangTidyCheck>> Checks;
   CheckFactories->createChecks(&Context, Checks);
 
@@ -387,7 +540,8 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
     Consumers.push_back(std::move(AnalysisConsumer));
   }
   return llvm::make_unique<ClangTidyASTConsumer>(
-      std::move(Consumers), std::move(Finder), std::move(Checks));
+      std::move(Consumers), std::move(Finder), std::move(Checks), Context,
+      Compiler.getPreprocessor());
 }
 
 std::vector<std::string> ClangTidyASTConsumerFactory::getCheckNames() {
@@ -418,8 +572,63 @@ DiagnosticBuilder ClangTidyCheck::diag(SourceLocation Loc, StringRef Message,
   return Context->diag(CheckName, Loc, Message, Level);
 }
 
+// Returns true if Node is a part of a template instantiation, which depends on
+// the template arguments provided by the including file. Nodes which can't be
+// attributed to a declaration are conservatively treated as instantiations.
+static bool isInTemplateInstantiation(ASTContext &Ctx,
+                                      ast_type_traits::DynTypedNode Node) {
+  while (!Node.get<Decl>()) {
+    auto Parents = Ctx.getParents(Node);
+    if (Parents.empty())
+      return true;
+    Node = Parents[0];
+  }
+  const Decl *D = Node.get<Decl>();
+  if (const auto *VD = dyn_cast<VarDecl>(D)) {
+    if (clang::isTemplateInstantiation(VD->getTemplateSpecializationKind()))
+      return true;
+  }
+  const DeclContext *DC =
+      isa<DeclContext>(D) ? cast<DeclContext>(D) : D->getDeclContext();
+  for (; DC; DC = DC->getParent()) {
+    if (const auto *FD = dyn_cast<FunctionDecl>(DC)) {
+      if (FD->isTemplateInstantiation())
+        return true;
+    } else if (const auto *RD = dyn_cast<CXXRecordDecl>(DC)) {
+      if (clang::isTemplateInstantiation(RD->getTemplateSpecializationKind()))
+        return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if all nodes bound by the match are located in headers which
+// have already been analyzed under the current configuration.
+static bool
+isMatchInAnalyzedHeaders(ClangTidyContext &Context,
+                         const ast_matchers::MatchFinder::MatchResult &Result) {
+  const auto &Nodes = Result.Nodes.getMap();
+  if (Nodes.empty())
+    return false;
+  const SourceManager &SM = *Result.SourceManager;
+  for (const auto &IDAndNode : Nodes) {
+    SourceLocation Loc = IDAndNode.second.getSourceRange().getBegin();
+    if (Loc.isInvalid() ||
+        !Context.isHeaderAnalyzed(SM, SM.getDecomposedExpansionLoc(Loc).first))
+      return false;
+  }
+  for (const auto &IDAndNode : Nodes) {
+    if (isInTemplateInstantiation(*Result.Context, IDAndNode.second))
+      return false;
+  }
+  return true;
+}
+
 void ClangTidyCheck::run(const ast_matchers::MatchFinder::MatchResult &Result) {
   Context->setSourceManager(Result.SourceManager);
+  if (isIndependentOfIncludingFile() &&
+      isMatchInAnalyzedHeaders(*Context, Result))
+    return;
   check(Result);
 }
 
@@ -472,9 +681,159 @@ ClangTidyOptions::OptionMap getCheckOptions(const ClangTidyOptions &Options) {
   return Factory.getCheckOptions();
 }
 
+std::error_code readTimingHistory(StringRef Path,
+                                  TranslationUnitTimings &Timings) {
+  llvm::ErrorOr<std::unique_ptr<MemoryBuffer>> Text =
+      MemoryBuffer::getFile(Path);
+  if (std::error_code EC = Text.getError())
+    return EC;
+  SmallVector<StringRef, 128> Lines;
+  Text.get()->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    std::pair<StringRef, StringRef> SecondsAndFile =
+        Line.rtrim('\r').split('\t');
+    double Seconds;
+    if (SecondsAndFile.second.empty() ||
+        SecondsAndFile.first.getAsDouble(Seconds) || Seconds < 0)
+      continue;
+    Timings.Seconds[SecondsAndFile.second] = Seconds;
+  }
+  return std::error_code();
+}
+
+std::error_code writeTimingHistory(StringRef Path,
+                                   const TranslationUnitTimings &Timings) {
+  // Write to a temporary file next to the history and rename it, so that
+  // concurrently running shards never read a partially written history.
+  int FD;
+  SmallString<256> TempPath;
+  if (std::error_code EC = llvm::sys::fs::createUniqueFile(
+          Path + "-%%%%%%.tmp", FD, TempPath))
+    return EC;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    // Sort the entries to keep the file stable between runs.
+    std::vector<StringRef> Files;
+    for (const auto &Entry : Timings.Seconds)
+      Files.push_back(Entry.getKey());
+    std::sort(Files.begin(), Files.end());
+    for (StringRef File : Files)
+      OS << llvm::format("%.3f", Timings.Seconds.lookup(File)) << '\t' << File
+         << '\n';
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return std::make_error_code(std::errc::io_error);
+    }
+  }
+  if (std::error_code EC = llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return EC;
+  }
+  return std::error_code();
+}
+
+std::string getTimingHistoryKey(StringRef File, StringRef WorkingDir) {
+  SmallString<256> Path(File);
+  if (!llvm::sys::path::is_absolute(Path)) {
+    if (WorkingDir.empty()) {
+      llvm::sys::fs::make_absolute(Path);
+    } else {
+      SmallString<256> Absolute(WorkingDir);
+      llvm::sys::path::append(Absolute, Path);
+      Path = Absolute;
+    }
+  }
+  llvm::sys::path::remove_dots(Path, /*remove_dot_dot=*/true);
+  return Path.str();
+}
+
+bool parseShard(StringRef Value, unsigned &ShardIndex, unsigned &ShardCount) {
+  std::pair<StringRef, StringRef> IndexAndCount = Value.split('/');
+  if (IndexAndCount.first.trim().getAsInteger(10, ShardIndex) ||
+      IndexAndCount.second.trim().getAsInteger(10, ShardCount))
+    return false;
+  return ShardCount > 0 && ShardIndex < ShardCount;
+}
+
+std::vector<std::string> scheduleByCost(ArrayRef<std::string> Files,
+                                        const TranslationUnitTimings &History,
+                                        unsigned ShardIndex,
+                                        unsigned ShardCount) {
+  assert(ShardCount > 0 && ShardIndex < ShardCount && "Invalid shard");
+
+  // Predict the cost of each file. Unknown files cost the average of the known
+  // ones, or the same for all files if there is no history at all.
+  struct FileCost {
+    double Cost;
+    std::string Key;
+    std::string File;
+  };
+  std::vector<FileCost> Costs;
+  std::vector<bool> Known;
+  double KnownTotal = 0;
+  unsigned KnownCount = 0;
+  for (const std::string &File : Files) {
+    std::string Key = getTimingHistoryKey(File);
+    auto It = History.Seconds.find(Key);
+    Known.push_back(It != History.Seconds.end());
+    Costs.push_back({Known.back() ? It->second : 0.0, std::move(Key), File});
+    if (Known.back()) {
+      KnownTotal += It->second;
+      ++KnownCount;
+    }
+  }
+  double DefaultCost = KnownCount ? KnownTotal / KnownCount : 1.0;
+  for (unsigned I = 0, E = Costs.size(); I != E; ++I) {
+    if (!Known[I])
+      Costs[I].Cost = DefaultCost;
+  }
+
+  // Most expensive first; ties are broken by the normalized path for
+  // determinism, like run-clang-tidy.py does.
+  std::sort(Costs.begin(), Costs.end(),
+            [](const FileCost &LHS, const FileCost &RHS) {
+              if (LHS.Cost != RHS.Cost)
+                return LHS.Cost > RHS.Cost;
+              return LHS.Key < RHS.Key;
+            });
+
+  std::vector<double> ShardCosts(ShardCount, 0.0);
+  std::vector<std::string> Result;
+  for (const FileCost &Cost : Costs) {
+    unsigned Shard = std::min_element(ShardCosts.begin(), ShardCosts.end()) -
+                     ShardCosts.begin();
+    ShardCosts[Shard] += Cost.Cost;
+    if (Shard == ShardIndex)
+      Result.push_back(Cost.File);
+  }
+  return Result;
+}
+
+size_t getPeakResidentMemory() {
+#ifdef LLVM_ON_UNIX
+  struct rusage Usage;
+  if (::getrusage(RUSAGE_SELF, &Usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return Usage.ru_maxrss;
+#else
+  // Linux and the BSDs report kilobytes.
+  return static_cast<size_t>(Usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
 void runClangTidy(clang::tidy::ClangTidyContext &Context,
                   const CompilationDatabase &Compilations,
-                  ArrayRef<std::string> InputFiles, ProfileData *Profile) {
+                  ArrayRef<std::string> InputFiles, ProfileData *Profile,
+                  TranslationUnitTimings *Timings,
+                  raw_ostream *ExportFixesOS,
+                  std::vector<TranslationUnitMemoryUsage> *MemoryUsage) {
   ClangTool Tool(Compilations, InputFiles);
 
   // Add extra arguments passed by the clang-tidy command-line.
@@ -522,26 +881,128 @@ void runClangTidy(clang::tidy::ClangTidyContext &Context,
 
   class ActionFactory : public FrontendActionFactory {
   public:
-    ActionFactory(ClangTidyContext &Context) : ConsumerFactory(Context) {}
-    FrontendAction *create() override { return new Action(&ConsumerFactory); }
+    ActionFactory(ClangTidyContext &Context, TranslationUnitTimings *Timings,
+                  raw_ostream *ExportFixesOS,
+                  std::vector<TranslationUnitMemoryUsage> *MemoryUsage)
+        : ConsumerFactory(Context), Context(Context), Timings(Timings),
+          ExportFixesOS(ExportFixesOS), MemoryUsage(MemoryUsage),
+          ExportedErrors(0) {}
+    FrontendAction *create() override {
+      return new Action(&ConsumerFactory, Timings, MemoryUsage);
+    }
+
+    bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
+                       FileManager *Files,
+                       std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                       DiagnosticConsumer *DiagConsumer) override {
+      SmallString<256> MainFile;
+      if (!Invocation->getFrontendOpts().Inputs.empty())
+        MainFile = Invocation->getFrontendOpts().Inputs[0].getFile();
+      bool Success = FrontendActionFactory::runInvocation(
+          std::move(Invocation), Files, std::move(PCHContainerOps),
+          DiagConsumer);
+      // The diagnostic consumer has flushed the errors of this translation
+      // unit to the context by now. Stream them out instead of keeping the
+      // whole run in one document.
+      if (ExportFixesOS) {
+        ArrayRef<ClangTidyError> Errors =
+            Context.getErrors().drop_front(ExportedErrors);
+        if (!Errors.empty()) {
+          Files->makeAbsolutePath(MainFile);
+          exportReplacements(MainFile, Errors, *ExportFixesOS);
+          ExportFixesOS->flush();
+        }
+        ExportedErrors = Context.getErrors().size();
+      }
+      return Success;
+    }
 
   private:
     class Action : public ASTFrontendAction {
     public:
-      Action(ClangTidyASTConsumerFactory *Factory) : Factory(Factory) {}
+      Action(ClangTidyASTConsumerFactory *Factory,
+             TranslationUnitTimings *Timings,
+             std::vector<TranslationUnitMemoryUsage> *MemoryUsage)
+          : Factory(Factory), Timings(Timings), MemoryUsage(MemoryUsage),
+            StartHeap(0), StartPeakRSS(0) {}
       std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &Compiler,
                                                      StringRef File) override {
+        if (Timings || MemoryUsage) {
+          auto WorkingDir = Compiler.getSourceManager()
+                                .getFileManager()
+                                .getVirtualFileSystem()
+                                ->getCurrentWorkingDirectory();
+          MainFile =
+              getTimingHistoryKey(File, WorkingDir ? *WorkingDir : "");
+        }
+        if (Timings)
+          StartTime = std::chrono::steady_clock::now();
+        if (MemoryUsage) {
+          StartHeap = llvm::sys::Process::GetMallocUsage();
+          StartPeakRSS = getPeakResidentMemory();
+        }
         return Factory->CreateASTConsumer(Compiler, File);
       }
 
+      void EndSourceFileAction() override {
+        if (MainFile.empty())
+          return;
+        if (Timings) {
+          std::chrono::duration<double> Elapsed =
+              std::chrono::steady_clock::now() - StartTime;
+          // A file can be compiled with several commands; sum them up.
+          Timings->Seconds[MainFile] += Elapsed.count();
+        }
+        if (MemoryUsage)
+          recordMemoryUsage();
+      }
+
     private:
+      // The AST and the source buffers are still alive at this point; they
+      // are released only after EndSourceFileAction() returns.
+      void recordMemoryUsage() {
+        CompilerInstance &Compiler = getCompilerInstance();
+        TranslationUnitMemoryUsage Usage;
+        Usage.File = MainFile;
+        if (Compiler.hasASTContext()) {
+          ASTContext &AST = Compiler.getASTContext();
+          Usage.ASTBytes =
+              AST.getASTAllocatedMemory() + AST.getSideTableAllocatedMemory();
+        }
+        if (Compiler.hasSourceManager()) {
+          SourceManager &Sources = Compiler.getSourceManager();
+          SourceManager::MemoryBufferSizes Buffers =
+              Sources.getMemoryBufferSizes();
+          Usage.SourceManagerBytes = Buffers.malloc_bytes +
+                                     Buffers.mmap_bytes +
+                                     Sources.getDataStructureSizes();
+        }
+        size_t EndHeap = llvm::sys::Process::GetMallocUsage();
+        size_t EndPeakRSS = getPeakResidentMemory();
+        Usage.HeapGrowthBytes = EndHeap > StartHeap ? EndHeap - StartHeap : 0;
+        Usage.PeakRSSGrowthBytes =
+            EndPeakRSS > StartPeakRSS ? EndPeakRSS - StartPeakRSS : 0;
+        MemoryUsage->push_back(std::move(Usage));
+      }
+
       ClangTidyASTConsumerFactory *Factory;
+      TranslationUnitTimings *Timings;
+      std::vector<TranslationUnitMemoryUsage> *MemoryUsage;
+      std::string MainFile;
+      std::chrono::steady_clock::time_point StartTime;
+      size_t StartHeap;
+      size_t StartPeakRSS;
     };
 
     ClangTidyASTConsumerFactory ConsumerFactory;
+    ClangTidyContext &Context;
+    TranslationUnitTimings *Timings;
+    raw_ostream *ExportFixesOS;
+    std::vector<TranslationUnitMemoryUsage> *MemoryUsage;
+    size_t ExportedErrors;
   };
 
-  ActionFactory Factory(Context);
+  ActionFactory Factory(Context, Timings, ExportFixesOS, MemoryUsage);
   Tool.run(&Factory);
 }
 
@@ -571,8 +1032,7 @@ void handleErrors(ClangTidyContext &Context, bool Fix,
 }
 
 void exportReplacements(const llvm::StringRef MainFilePath,
-                        const std::vector<ClangTidyError> &Errors,
-                        raw_ostream &OS) {
+                        ArrayRef<ClangTidyError> Errors, raw_ostream &OS) {
   TranslationUnitDiagnostics TUD;
   TUD.MainSourceFile = MainFilePath;
   for (const auto &Error : Errors) {
@@ -173,6 +173,17 @@ public:
   /// whether it has the default value or it has been overridden.
   virtual void storeOptions(ClangTidyOptions::OptionMap &Options) {}
 
+  /// \brief Override this to return \c true if matches located in a header
+  /// can be analyzed independently of the translation unit including it.
+  ///
+  /// When header deduplication is enabled, matches of such checks are skipped
+  /// if all bound nodes are located in headers that have already been analyzed
+  /// by an earlier translation unit under the same configuration. Matches in
+  /// template instantiations are never skipped. Checks that collect state over
+  /// the whole translation unit or depend on the main file must not override
+  /// this.
+  virtual bool isIndependentOfIncludingFile() const { return false; }
+
 private:
   void run(const ast_matchers::MatchFinder::MatchResult &Result) override;
   StringRef getID() const override { return CheckName; }
@@ -220,14 +231,89 @@ std::vector<std::string> getCheckNames(const ClangTidyOptions &Options);
 /// Options.
 ClangTidyOptions::OptionMap getCheckOptions(const ClangTidyOptions &Options);
 
+/// \brief Wall time in seconds spent on each translation unit, keyed by the
+/// absolute path of its main file.
+///
+/// The timings are kept in a history file between runs, so that expensive
+/// translation units can be scheduled first and shards can be balanced by
+/// their predicted cost.
+struct TranslationUnitTimings {
+  llvm::StringMap<double> Seconds;
+};
+
+/// \brief Reads timings from the history file at \p Path and merges them into
+/// \p Timings. Each line of the file contains the time in seconds and the file
+/// name separated by a tab character; malformed lines are ignored.
+std::error_code readTimingHistory(StringRef Path,
+                                  TranslationUnitTimings &Timings);
+
+/// \brief Writes \p Timings to the history file at \p Path.
+///
+/// The history is written to a temporary file which then replaces \p Path, so
+/// that readers never see a partially written history.
+std::error_code writeTimingHistory(StringRef Path,
+                                   const TranslationUnitTimings &Timings);
+
+/// \brief Returns the key under which timings of \p File are stored, i.e. its
+/// absolute path (relative to \p WorkingDir, if given) without dots.
+std::string getTimingHistoryKey(StringRef File, StringRef WorkingDir = "");
+
+/// \brief Parses a shard specification of the form 'i/n' with 0 <= i < n into
+/// \p ShardIndex and \p ShardCount. Returns false if it is malformed.
+bool parseShard(StringRef Value, unsigned &ShardIndex, unsigned &ShardCount);
+
+/// \brief Returns the files from \p Files which belong to the shard
+/// \p ShardIndex of \p ShardCount, ordered from the most to the least
+/// expensive one according to \p History.
+///
+/// Files are assigned greedily, most expensive first, to the shard with the
+/// smallest predicted total cost, so that all shards finish at about the same
+/// time. Files without recorded timings are assumed to cost the average of the
+/// known ones. The assignment is deterministic, so independent invocations
+/// with the same inputs agree on it.
+std::vector<std::string> scheduleByCost(ArrayRef<std::string> Files,
+                                        const TranslationUnitTimings &History,
+                                        unsigned ShardIndex = 0,
+                                        unsigned ShardCount = 1);
+
+/// \brief Memory used while processing a single translation unit.
+struct TranslationUnitMemoryUsage {
+  /// The absolute path of the main file.
+  std::string File;
+  /// Bytes allocated by the \c ASTContext, including its side tables.
+  size_t ASTBytes = 0;
+  /// Bytes held by the \c SourceManager for file buffers and its own tables.
+  size_t SourceManagerBytes = 0;
+  /// Growth of the heap while the translation unit was processed.
+  size_t HeapGrowthBytes = 0;
+  /// Growth of the peak resident set size of the process while the
+  /// translation unit was processed.
+  size_t PeakRSSGrowthBytes = 0;
+};
+
+/// \brief Returns the peak resident set size of the current process in bytes,
+/// or 0 if it cannot be determined on this platform.
+size_t getPeakResidentMemory();
+
 /// \brief Run a set of clang-tidy checks on a set of files.
 ///
 /// \param Profile if provided, it enables check profile collection in
 /// MatchFinder, and will contain the result of the profile.
+/// \param Timings if provided, the wall time spent on each translation unit is
+/// added to it.
+/// \param ExportFixesOS if provided, the errors of each translation unit are
+/// serialized to it as a separate YAML document as soon as the translation
+/// unit is processed (see \c exportReplacements).
+/// \param MemoryUsage if provided, the memory used by each translation unit is
+/// appended to it.
 void runClangTidy(clang::tidy::ClangTidyContext &Context,
                   const tooling::CompilationDatabase &Compilations,
                   ArrayRef<std::string> InputFiles,
-                  ProfileData *Profile = nullptr);
+                  ProfileData *Profile = nullptr,
+                  TranslationUnitTimings *Timings = nullptr,
+                  raw_ostream *ExportFixesOS = nullptr,
+                  std::vector<TranslationUnitMemoryUsage> *MemoryUsage =
+                      nullptr);
 
 // FIXME: This interface will need to be significantly extended to be useful.
 // FIXME: Implement confidence levels for displaying/fixing errors.
@@ -238,11 +324,13 @@ void runClangTidy(clang::tidy::ClangTidyContext &Context,
 void handleErrors(ClangTidyContext &Context, bool Fix,
                   unsigned &WarningsAsErrorsCount);
 
-/// \brief Serializes replacements into YAML and writes them to the specified
-/// output stream.
+/// \brief Serializes replacements into a YAML document and writes it to the
+/// specified output stream.
+///
+/// Several documents can be written to the same stream, e.g. one for each
+/// translation unit. clang-apply-replacements reads all of them.
 void exportReplacements(StringRef MainFilePath,
-                        const std::vector<ClangTidyError> &Errors,
-                        raw_ostream &OS);
+                        ArrayRef<ClangTidyError> Errors, raw_ostream &OS);
 
 } // end namespace tidy
 } // end namespace clang
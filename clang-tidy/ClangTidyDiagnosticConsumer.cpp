@@ -21,6 +21,7 @@
 #include "clang/AST/ASTDiagnostic.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Frontend/DiagnosticRenderer.h"
+#include "clang/Lex/HeaderSearch.h"
 #include "llvm/ADT/SmallString.h"
 #include <tuple>
 #include <vector>
@@ -122,36 +123,75 @@ static bool ConsumeNegativeIndicator(StringRef &GlobList) {
   }
   return false;
 }
-// Converts first glob from the comma-separated list of globs to Regex and
-// removes it and the trailing comma from the GlobList.
-static llvm::Regex ConsumeGlob(StringRef &GlobList) {
+// Returns the first glob from the comma-separated list of globs and removes it
+// and the trailing comma from the GlobList.
+static StringRef ConsumeGlob(StringRef &GlobList) {
   StringRef UntrimmedGlob = GlobList.substr(0, GlobList.find(','));
   StringRef Glob = UntrimmedGlob.trim(' ');
   GlobList = GlobList.substr(UntrimmedGlob.size() + 1);
-  SmallString<128> RegexText("^");
-  StringRef MetaChars("()^$|*+?.[]\\{}");
-  for (char C : Glob) {
-    if (C == '*')
-      RegexText.push_back('.');
-    else if (MetaChars.find(C) != StringRef::npos)
-      RegexText.push_back('\\');
-    RegexText.push_back(C);
-  }
-  RegexText.push_back('$');
-  return llvm::Regex(RegexText);
+  return Glob;
 }
 
-GlobList::GlobList(StringRef Globs)
-    : Positive(!ConsumeNegativeIndicator(Globs)), Regex(ConsumeGlob(Globs)),
-      NextGlob(Globs.empty() ? nullptr : new GlobList(Globs)) {}
+GlobList::GlobList(StringRef Globs) {
+  do {
+    GlobListItem Item;
+    Item.IsPositive = !ConsumeNegativeIndicator(Globs);
+    StringRef Glob = ConsumeGlob(Globs);
+    Item.HasLeadingStar = Glob.startswith("*");
+    Item.HasTrailingStar = Glob.endswith("*");
+    // Split the glob into the literal fragments between '*' metacharacters.
+    // Consecutive stars are equivalent to a single one and produce no
+    // fragments.
+    SmallVector<StringRef, 4> Fragments;
+    Glob.split(Fragments, '*', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    for (StringRef Fragment : Fragments)
+      Item.Fragments.push_back(Fragment.str());
+    Items.push_back(std::move(Item));
+  } while (!Globs.empty());
+}
 
-bool GlobList::contains(StringRef S, bool Contains) {
-  if (Regex.match(S))
-    Contains = Positive;
+bool GlobList::GlobListItem::matches(StringRef S) const {
+  if (Fragments.empty())
+    return HasLeadingStar || S.empty();
+
+  // Anchor the first and the last fragments unless they are preceded or
+  // followed by a star. As '*' is the only metacharacter, matching the
+  // remaining fragments greedily from left to right is exact.
+  size_t First = 0;
+  size_t Last = Fragments.size();
+  if (!HasLeadingStar) {
+    if (!S.startswith(Fragments.front()))
+      return false;
+    S = S.drop_front(Fragments.front().size());
+    ++First;
+  }
+  if (!HasTrailingStar && First < Last) {
+    if (!S.endswith(Fragments.back()))
+      return false;
+    S = S.drop_back(Fragments.back().size());
+    --Last;
+  } else if (!HasTrailingStar) {
+    // The only fragment was consumed as the prefix.
+    return S.empty();
+  }
 
-  if (NextGlob)
-    Contains = NextGlob->contains(S, Contains);
-  return Contains;
+  for (size_t I = First; I < Last; ++I) {
+    size_t Pos = S.find(Fragments[I]);
+    if (Pos == StringRef::npos)
+      return false;
+    S = S.drop_front(Pos + Fragments[I].size());
+  }
+  return true;
+}
+
+bool GlobList::contains(StringRef S) const {
+  // The last matching glob determines the result, so walk the list backwards
+  // and stop at the first match.
+  for (auto I = Items.rbegin(), E = Items.rend(); I != E; ++I) {
+    if (I->matches(S))
+      return I->IsPositive;
+  }
+  return false;
 }
 
 class ClangTidyContext::CachedGlobList {
@@ -178,7 +218,8 @@ private:
 ClangTidyContext::ClangTidyContext(
     std::unique_ptr<ClangTidyOptionsProvider> OptionsProvider)
     : DiagEngine(nullptr), OptionsProvider(std::move(OptionsProvider)),
-      Profile(nullptr) {
+      CheckFilter(nullptr), WarningAsErrorFilter(nullptr), Profile(nullptr),
+      CurrentAnalysisConfiguration(0) {
   // Before the first translation unit we can get errors related to command-line
   // parsing, use empty string for the file name in this case.
   setCurrentFile("");
@@ -207,9 +248,16 @@ void ClangTidyContext::setSourceManager(SourceManager *SourceMgr) {
 void ClangTidyContext::setCurrentFile(StringRef File) {
   CurrentFile = File;
   CurrentOptions = getOptionsForFile(CurrentFile);
-  CheckFilter = llvm::make_unique<CachedGlobList>(*getOptions().Checks);
-  WarningAsErrorFilter =
-      llvm::make_unique<CachedGlobList>(*getOptions().WarningsAsErrors);
+  CheckFilter = getCachedGlobList(*getOptions().Checks);
+  WarningAsErrorFilter = getCachedGlobList(*getOptions().WarningsAsErrors);
+}
+
+ClangTidyContext::CachedGlobList *
+ClangTidyContext::getCachedGlobList(StringRef Globs) {
+  std::unique_ptr<CachedGlobList> &Filter = CachedGlobLists[Globs];
+  if (!Filter)
+    Filter = llvm::make_unique<CachedGlobList>(Globs);
+  return Filter.get();
 }
 
 void ClangTidyContext::setASTContext(ASTContext *Context) {
@@ -234,6 +282,52 @@ ClangTidyOptions ClangTidyContext::getOptionsForFile(StringRef File) const {
 
 void ClangTidyContext::setCheckProfileData(ProfileData *P) { Profile = P; }
 
+void ClangTidyContext::setAnalysisConfiguration(StringRef Configuration) {
+  CurrentAnalysisConfiguration =
+      AnalysisConfigurations
+          .insert(std::make_pair(Configuration, AnalysisConfigurations.size()))
+          .first->second;
+  HeaderInclusionStates.clear();
+  AnalyzedHeaderFileIDs.clear();
+}
+
+void ClangTidyContext::setHeaderInclusionStates(
+    llvm::DenseMap<FileID, std::string> States) {
+  HeaderInclusionStates = std::move(States);
+  AnalyzedHeaderFileIDs.clear();
+}
+
+bool ClangTidyContext::isHeaderAnalyzed(const SourceManager &SM, FileID FID) {
+  if (!getGlobalOptions().DeduplicateHeaders || FID == SM.getMainFileID())
+    return false;
+  auto Cached = AnalyzedHeaderFileIDs.find(FID);
+  if (Cached != AnalyzedHeaderFileIDs.end())
+    return Cached->second;
+  bool Analyzed = false;
+  const FileEntry *File = SM.getFileEntryForID(FID);
+  auto State = HeaderInclusionStates.find(FID);
+  if (File && State != HeaderInclusionStates.end())
+    Analyzed = AnalyzedHeaders.count(std::make_tuple(
+        CurrentAnalysisConfiguration, File->getUniqueID(), State->second));
+  AnalyzedHeaderFileIDs[FID] = Analyzed;
+  return Analyzed;
+}
+
+void ClangTidyContext::markHeadersAnalyzed(const SourceManager &SM,
+                                           HeaderSearch &HS) {
+  if (!getGlobalOptions().DeduplicateHeaders)
+    return;
+  for (const auto &State : HeaderInclusionStates) {
+    // Headers without include guards (e.g. X-macro files) can expand to
+    // different code on each inclusion, so they are never deduplicated.
+    const FileEntry *File = SM.getFileEntryForID(State.first);
+    if (!File || !HS.isFileMultipleIncludeGuarded(File))
+      continue;
+    AnalyzedHeaders.insert(std::make_tuple(
+        CurrentAnalysisConfiguration, File->getUniqueID(), State.second));
+  }
+}
+
 bool ClangTidyContext::isCheckEnabled(StringRef CheckName) const {
   assert(CheckFilter != nullptr);
   return CheckFilter->contains(CheckName);
@@ -452,14 +546,31 @@ void ClangTidyDiagnosticConsumer::checkFilters(SourceLocation Location) {
   }
 
   const SourceManager &Sources = Diags->getSourceManager();
-  if (!*Context.getOptions().SystemHeaders &&
-      Sources.isInSystemHeader(Location))
-    return;
 
   // FIXME: We start with a conservative approach here, but the actual type of
   // location needed depends on the check (in particular, where this check wants
   // to apply fixes).
   FileID FID = Sources.getDecomposedExpansionLoc(Location).first;
+
+  // The system header and header filter decisions only depend on the file,
+  // unless line markers remap parts of it to other (system) files.
+  FileFilterDecision Decision;
+  auto Cached = FileFilterDecisions.find(FID);
+  if (Cached != FileFilterDecisions.end() && !Sources.hasLineTable()) {
+    Decision = Cached->second;
+  } else {
+    Decision.IsSystemHeader = Sources.isInSystemHeader(Location);
+    Decision.RelatesToUserCode = false;
+    if (const FileEntry *File = Sources.getFileEntryForID(FID)) {
+      Decision.RelatesToUserCode = Sources.isInMainFile(Location) ||
+                                   getHeaderFilter()->match(File->getName());
+    }
+    FileFilterDecisions[FID] = Decision;
+  }
+
+  if (!*Context.getOptions().SystemHeaders && Decision.IsSystemHeader)
+    return;
+
   const FileEntry *File = Sources.getFileEntryForID(FID);
 
   // -DMACRO definitions on the command line have locations in a virtual buffer
@@ -471,9 +582,8 @@ void ClangTidyDiagnosticConsumer::checkFilters(SourceLocation Location) {
   }
 
   StringRef FileName(File->getName());
-  LastErrorRelatesToUserCode = LastErrorRelatesToUserCode ||
-                               Sources.isInMainFile(Location) ||
-                               getHeaderFilter()->match(FileName);
+  LastErrorRelatesToUserCode =
+      LastErrorRelatesToUserCode || Decision.RelatesToUserCode;
 
   unsigned LineNumber = Sources.getExpansionLineNumber(Location);
   LastErrorPassesLineFilter =
@@ -481,6 +591,8 @@ void ClangTidyDiagnosticConsumer::checkFilters(SourceLocation Location) {
 }
 
 llvm::Regex *ClangTidyDiagnosticConsumer::getHeaderFilter() {
+  std::unique_ptr<llvm::Regex> &HeaderFilter =
+      HeaderFilters[*Context.getOptions().HeaderFilterRegex];
   if (!HeaderFilter)
     HeaderFilter =
         llvm::make_unique<llvm::Regex>(*Context.getOptions().HeaderFilterRegex);
@@ -640,4 +752,6 @@ void ClangTidyDiagnosticConsumer::finish() {
   for (const ClangTidyError &Error : Errors)
     Context.storeError(Error);
   Errors.clear();
+  // FileIDs are only meaningful within one translation unit.
+  FileFilterDecisions.clear();
 }
@@ -17,13 +17,17 @@
 #include "clang/Tooling/Refactoring.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Regex.h"
 #include "llvm/Support/Timer.h"
+#include <set>
+#include <tuple>
 
 namespace clang {
 
 class ASTContext;
 class CompilerInstance;
+class HeaderSearch;
 namespace ast_matchers {
 class MatchFinder;
 }
@@ -58,14 +62,21 @@ public:
 
   /// \brief Returns \c true if the pattern matches \p S. The result is the last
   /// matching glob's Positive flag.
-  bool contains(StringRef S) { return contains(S, false); }
+  bool contains(StringRef S) const;
 
 private:
-  bool contains(StringRef S, bool Contains);
-
-  bool Positive;
-  llvm::Regex Regex;
-  std::unique_ptr<GlobList> NextGlob;
+  /// \brief A single glob compiled into the literal fragments separated by
+  /// '*' metacharacters.
+  struct GlobListItem {
+    bool IsPositive;
+    bool HasLeadingStar;
+    bool HasTrailingStar;
+    SmallVector<std::string, 2> Fragments;
+
+    bool matches(StringRef S) const;
+  };
+
+  std::vector<GlobListItem> Items;
 };
 
 /// \brief Contains displayed and ignored diagnostic counters for a ClangTidy
@@ -186,6 +197,30 @@ public:
     return CurrentBuildDirectory;
   }
 
+  /// \brief Should be called when starting to process new translation unit.
+  ///
+  /// Headers are only considered analyzed under the same \p Configuration,
+  /// which should describe everything that can influence the analysis of a
+  /// header (compiler options, enabled checks and their options, etc.).
+  void setAnalysisConfiguration(StringRef Configuration);
+
+  /// \brief Sets the preprocessor state at the inclusion point of each header
+  /// of the current translation unit.
+  ///
+  /// A header is only considered analyzed if an earlier translation unit
+  /// included it with the same state, i.e. after the same headers and with the
+  /// same definitions of the macros the header uses but doesn't define itself.
+  void setHeaderInclusionStates(llvm::DenseMap<FileID, std::string> States);
+
+  /// \brief Returns \c true if header deduplication is enabled and the file
+  /// \p FID of the current translation unit has been analyzed by an earlier
+  /// translation unit under the current configuration.
+  bool isHeaderAnalyzed(const SourceManager &SM, FileID FID);
+
+  /// \brief Records all include-guarded headers of the current translation
+  /// unit as analyzed under the current configuration.
+  void markHeadersAnalyzed(const SourceManager &SM, HeaderSearch &HS);
+
 private:
   // Calls setDiagnosticsEngine() and storeError().
   friend class ClangTidyDiagnosticConsumer;
@@ -205,8 +240,14 @@ private:
   std::string CurrentFile;
   ClangTidyOptions CurrentOptions;
   class CachedGlobList;
-  std::unique_ptr<CachedGlobList> CheckFilter;
-  std::unique_ptr<CachedGlobList> WarningAsErrorFilter;
+  /// \brief Returns the (possibly shared) compiled filter for \p Globs.
+  CachedGlobList *getCachedGlobList(StringRef Globs);
+  // Compiled filters keyed by their textual representation, so that the
+  // per-file option sets which share the same 'Checks' or 'WarningsAsErrors'
+  // value also share a single compiled and memoized matcher.
+  llvm::StringMap<std::unique_ptr<CachedGlobList>> CachedGlobLists;
+  CachedGlobList *CheckFilter;
+  CachedGlobList *WarningAsErrorFilter;
 
   LangOptions LangOpts;
 
@@ -217,6 +258,16 @@ private:
   llvm::DenseMap<unsigned, std::string> CheckNamesByDiagnosticID;
 
   ProfileData *Profile;
+
+  // Run-wide registry of the headers analyzed under each configuration.
+  llvm::StringMap<unsigned> AnalysisConfigurations;
+  unsigned CurrentAnalysisConfiguration;
+  std::set<std::tuple<unsigned, llvm::sys::fs::UniqueID, std::string>>
+      AnalyzedHeaders;
+  // Inclusion states of the headers of the current translation unit.
+  llvm::DenseMap<FileID, std::string> HeaderInclusionStates;
+  // Per translation unit cache of isHeaderAnalyzed().
+  llvm::DenseMap<FileID, bool> AnalyzedHeaderFileIDs;
 };
 
 /// \brief A diagnostic consumer that turns each \c Diagnostic into a
@@ -256,7 +307,16 @@ private:
   bool RemoveIncompatibleErrors;
   std::unique_ptr<DiagnosticsEngine> Diags;
   SmallVector<ClangTidyError, 8> Errors;
-  std::unique_ptr<llvm::Regex> HeaderFilter;
+  // Compiled header filters keyed by the regular expression text. The options
+  // (and thus the header filter) can differ between translation units.
+  llvm::StringMap<std::unique_ptr<llvm::Regex>> HeaderFilters;
+  /// \brief Per-\c FileID cache of the header filter and system header
+  /// decisions for the current translation unit. Cleared in \c finish().
+  struct FileFilterDecision {
+    bool IsSystemHeader;
+    bool RelatesToUserCode;
+  };
+  llvm::DenseMap<FileID, FileFilterDecision> FileFilterDecisions;
   bool LastErrorRelatesToUserCode;
   bool LastErrorPassesLineFilter;
   bool LastErrorWasIgnored;
@@ -39,9 +39,16 @@ struct FileFilter {
 /// \brief Global options. These options are neither stored nor read from
 /// configuration files.
 struct ClangTidyGlobalOptions {
+  ClangTidyGlobalOptions() : DeduplicateHeaders(false) {}
+
   /// \brief Output warnings from certain line ranges of certain files only.
   /// If empty, no warnings will be filtered.
   std::vector<FileFilter> LineFilter;
+
+  /// \brief Skip matches of checks which support it in include-guarded headers
+  /// that have already been analyzed by an earlier translation unit of the run
+  /// under the same configuration.
+  bool DeduplicateHeaders;
 };
 
 /// \brief Contains options for clang-tidy. These options may be read from
@@ -0,0 +1,166 @@
+//===--- AvoidStdFunctionInHotPathsCheck.cpp - clang-tidy------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AvoidStdFunctionInHotPathsCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/DeclRefExprUtils.h"
+#include "../utils/OptionsUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+// Returns true if \p Ref is only used as the callee of a call.
+static bool isCalled(const DeclRefExpr *Ref, ASTContext &Context) {
+  const Expr *E = Ref;
+  const Stmt *Parent = utils::getParentStmt(E, Context);
+  while (Parent) {
+    const auto *Cast = dyn_cast<ImplicitCastExpr>(Parent);
+    if (!isa<ParenExpr>(Parent) && !(Cast && Cast->getCastKind() == CK_NoOp))
+      break;
+    E = cast<Expr>(Parent);
+    Parent = utils::getParentStmt(E, Context);
+  }
+  const auto *Call = dyn_cast_or_null<CXXOperatorCallExpr>(Parent);
+  return Call && Call->getOperator() == OO_Call && Call->getArg(0) == E;
+}
+
+AvoidStdFunctionInHotPathsCheck::AvoidStdFunctionInHotPathsCheck(
+    StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      AllowedTypes(
+          utils::options::parseStringList(Options.get("AllowedTypes", ""))),
+      HotNamespaces(
+          utils::options::parseStringList(Options.get("HotNamespaces", ""))) {
+  for (const std::string &Type : AllowedTypes)
+    AllowedTypeRegexes.emplace_back(Type);
+}
+
+void AvoidStdFunctionInHotPathsCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "AllowedTypes",
+                utils::options::serializeStringList(AllowedTypes));
+  Options.store(Opts, "HotNamespaces",
+                utils::options::serializeStringList(HotNamespaces));
+}
+
+void AvoidStdFunctionInHotPathsCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  const auto StdFunctionType = qualType(hasUnqualifiedDesugaredType(
+      recordType(hasDeclaration(cxxRecordDecl(hasName("::std::function"))))));
+  Finder->addMatcher(
+      functionDecl(isDefinition(), unless(isInstantiated()),
+                   unless(cxxMethodDecl(isVirtual())),
+                   hasAnyParameter(hasType(qualType(anyOf(
+                       StdFunctionType, references(StdFunctionType))))))
+          .bind("function"),
+      this);
+  Finder->addMatcher(cxxConstructExpr(hasType(StdFunctionType),
+                                      unless(isInTemplateInstantiation()))
+                         .bind("construct"),
+                     this);
+}
+
+void AvoidStdFunctionInHotPathsCheck::check(
+    const MatchFinder::MatchResult &Result) {
+  if (const auto *Function =
+          Result.Nodes.getNodeAs<FunctionDecl>("function"))
+    checkParameters(Function, *Result.Context);
+  if (const auto *Construct =
+          Result.Nodes.getNodeAs<CXXConstructExpr>("construct"))
+    checkConstruction(Construct, *Result.Context);
+}
+
+bool AvoidStdFunctionInHotPathsCheck::isInHotNamespace(
+    const FunctionDecl *Function) const {
+  if (HotNamespaces.empty())
+    return true;
+  for (const DeclContext *DC = Function->getDeclContext(); DC;
+       DC = DC->getParent()) {
+    const auto *Namespace = dyn_cast<NamespaceDecl>(DC);
+    if (!Namespace)
+      continue;
+    std::string Name = Namespace->getQualifiedNameAsString();
+    for (StringRef Hot : HotNamespaces)
+      if (Hot.ltrim(':') == Name)
+        return true;
+  }
+  return false;
+}
+
+bool AvoidStdFunctionInHotPathsCheck::isAllowedType(
+    QualType Type, const ASTContext &Context) {
+  std::string Name = Type.getNonReferenceType()
+                         .getUnqualifiedType()
+                         .getAsString(Context.getPrintingPolicy());
+  for (llvm::Regex &Allowed : AllowedTypeRegexes)
+    if (Allowed.match(Name))
+      return true;
+  return false;
+}
+
+void AvoidStdFunctionInHotPathsCheck::checkParameters(
+    const FunctionDecl *Function, ASTContext &Context) {
+  if (!isInHotNamespace(Function))
+    return;
+  for (const ParmVarDecl *Param : Function->parameters()) {
+    const auto *Record = Param->getType()
+                             .getNonReferenceType()
+                             ->getAsCXXRecordDecl();
+    if (!Record || !Record->getDeclName().isIdentifier() ||
+        Record->getName() != "function" || !Record->isInStdNamespace() ||
+        isAllowedType(Param->getType(), Context))
+      continue;
+
+    auto Refs =
+        utils::decl_ref_expr::allDeclRefExprs(*Param, *Function, Context);
+    if (Refs.empty())
+      continue;
+    bool OnlyCalled = true;
+    for (const DeclRefExpr *Ref : Refs)
+      if (Ref->refersToEnclosingVariableOrCapture() || !isCalled(Ref, Context))
+        OnlyCalled = false;
+    if (!OnlyCalled)
+      continue;
+    diag(Param->getLocation(),
+         "parameter %0 of type %1 is only called; consider a template "
+         "parameter or a function reference type to avoid the type erasure")
+        << Param << Param->getType();
+  }
+}
+
+void AvoidStdFunctionInHotPathsCheck::checkConstruction(
+    const CXXConstructExpr *Construct, ASTContext &Context) {
+  // Moving and default construction don't allocate.
+  const CXXConstructorDecl *Ctor = Construct->getConstructor();
+  if (Ctor->isMoveConstructor() || Ctor->isDefaultConstructor() ||
+      Construct->getNumArgs() == 0 ||
+      Construct->getArg(0)->getType()->isNullPtrType())
+    return;
+  const FunctionDecl *Function =
+      utils::getSurroundingFunction(Context, *Construct);
+  if (!Function || !isInHotNamespace(Function) ||
+      isAllowedType(Construct->getType(), Context) ||
+      !utils::getRepeatingLoop(Construct, Context))
+    return;
+  diag(Construct->getLocStart(),
+       "%0 is constructed inside a loop; construct it once before the loop or "
+       "avoid the type erasure")
+      << Construct->getType();
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,51 @@
+//===--- AvoidStdFunctionInHotPathsCheck.h - clang-tidy----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_AVOID_STD_FUNCTION_IN_HOT_PATHS_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_AVOID_STD_FUNCTION_IN_HOT_PATHS_H
+
+#include "../ClangTidy.h"
+#include "llvm/Support/Regex.h"
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds `std::function` parameters which are only called, and `std::function`
+/// objects constructed inside loops. Both pay for type erasure (an indirect
+/// call and possibly a heap allocation) where a template parameter or a
+/// function reference would do.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-avoid-std-function-in-hot-paths.html
+class AvoidStdFunctionInHotPathsCheck : public ClangTidyCheck {
+public:
+  AvoidStdFunctionInHotPathsCheck(StringRef Name, ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  void checkParameters(const FunctionDecl *Function, ASTContext &Context);
+  void checkConstruction(const CXXConstructExpr *Construct,
+                         ASTContext &Context);
+  bool isInHotNamespace(const FunctionDecl *Function) const;
+  bool isAllowedType(QualType Type, const ASTContext &Context);
+
+  const std::vector<std::string> AllowedTypes;
+  const std::vector<std::string> HotNamespaces;
+  std::vector<llvm::Regex> AllowedTypeRegexes;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_AVOID_STD_FUNCTION_IN_HOT_PATHS_H
@@ -0,0 +1,334 @@
+//===--- CopyOnLastUseCheck.cpp - clang-tidy-------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CopyOnLastUseCheck.h"
+
+#include "../utils/ExprSequence.h"
+#include "../utils/TypeTraits.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/Preprocessor.h"
+
+using namespace clang::ast_matchers;
+using namespace clang::tidy::utils;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+namespace {
+
+/// Decides whether a copy of a local variable is its last use on every path
+/// through the function body (and maintains state required by the various
+/// internal helper functions).
+class LastUseFinder {
+public:
+  LastUseFinder(ASTContext *TheContext) : Context(TheContext) {}
+
+  // Returns whether 'Var' is not used after 'CopyingCall', which copies it,
+  // within the given function body.
+  bool isLastUse(Stmt *FunctionBody, const Expr *CopyingCall,
+                 const VarDecl *Var);
+
+private:
+  bool isUsedFrom(const CFGBlock *Block, const VarDecl *Var);
+  void getDeclRefs(const CFGBlock *Block, const CFGStmt &Elem,
+                   const VarDecl *Var,
+                   llvm::SmallVectorImpl<const DeclRefExpr *> *DeclRefs);
+
+  ASTContext *Context;
+  std::unique_ptr<ExprSequence> Sequence;
+  std::unique_ptr<StmtToBlockMap> BlockMap;
+  llvm::SmallPtrSet<const CFGBlock *, 8> Visited;
+};
+
+} // namespace
+
+bool LastUseFinder::isLastUse(Stmt *FunctionBody, const Expr *CopyingCall,
+                              const VarDecl *Var) {
+  CFG::BuildOptions Options;
+  Options.AddImplicitDtors = true;
+  Options.AddTemporaryDtors = true;
+  std::unique_ptr<CFG> TheCFG =
+      CFG::buildCFG(nullptr, FunctionBody, Context, Options);
+  if (!TheCFG)
+    return false;
+
+  Sequence.reset(new ExprSequence(TheCFG.get(), Context));
+  BlockMap.reset(new StmtToBlockMap(TheCFG.get(), Context));
+  Visited.clear();
+
+  const CFGBlock *Block = BlockMap->blockContainingStmt(CopyingCall);
+  if (!Block)
+    return false;
+
+  // Uses in the same block must be sequenced before the copy.
+  for (const auto &Elem : *Block) {
+    Optional<CFGStmt> S = Elem.getAs<CFGStmt>();
+    if (!S)
+      continue;
+    llvm::SmallVector<const DeclRefExpr *, 1> DeclRefs;
+    getDeclRefs(Block, *S, Var, &DeclRefs);
+    for (const DeclRefExpr *DeclRef : DeclRefs)
+      if (Sequence->potentiallyAfter(DeclRef, CopyingCall))
+        return false;
+  }
+
+  // The block itself is only visited again if it is part of a loop.
+  for (const auto &Succ : Block->succs())
+    if (Succ && isUsedFrom(Succ, Var))
+      return false;
+  return true;
+}
+
+// Returns whether 'Var' may be used in 'Block' or one of its successors before
+// it is declared again.
+bool LastUseFinder::isUsedFrom(const CFGBlock *Block, const VarDecl *Var) {
+  if (!Visited.insert(Block).second)
+    return false;
+
+  for (const auto &Elem : *Block) {
+    Optional<CFGStmt> S = Elem.getAs<CFGStmt>();
+    if (!S)
+      continue;
+    // A declaration of the variable, e.g. in the next iteration of a loop,
+    // starts the lifetime of a new object.
+    if (const auto *Decl = dyn_cast<DeclStmt>(S->getStmt()))
+      for (const auto *D : Decl->decls())
+        if (D == Var)
+          return false;
+    llvm::SmallVector<const DeclRefExpr *, 1> DeclRefs;
+    getDeclRefs(Block, *S, Var, &DeclRefs);
+    if (!DeclRefs.empty())
+      return true;
+  }
+
+  for (const auto &Succ : Block->succs())
+    if (Succ && isUsedFrom(Succ, Var))
+      return true;
+  return false;
+}
+
+void LastUseFinder::getDeclRefs(
+    const CFGBlock *Block, const CFGStmt &Elem, const VarDecl *Var,
+    llvm::SmallVectorImpl<const DeclRefExpr *> *DeclRefs) {
+  for (const auto &Match :
+       match(findAll(declRefExpr(to(varDecl(equalsNode(Var))))
+                         .bind("declref")),
+             *Elem.getStmt(), *Context)) {
+    const auto *DeclRef = Match.getNodeAs<DeclRefExpr>("declref");
+    if (BlockMap->blockContainingStmt(DeclRef) == Block)
+      DeclRefs->push_back(DeclRef);
+  }
+}
+
+// Returns true if \p Ref may create a pointer or a reference into the
+// variable, which could observe the moved-from object.
+static bool mayCreateAlias(const DeclRefExpr *Ref, ASTContext &Context) {
+  if (Ref->refersToEnclosingVariableOrCapture())
+    return true;
+  const Expr *E = Ref;
+  bool ThroughCall = false;
+  auto Node = ast_type_traits::DynTypedNode::create(*E);
+  while (true) {
+    ASTContext::DynTypedNodeList Parents = Context.getParents(Node);
+    if (Parents.empty())
+      return false;
+    if (const auto *Var = Parents[0].get<VarDecl>()) {
+      // Iterators and other views into the variable are aliases, too.
+      QualType Type = Var->getType();
+      return Type->isReferenceType() || Type->isPointerType() ||
+             (ThroughCall && !Type->isScalarType());
+    }
+    const auto *Parent = Parents[0].get<Stmt>();
+    if (!Parent)
+      return false;
+    if (const auto *Op = dyn_cast<UnaryOperator>(Parent))
+      return Op->getOpcode() == UO_AddrOf;
+    const auto *Construct = dyn_cast<CXXConstructExpr>(Parent);
+    if (const auto *Call = dyn_cast<CXXMemberCallExpr>(Parent)) {
+      if (Call->getCallee()->IgnoreParens() != E)
+        return false;
+      ThroughCall = true;
+    } else if (const auto *Call = dyn_cast<CXXOperatorCallExpr>(Parent)) {
+      if (Call->getNumArgs() == 0 || Call->getArg(0) != E)
+        return false;
+      ThroughCall = true;
+    } else if (Construct) {
+      // Copies of the result of a call, e.g. of an iterator.
+      if (!ThroughCall || Construct->getNumArgs() != 1 ||
+          !Construct->getConstructor()->isCopyOrMoveConstructor())
+        return false;
+    } else if (!isa<ParenExpr>(Parent) && !isa<ImplicitCastExpr>(Parent) &&
+               !isa<MemberExpr>(Parent) &&
+               !isa<MaterializeTemporaryExpr>(Parent) &&
+               !isa<CXXBindTemporaryExpr>(Parent) &&
+               !isa<ExprWithCleanups>(Parent)) {
+      return false;
+    }
+    E = cast<Expr>(Parent);
+    Node = Parents[0];
+  }
+}
+
+// Returns true if the argument \p ParamIndex of \p Callee, which is a const
+// reference to the canonical type \p Type, can be moved from instead.
+static bool acceptsRValue(const FunctionDecl *Callee, unsigned ParamIndex,
+                          QualType Type) {
+  if (const auto *Ctor = dyn_cast<CXXConstructorDecl>(Callee))
+    if (Ctor->isCopyConstructor())
+      return type_traits::hasNonTrivialMoveConstructor(Type);
+  if (const auto *Method = dyn_cast<CXXMethodDecl>(Callee))
+    if (Method->isCopyAssignmentOperator())
+      return type_traits::hasNonTrivialMoveAssignment(Type);
+  if (!type_traits::hasNonTrivialMoveConstructor(Type))
+    return false;
+
+  // Look for an overload which takes an rvalue reference instead, like
+  // push_back(T &&).
+  const auto *Method = dyn_cast<CXXMethodDecl>(Callee);
+  for (const NamedDecl *D :
+       Callee->getDeclContext()->lookup(Callee->getDeclName())) {
+    const auto *Overload = dyn_cast<FunctionDecl>(D);
+    if (!Overload || Overload == Callee ||
+        Overload->getNumParams() != Callee->getNumParams())
+      continue;
+    const auto *OverloadMethod = dyn_cast<CXXMethodDecl>(Overload);
+    if (Method && OverloadMethod &&
+        Method->getTypeQualifiers() != OverloadMethod->getTypeQualifiers())
+      continue;
+    bool Matches = true;
+    for (unsigned I = 0, E = Callee->getNumParams(); I < E && Matches; ++I) {
+      QualType OverloadType =
+          Overload->getParamDecl(I)->getType().getCanonicalType();
+      if (I == ParamIndex)
+        Matches = OverloadType->isRValueReferenceType() &&
+                  OverloadType->getPointeeType().getUnqualifiedType() == Type;
+      else
+        Matches = OverloadType ==
+                  Callee->getParamDecl(I)->getType().getCanonicalType();
+    }
+    if (Matches)
+      return true;
+  }
+  return false;
+}
+
+CopyOnLastUseCheck::CopyOnLastUseCheck(StringRef Name,
+                                       ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      IncludeStyle(utils::IncludeSorter::parseIncludeStyle(
+          Options.get("IncludeStyle", "llvm"))) {}
+
+void CopyOnLastUseCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  const auto CopiedVar =
+      declRefExpr(to(varDecl(hasLocalStorage(),
+                             unless(hasType(referenceType())),
+                             unless(hasType(isConstQualified())))
+                         .bind("var")))
+          .bind("ref");
+  const auto ConstRefParam =
+      parmVarDecl(hasType(lValueReferenceType(
+                      pointee(qualType(isConstQualified())))))
+          .bind("param");
+  const auto ContainingFunction =
+      anyOf(hasAncestor(lambdaExpr().bind("containing-lambda")),
+            hasAncestor(functionDecl().bind("containing-func")));
+  Finder->addMatcher(
+      callExpr(forEachArgumentWithParam(ignoringParenImpCasts(CopiedVar),
+                                        ConstRefParam),
+               unless(isInTemplateInstantiation()), ContainingFunction)
+          .bind("call"),
+      this);
+  Finder->addMatcher(
+      cxxConstructExpr(forEachArgumentWithParam(
+                           ignoringParenImpCasts(CopiedVar), ConstRefParam),
+                       unless(isInTemplateInstantiation()), ContainingFunction)
+          .bind("call"),
+      this);
+}
+
+void CopyOnLastUseCheck::check(const MatchFinder::MatchResult &Result) {
+  const auto *ContainingLambda =
+      Result.Nodes.getNodeAs<LambdaExpr>("containing-lambda");
+  const auto *ContainingFunc =
+      Result.Nodes.getNodeAs<FunctionDecl>("containing-func");
+  const auto *Call = Result.Nodes.getNodeAs<Expr>("call");
+  const auto *Ref = Result.Nodes.getNodeAs<DeclRefExpr>("ref");
+  const auto *Var = Result.Nodes.getNodeAs<VarDecl>("var");
+  const auto *Param = Result.Nodes.getNodeAs<ParmVarDecl>("param");
+  ASTContext &Context = *Result.Context;
+
+  Stmt *FunctionBody = nullptr;
+  if (ContainingLambda)
+    FunctionBody = ContainingLambda->getBody();
+  else if (ContainingFunc)
+    FunctionBody = ContainingFunc->getBody();
+  if (!FunctionBody || Var->isExceptionVariable())
+    return;
+
+  const FunctionDecl *Callee = nullptr;
+  if (const auto *Construct = dyn_cast<CXXConstructExpr>(Call))
+    Callee = Construct->getConstructor();
+  else
+    Callee = cast<CallExpr>(Call)->getDirectCallee();
+  QualType Type = Var->getType().getCanonicalType().getUnqualifiedType();
+  QualType ParamType = Param->getType()->getPointeeType().getCanonicalType();
+  if (!Callee || ParamType.getUnqualifiedType() != Type ||
+      !acceptsRValue(Callee, Param->getFunctionScopeIndex(), Type))
+    return;
+
+  const auto VarRef = declRefExpr(to(varDecl(equalsNode(Var)))).bind("ref");
+  // Moving the variable is unsafe if it is used a second time by the call,
+  // or if a pointer or reference into it may outlive the copy.
+  if (match(findAll(VarRef), *Call, Context).size() != 1)
+    return;
+  for (const auto &Match : match(findAll(VarRef), *FunctionBody, Context))
+    if (mayCreateAlias(Match.getNodeAs<DeclRefExpr>("ref"), Context))
+      return;
+
+  LastUseFinder Finder(&Context);
+  if (!Finder.isLastUse(FunctionBody, Call, Var))
+    return;
+
+  auto Diag = diag(Ref->getLocStart(),
+                   "%0 is copied on its last use; consider moving it")
+              << Var;
+  // Do not propose fixes in macros since we cannot place them correctly.
+  if (Ref->getLocStart().isMacroID())
+    return;
+  const auto &SM = Context.getSourceManager();
+  auto EndLoc = Lexer::getLocForEndOfToken(Ref->getLocation(), 0, SM,
+                                           Context.getLangOpts());
+  Diag << FixItHint::CreateInsertion(Ref->getLocStart(), "std::move(")
+       << FixItHint::CreateInsertion(EndLoc, ")");
+  if (auto IncludeFixit = Inserter->CreateIncludeInsertion(
+          SM.getFileID(Ref->getLocStart()), "utility",
+          /*IsAngled=*/true))
+    Diag << *IncludeFixit;
+}
+
+void CopyOnLastUseCheck::registerPPCallbacks(CompilerInstance &Compiler) {
+  Inserter.reset(new utils::IncludeInserter(
+      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
+  Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+}
+
+void CopyOnLastUseCheck::storeOptions(ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "IncludeStyle",
+                utils::IncludeSorter::toString(IncludeStyle));
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,228 @@
+//===--- DevirtualizationFinalCheck.cpp - clang-tidy-----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "DevirtualizationFinalCheck.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include <mutex>
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+// Returns true if \p Method overrides a virtual method and could be declared
+// final.
+static bool isFinalCandidate(const CXXMethodDecl *Method) {
+  return Method->isVirtual() && !Method->isImplicit() && !Method->isPure() &&
+         !isa<CXXDestructorDecl>(Method) && !Method->hasAttr<FinalAttr>() &&
+         Method->size_overridden_methods() > 0;
+}
+
+// Returns the name identifying \p Method across translation units, e.g.
+// `ns::Shape::area(int) const`.
+static std::string getMethodKey(const CXXMethodDecl &Method) {
+  const PrintingPolicy &Policy = Method.getASTContext().getPrintingPolicy();
+  std::string Key = Method.getQualifiedNameAsString() + "(";
+  for (const ParmVarDecl *Param : Method.parameters()) {
+    if (Param != *Method.param_begin())
+      Key += ", ";
+    Key += Param->getType().getCanonicalType().getAsString(Policy);
+  }
+  Key += ")";
+  if (Method.isConst())
+    Key += " const";
+  if (Method.isVolatile())
+    Key += " volatile";
+  if (Method.getRefQualifier() == RQ_LValue)
+    Key += " &";
+  else if (Method.getRefQualifier() == RQ_RValue)
+    Key += " &&";
+  return Key;
+}
+
+DevirtualizationFinalCheck::DevirtualizationFinalCheck(
+    StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      SummaryDirectory(Options.get("SummaryDirectory", "")),
+      HierarchySummary(Options.get("HierarchySummary", "")),
+      Program(readProgramFinalCandidates(HierarchySummary)) {}
+
+// The check is constructed for every translation unit, so the summary is
+// parsed once per process and shared.
+std::shared_ptr<const DevirtualizationFinalCheck::ProgramFinalCandidates>
+DevirtualizationFinalCheck::readProgramFinalCandidates(StringRef Path) {
+  static std::mutex CacheMutex;
+  static llvm::StringMap<std::shared_ptr<const ProgramFinalCandidates>> Cache;
+  std::lock_guard<std::mutex> Lock(CacheMutex);
+  std::shared_ptr<const ProgramFinalCandidates> &Cached = Cache[Path];
+  if (Cached)
+    return Cached;
+
+  auto Candidates = std::make_shared<ProgramFinalCandidates>();
+  // An unreadable summary is cached as empty so that it's reported once.
+  Cached = Candidates;
+  if (Path.empty())
+    return Cached;
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  FinalCandidates Merged;
+  if (!Buffer || !readFinalCandidates(Buffer.get()->getBuffer(), Merged)) {
+    llvm::errs() << "Can't read the class hierarchy summary '" << Path
+                 << "'\n";
+    return Cached;
+  }
+  for (const std::string &Class : Merged.Classes)
+    Candidates->Classes.insert(Class);
+  for (const std::string &Method : Merged.Methods)
+    Candidates->Methods.insert(Method);
+  return Cached;
+}
+
+void DevirtualizationFinalCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "SummaryDirectory", SummaryDirectory);
+  Options.store(Opts, "HierarchySummary", HierarchySummary);
+}
+
+void DevirtualizationFinalCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  Finder->addMatcher(
+      cxxRecordDecl(isDefinition(), unless(isExpansionInSystemHeader()))
+          .bind("record"),
+      this);
+}
+
+void DevirtualizationFinalCheck::check(const MatchFinder::MatchResult &Result) {
+  const auto *Record = Result.Nodes.getNodeAs<CXXRecordDecl>("record");
+  SM = Result.SourceManager;
+  if (!Record->isPolymorphic())
+    return;
+  // Local and unnamed classes can't be derived from elsewhere, but still
+  // derive from other classes and override their methods.
+  const bool IsNamed = !Record->isLambda() && !Record->isLocalClass() &&
+                       Record->getIdentifier();
+
+  // Templates are summarized as well, as they may derive from other classes
+  // and override their methods.
+  ClassSummary Summary;
+  Summary.Name = Record->getQualifiedNameAsString();
+  for (const CXXBaseSpecifier &Base : Record->bases()) {
+    if (const CXXRecordDecl *BaseRecord = Base.getType()->getAsCXXRecordDecl())
+      Summary.Bases.push_back(BaseRecord->getQualifiedNameAsString());
+  }
+  for (const CXXMethodDecl *Method : Record->methods()) {
+    if (!Method->isVirtual())
+      continue;
+    for (auto I = Method->begin_overridden_methods(),
+              E = Method->end_overridden_methods();
+         I != E; ++I)
+      Summary.Overridden.push_back(getMethodKey(**I));
+    if (IsNamed && isFinalCandidate(Method))
+      Summary.Methods.push_back(getMethodKey(*Method));
+  }
+  Summaries.push_back(std::move(Summary));
+
+  if (IsNamed && !Record->hasAttr<FinalAttr>() && !Record->isAbstract() &&
+      !Record->getDescribedClassTemplate() &&
+      !isa<ClassTemplateSpecializationDecl>(Record) &&
+      !Record->getLocation().isMacroID())
+    Candidates.push_back(Record);
+}
+
+void DevirtualizationFinalCheck::onEndOfTranslationUnit() {
+  if (!Summaries.empty()) {
+    if (SummaryDirectory.empty())
+      diagnoseFinalCandidates();
+    else
+      writeSummary();
+  }
+  Summaries.clear();
+  Candidates.clear();
+}
+
+void DevirtualizationFinalCheck::writeSummary() {
+  const FileEntry *MainFile = SM->getFileEntryForID(SM->getMainFileID());
+  int FD;
+  llvm::SmallString<128> SummaryPath;
+  StringRef FileName =
+      llvm::sys::path::filename(MainFile ? MainFile->getName() : "input");
+  if (std::error_code EC = llvm::sys::fs::createUniqueFile(
+          llvm::Twine(SummaryDirectory) + "/" + FileName + "-%%%%%%.yaml", FD,
+          SummaryPath)) {
+    llvm::errs() << "Can't write the class hierarchy summary to '"
+                 << SummaryDirectory << "': " << EC.message() << "\n";
+    return;
+  }
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  writeClassSummaries(OS, Summaries);
+}
+
+void DevirtualizationFinalCheck::diagnoseFinalCandidates() {
+  // Classes with internal linkage can only be derived from in this
+  // translation unit, so its summary is complete for them.
+  FinalCandidates Local = computeFinalCandidates(Summaries);
+  llvm::StringSet<> LocalFinalClasses;
+  llvm::StringSet<> LocalFinalMethods;
+  for (const std::string &Class : Local.Classes)
+    LocalFinalClasses.insert(Class);
+  for (const std::string &Method : Local.Methods)
+    LocalFinalMethods.insert(Method);
+
+  for (const CXXRecordDecl *Record : Candidates) {
+    const bool IsInternal = !Record->isExternallyVisible();
+    const llvm::StringSet<> &FinalClasses =
+        IsInternal ? LocalFinalClasses : Program->Classes;
+    const llvm::StringSet<> &FinalMethods =
+        IsInternal ? LocalFinalMethods : Program->Methods;
+
+    if (FinalClasses.count(Record->getQualifiedNameAsString())) {
+      diag(Record->getLocation(),
+           "class %0 has no derived classes; declare it 'final' to allow "
+           "devirtualizing calls to its virtual methods")
+          << Record
+          << FixItHint::CreateInsertion(
+                 Lexer::getLocForEndOfToken(Record->getLocation(), 0, *SM,
+                                            getLangOpts()),
+                 " final");
+      continue;
+    }
+
+    for (const CXXMethodDecl *Method : Record->methods()) {
+      if (!isFinalCandidate(Method) ||
+          !FinalMethods.count(getMethodKey(*Method)))
+        continue;
+      auto Diag = diag(Method->getLocation(),
+                       "method %0 is not overridden in any derived class; "
+                       "declare it 'final' to allow devirtualizing calls to "
+                       "it")
+                  << Method;
+      // 'final' implies 'override', so only replace the existing specifier.
+      if (const auto *Override = Method->getAttr<OverrideAttr>()) {
+        if (!Override->getLocation().isMacroID())
+          Diag << FixItHint::CreateReplacement(
+              CharSourceRange::getTokenRange(Override->getLocation(),
+                                             Override->getLocation()),
+              "final");
+      }
+    }
+  }
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
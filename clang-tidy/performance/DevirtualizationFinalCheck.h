@@ -0,0 +1,67 @@
+//===--- DevirtualizationFinalCheck.h - clang-tidy---------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_DEVIRTUALIZATION_FINAL_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_DEVIRTUALIZATION_FINAL_H
+
+#include "../ClangTidy.h"
+#include "hierarchy/ClassHierarchySummary.h"
+#include "llvm/ADT/StringSet.h"
+#include <memory>
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds polymorphic classes without derived classes and virtual methods
+/// without overriders, and suggests declaring them `final` so that calls to
+/// them can be devirtualized.
+///
+/// Classes with external linkage are only reported with a class hierarchy
+/// summary of the whole program, which is merged from per-translation unit
+/// summaries written by the check.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-devirtualization-final.html
+class DevirtualizationFinalCheck : public ClangTidyCheck {
+public:
+  DevirtualizationFinalCheck(StringRef Name, ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void onEndOfTranslationUnit() override;
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  struct ProgramFinalCandidates {
+    llvm::StringSet<> Classes;
+    llvm::StringSet<> Methods;
+  };
+
+  static std::shared_ptr<const ProgramFinalCandidates>
+  readProgramFinalCandidates(StringRef Path);
+  void writeSummary();
+  void diagnoseFinalCandidates();
+
+  const std::string SummaryDirectory;
+  const std::string HierarchySummary;
+  // Final candidates of the whole program, read from `HierarchySummary`.
+  std::shared_ptr<const ProgramFinalCandidates> Program;
+
+  std::vector<ClassSummary> Summaries;
+  // Classes which can be declared final, i.e. which are defined outside of
+  // macros and templates.
+  std::vector<const CXXRecordDecl *> Candidates;
+  const SourceManager *SM = nullptr;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_DEVIRTUALIZATION_FINAL_H
@@ -0,0 +1,207 @@
+//===--- FalseSharingCheck.cpp - clang-tidy--------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FalseSharingCheck.h"
+#include "../utils/OptionsUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/RecordLayout.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include <algorithm>
+#include <string>
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+static const char DefaultSynchronizationTypes[] =
+    "::std::atomic;::std::atomic_flag;::std::mutex;::std::recursive_mutex;"
+    "::std::timed_mutex;::std::recursive_timed_mutex;::std::shared_mutex;"
+    "::std::shared_timed_mutex";
+
+FalseSharingCheck::FalseSharingCheck(StringRef Name,
+                                     ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      CacheLineSize(Options.get("CacheLineSize", 64U)),
+      SynchronizationTypes(utils::options::parseStringList(
+          Options.get("SynchronizationTypes", DefaultSynchronizationTypes))) {}
+
+void FalseSharingCheck::storeOptions(ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "CacheLineSize", CacheLineSize);
+  Options.store(Opts, "SynchronizationTypes",
+                utils::options::serializeStringList(SynchronizationTypes));
+}
+
+void FalseSharingCheck::registerMatchers(MatchFinder *Finder) {
+  if (CacheLineSize == 0)
+    return;
+
+  const auto SyncDecl = cxxRecordDecl(hasAnyName(SmallVector<StringRef, 8>(
+      SynchronizationTypes.begin(), SynchronizationTypes.end())));
+  const auto SyncType = qualType(
+      hasUnqualifiedDesugaredType(recordType(hasDeclaration(SyncDecl))));
+  const auto ArrayOfSync = hasType(qualType(hasUnqualifiedDesugaredType(
+      constantArrayType(hasElementType(SyncType)))));
+  const auto SyncMember = fieldDecl(
+      anyOf(hasType(SyncType), ArrayOfSync),
+      unless(hasType(qualType(isConstQualified()))));
+
+  // Each record is reported once all of its synchronization members have been
+  // collected.
+  Finder->addMatcher(
+      cxxRecordDecl(isDefinition(), unless(isUnion()),
+                    unless(ast_matchers::isTemplateInstantiation()),
+                    forEach(SyncMember.bind("member")))
+          .bind("record"),
+      this);
+
+  // Modifications of the members, i.e. calls of non-const member functions
+  // like 'operator++' or 'lock'. Members only modified together by the same
+  // functions are assumed to be used by the same thread.
+  const auto WrittenMember = memberExpr(member(SyncMember.bind("written")));
+  const auto NonConstMethod = callee(cxxMethodDecl(unless(isConst())));
+  const auto Writer = forFunction(functionDecl().bind("writer"));
+  Finder->addMatcher(
+      cxxMemberCallExpr(on(WrittenMember), NonConstMethod, Writer), this);
+  Finder->addMatcher(
+      cxxOperatorCallExpr(hasArgument(0, ignoringParenImpCasts(WrittenMember)),
+                          NonConstMethod, Writer),
+      this);
+
+  // Arrays indexed by a variable, e.g. a thread id:
+  //   std::atomic<long> Counters[NumThreads];
+  //   ++Counters[ThreadId];
+  Finder->addMatcher(
+      arraySubscriptExpr(
+          hasBase(ignoringParenImpCasts(anyOf(
+              declRefExpr(to(varDecl(hasGlobalStorage(), ArrayOfSync)
+                                 .bind("array"))),
+              memberExpr(member(fieldDecl(ArrayOfSync).bind("array")))))),
+          hasIndex(expr().bind("index"))),
+      this);
+}
+
+void FalseSharingCheck::check(const MatchFinder::MatchResult &Result) {
+  ASTContext &Context = *Result.Context;
+  if (const auto *Record = Result.Nodes.getNodeAs<CXXRecordDecl>("record")) {
+    const auto *Member = Result.Nodes.getNodeAs<FieldDecl>("member");
+    if (!Record->isDependentContext() && !Record->isInvalidDecl())
+      Members[Record].push_back(Member);
+    ASTCtx = &Context;
+    return;
+  }
+
+  if (const auto *Member = Result.Nodes.getNodeAs<FieldDecl>("written")) {
+    Writers[Member].insert(Result.Nodes.getNodeAs<FunctionDecl>("writer"));
+    return;
+  }
+
+  const auto *Index = Result.Nodes.getNodeAs<Expr>("index");
+  if (Index->isValueDependent() || Index->isIntegerConstantExpr(Context))
+    return;
+  checkArray(Result.Nodes.getNodeAs<ValueDecl>("array"), Context);
+}
+
+void FalseSharingCheck::checkArray(const ValueDecl *Array,
+                                   ASTContext &Context) {
+  if (!ReportedArrays.insert(Array).second)
+    return;
+  const ArrayType *Type = Context.getAsArrayType(Array->getType());
+  if (!Type || Type->getElementType()->isDependentType())
+    return;
+  TypeInfo Element = Context.getTypeInfo(Type->getElementType());
+  if (Context.toCharUnitsFromBits(Element.Width).getQuantity() >=
+          CacheLineSize ||
+      Context.toCharUnitsFromBits(Element.Align).getQuantity() >=
+          CacheLineSize)
+    return;
+  diag(Array->getLocation(),
+       "elements of %0 may share a cache line, which causes false sharing "
+       "when they are modified by different threads")
+      << Array;
+}
+
+bool FalseSharingCheck::areWrittenTogether(const FieldDecl *First,
+                                           const FieldDecl *Second) const {
+  auto FirstWriters = Writers.find(First);
+  auto SecondWriters = Writers.find(Second);
+  if (FirstWriters == Writers.end() || SecondWriters == Writers.end() ||
+      FirstWriters->second.size() != SecondWriters->second.size())
+    return false;
+  for (const FunctionDecl *Writer : FirstWriters->second)
+    if (!SecondWriters->second.count(Writer))
+      return false;
+  return true;
+}
+
+void FalseSharingCheck::checkRecord(const CXXRecordDecl *Record,
+                                    ArrayRef<const FieldDecl *> SyncMembers,
+                                    ASTContext &Context) {
+  if (SyncMembers.size() < 2)
+    return;
+  const ASTRecordLayout &Layout = Context.getASTRecordLayout(Record);
+  const int64_t LineSize = CacheLineSize;
+  // If the record itself starts at a cache line boundary, the cache line of
+  // each member is known. Otherwise any two members closer than a cache line
+  // may end up on the same one.
+  const bool LineAligned = Layout.getAlignment().getQuantity() >= LineSize;
+
+  SmallVector<const FieldDecl *, 8> Sorted(SyncMembers.begin(),
+                                           SyncMembers.end());
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const FieldDecl *LHS, const FieldDecl *RHS) {
+              return LHS->getFieldIndex() < RHS->getFieldIndex();
+            });
+
+  for (unsigned I = 1, E = Sorted.size(); I != E; ++I) {
+    const FieldDecl *Prev = Sorted[I - 1];
+    const FieldDecl *Member = Sorted[I];
+    int64_t PrevEnd =
+        Context
+            .toCharUnitsFromBits(Layout.getFieldOffset(Prev->getFieldIndex()))
+            .getQuantity() +
+        Context.getTypeSizeInChars(Prev->getType()).getQuantity();
+    int64_t Begin =
+        Context
+            .toCharUnitsFromBits(
+                Layout.getFieldOffset(Member->getFieldIndex()))
+            .getQuantity();
+    bool SharesLine = LineAligned ? (PrevEnd - 1) / LineSize == Begin / LineSize
+                                  : Begin - PrevEnd < LineSize;
+    if (!SharesLine || areWrittenTogether(Prev, Member))
+      continue;
+
+    auto Diag = diag(Member->getLocation(),
+                     "%0 may share a cache line with %1, which causes false "
+                     "sharing when they are modified by different threads")
+                << Member << Prev;
+    // 'alignas' on a declaration with several declarators would apply to all
+    // of them.
+    SourceLocation Start = Member->getLocStart();
+    if (Context.getLangOpts().CPlusPlus11 && !Member->hasAttr<AlignedAttr>() &&
+        Start.isValid() && !Start.isMacroID() &&
+        Start != Prev->getLocStart())
+      Diag << FixItHint::CreateInsertion(
+          Start, "alignas(" + std::to_string(CacheLineSize) + ") ");
+  }
+}
+
+void FalseSharingCheck::onEndOfTranslationUnit() {
+  for (const auto &RecordAndMembers : Members)
+    checkRecord(RecordAndMembers.first, RecordAndMembers.second, *ASTCtx);
+  Members.clear();
+  Writers.clear();
+  ReportedArrays.clear();
+  ASTCtx = nullptr;
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
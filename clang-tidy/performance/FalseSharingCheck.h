@@ -0,0 +1,60 @@
+//===--- FalseSharingCheck.h - clang-tidy------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_FALSE_SHARING_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_FALSE_SHARING_H
+
+#include "../ClangTidy.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds atomic and lock members which may share a cache line with each
+/// other, and arrays of atomics or locks indexed by a variable, which causes
+/// false sharing when they are modified by different threads.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-false-sharing.html
+class FalseSharingCheck : public ClangTidyCheck {
+public:
+  FalseSharingCheck(StringRef Name, ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void onEndOfTranslationUnit() override;
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  void checkRecord(const CXXRecordDecl *Record,
+                   ArrayRef<const FieldDecl *> SyncMembers,
+                   ASTContext &Context);
+  void checkArray(const ValueDecl *Array, ASTContext &Context);
+  bool areWrittenTogether(const FieldDecl *First,
+                          const FieldDecl *Second) const;
+
+  const unsigned CacheLineSize;
+  const std::vector<std::string> SynchronizationTypes;
+
+  ASTContext *ASTCtx = nullptr;
+  llvm::MapVector<const CXXRecordDecl *, SmallVector<const FieldDecl *, 4>>
+      Members;
+  // The functions modifying each synchronization member.
+  llvm::DenseMap<const FieldDecl *, llvm::SmallPtrSet<const FunctionDecl *, 4>>
+      Writers;
+  llvm::SmallPtrSet<const ValueDecl *, 8> ReportedArrays;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_FALSE_SHARING_H
@@ -30,6 +30,7 @@ public:
   FasterStringFindCheck(StringRef Name, ClangTidyContext *Context);
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
   void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
 
 private:
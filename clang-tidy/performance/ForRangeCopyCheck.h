@@ -26,6 +26,7 @@ public:
   void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
 
 private:
   // Checks if the loop variable is a const value and expensive to copy. If so
@@ -0,0 +1,289 @@
+//===--- ImplicitAtomicSeqCstCheck.cpp - clang-tidy------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ImplicitAtomicSeqCstCheck.h"
+#include "../utils/ASTUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Lex/Lexer.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+static const char RelaxedOrder[] = "std::memory_order_relaxed";
+
+// Returns true if \p Type is a `std::atomic` of an integer type other than
+// bool.
+static bool isAtomicInteger(QualType Type) {
+  const auto *Specialization =
+      dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+          Type->getAsCXXRecordDecl());
+  if (!Specialization || Specialization->getTemplateArgs().size() < 1 ||
+      Specialization->getTemplateArgs()[0].getKind() !=
+          TemplateArgument::Type)
+    return false;
+  QualType Value = Specialization->getTemplateArgs()[0].getAsType();
+  return Value->isIntegerType() && !Value->isBooleanType();
+}
+
+// Returns true if the value of the expression statement \p S is discarded.
+static bool isValueUnused(const Stmt *S, ASTContext &Context) {
+  ASTContext::DynTypedNodeList Parents = Context.getParents(*S);
+  if (Parents.empty())
+    return false;
+  const auto *Parent = Parents[0].get<Stmt>();
+  if (!Parent)
+    return false;
+  if (isa<CompoundStmt>(Parent))
+    return true;
+  if (const auto *For = dyn_cast<ForStmt>(Parent))
+    return S == For->getInc() || S == For->getBody();
+  if (const auto *If = dyn_cast<IfStmt>(Parent))
+    return S == If->getThen() || S == If->getElse();
+  if (const auto *While = dyn_cast<WhileStmt>(Parent))
+    return S == While->getBody();
+  if (const auto *Do = dyn_cast<DoStmt>(Parent))
+    return S == Do->getBody();
+  if (const auto *RangeFor = dyn_cast<CXXForRangeStmt>(Parent))
+    return S == RangeFor->getBody();
+  if (const auto *Case = dyn_cast<SwitchCase>(Parent))
+    return S == Case->getSubStmt();
+  if (const auto *Label = dyn_cast<LabelStmt>(Parent))
+    return S == Label->getSubStmt();
+  return false;
+}
+
+// Returns true if the memory order argument \p Index of \p Call is spelled
+// out.
+static bool hasExplicitOrder(const CallExpr *Call, unsigned Index) {
+  return Call->getNumArgs() > Index &&
+         !isa<CXXDefaultArgExpr>(Call->getArg(Index));
+}
+
+// Returns true if the memory order argument \p Index of \p Call is
+// `std::memory_order_relaxed`.
+static bool isRelaxedOrder(const CallExpr *Call, unsigned Index) {
+  const auto *Ref =
+      dyn_cast<DeclRefExpr>(Call->getArg(Index)->IgnoreParenImpCasts());
+  const auto *Order =
+      Ref ? dyn_cast<EnumConstantDecl>(Ref->getDecl()) : nullptr;
+  return Order && Order->getName() == "memory_order_relaxed";
+}
+
+static StringRef getText(const Expr *E, const ASTContext &Context) {
+  return Lexer::getSourceText(
+      CharSourceRange::getTokenRange(E->getSourceRange()),
+      Context.getSourceManager(), Context.getLangOpts());
+}
+
+ImplicitAtomicSeqCstCheck::ImplicitAtomicSeqCstCheck(StringRef Name,
+                                                     ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      OnlyInLoops(Options.get("OnlyInLoops", 0U) != 0) {}
+
+void ImplicitAtomicSeqCstCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "OnlyInLoops", OnlyInLoops);
+}
+
+void ImplicitAtomicSeqCstCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  const auto AtomicType = qualType(hasUnqualifiedDesugaredType(
+      recordType(hasDeclaration(cxxRecordDecl(hasName("::std::atomic"))))));
+  Finder->addMatcher(declRefExpr(to(varDecl(hasType(AtomicType))),
+                                 unless(isInTemplateInstantiation()))
+                         .bind("ref"),
+                     this);
+  Finder->addMatcher(memberExpr(member(fieldDecl(hasType(AtomicType))),
+                                unless(isInTemplateInstantiation()))
+                         .bind("ref"),
+                     this);
+}
+
+void ImplicitAtomicSeqCstCheck::check(const MatchFinder::MatchResult &Result) {
+  const auto *Ref = Result.Nodes.getNodeAs<Expr>("ref");
+  const ValueDecl *Counter = nullptr;
+  if (const auto *DeclRef = dyn_cast<DeclRefExpr>(Ref))
+    Counter = DeclRef->getDecl();
+  else
+    Counter = cast<MemberExpr>(Ref)->getMemberDecl();
+  if (!isAtomicInteger(Counter->getType()))
+    return;
+  CounterUses &Uses = Counters[cast<ValueDecl>(Counter->getCanonicalDecl())];
+  if (!Uses.IsCounter)
+    return;
+
+  ASTContext &Context = *Result.Context;
+  // Look through parentheses and conversions to the base class which
+  // implements the operations.
+  const Expr *E = Ref;
+  const Stmt *Parent = utils::getParentStmt(E, Context);
+  while (Parent) {
+    const auto *Cast = dyn_cast<ImplicitCastExpr>(Parent);
+    if (!isa<ParenExpr>(Parent) &&
+        !(Cast && (Cast->getCastKind() == CK_NoOp ||
+                   Cast->getCastKind() == CK_DerivedToBase ||
+                   Cast->getCastKind() == CK_UncheckedDerivedToBase)))
+      break;
+    E = cast<Expr>(Parent);
+    Parent = utils::getParentStmt(E, Context);
+  }
+
+  const bool CanFix =
+      !Ref->getLocStart().isMacroID() && !Ref->getLocEnd().isMacroID();
+  const StringRef Object = getText(Ref, Context);
+  Operation Op;
+  if (const auto *Member = dyn_cast_or_null<MemberExpr>(Parent)) {
+    const auto *Call = dyn_cast_or_null<CXXMemberCallExpr>(
+        utils::getParentStmt(Member, Context));
+    if (!Call || Member->getBase() != E) {
+      Uses.IsCounter = false;
+      return;
+    }
+    const CXXMethodDecl *Method = Call->getMethodDecl();
+    if (isa<CXXConversionDecl>(Method)) {
+      Op.Kind = OK_Load;
+      Op.Loc = Ref->getLocStart();
+      if (CanFix)
+        Op.Fixes.push_back(FixItHint::CreateInsertion(
+            Lexer::getLocForEndOfToken(Ref->getLocEnd(), 0,
+                                       Context.getSourceManager(),
+                                       Context.getLangOpts()),
+            (".load(" + llvm::Twine(RelaxedOrder) + ")").str()));
+    } else {
+      StringRef Name = Method->getDeclName().isIdentifier()
+                           ? Method->getName()
+                           : StringRef();
+      unsigned OrderIndex = 1;
+      if (Name == "fetch_add")
+        Op.Kind = OK_Increment;
+      else if (Name == "fetch_sub")
+        Op.Kind = OK_Decrement;
+      else if (Name == "load") {
+        Op.Kind = OK_Load;
+        OrderIndex = 0;
+      } else if (Name == "is_lock_free")
+        return;
+      else {
+        // store(), exchange(), compare_exchange_*() and the bitwise
+        // operations are used for synchronization rather than for counting.
+        Uses.IsCounter = false;
+        return;
+      }
+      if (hasExplicitOrder(Call, OrderIndex)) {
+        // A stronger order than the default one is chosen deliberately.
+        if (!isRelaxedOrder(Call, OrderIndex))
+          Uses.IsCounter = false;
+        else if (Op.Kind != OK_Load)
+          Uses.HasRelaxedWriter = true;
+        return;
+      }
+      // A counter whose previous value decides what happens next, like a
+      // reference count, synchronizes with the other modifications.
+      if (Op.Kind != OK_Load && !isValueUnused(Call, Context)) {
+        Uses.IsCounter = false;
+        return;
+      }
+      Op.Loc = Member->getMemberLoc();
+      if (CanFix && !Call->getRParenLoc().isMacroID())
+        Op.Fixes.push_back(FixItHint::CreateInsertion(
+            Call->getRParenLoc(),
+            (OrderIndex == 0 ? "" : ", ") + std::string(RelaxedOrder)));
+    }
+  } else if (const auto *Call = dyn_cast_or_null<CXXOperatorCallExpr>(Parent)) {
+    if (Call->getNumArgs() == 0 || Call->getArg(0) != E) {
+      Uses.IsCounter = false;
+      return;
+    }
+    StringRef Method;
+    StringRef Argument = "1";
+    switch (Call->getOperator()) {
+    case OO_PlusPlus:
+      Op.Kind = OK_Increment;
+      Method = "fetch_add";
+      break;
+    case OO_MinusMinus:
+      Op.Kind = OK_Decrement;
+      Method = "fetch_sub";
+      break;
+    case OO_PlusEqual:
+      Op.Kind = OK_Increment;
+      Method = "fetch_add";
+      Argument = getText(Call->getArg(1), Context);
+      break;
+    case OO_MinusEqual:
+      Op.Kind = OK_Decrement;
+      Method = "fetch_sub";
+      Argument = getText(Call->getArg(1), Context);
+      break;
+    default:
+      // Assignments publish a value, like store().
+      Uses.IsCounter = false;
+      return;
+    }
+    // The replacement returns the old value instead of the new one, but
+    // operations whose result is used aren't counters anyway.
+    if (!isValueUnused(Call, Context)) {
+      Uses.IsCounter = false;
+      return;
+    }
+    Op.Loc = Call->getOperatorLoc();
+    if (CanFix && !Call->getLocStart().isMacroID() &&
+        !Call->getLocEnd().isMacroID())
+      Op.Fixes.push_back(FixItHint::CreateReplacement(
+          Call->getSourceRange(), (Object + "." + Method + "(" + Argument +
+                                   ", " + RelaxedOrder + ")")
+                                      .str()));
+  } else {
+    // The counter escapes, e.g. by taking its address or binding it to a
+    // reference.
+    Uses.IsCounter = false;
+    return;
+  }
+
+  if (Op.Kind != OK_Load)
+    Uses.HasImplicitWriter = true;
+  if (OnlyInLoops && !utils::getRepeatingLoop(Ref, Context))
+    return;
+  (Op.Kind == OK_Load ? Uses.Loads : Uses.Writes).push_back(std::move(Op));
+}
+
+void ImplicitAtomicSeqCstCheck::onEndOfTranslationUnit() {
+  for (const auto &Counter : Counters) {
+    const CounterUses &Uses = Counter.second;
+    if (!Uses.IsCounter)
+      continue;
+    for (const Operation &Op : Uses.Writes) {
+      diag(Op.Loc, "atomic counter %0 is %select{incremented|decremented}1 "
+                   "with the implicit sequentially consistent memory order; "
+                   "consider a relaxed operation")
+          << Counter.first << Op.Kind << Op.Fixes;
+    }
+    // A sequentially consistent load still synchronizes with sequentially
+    // consistent writers, so only report it once all of them are relaxed.
+    if (Uses.HasImplicitWriter || !Uses.HasRelaxedWriter)
+      continue;
+    for (const Operation &Op : Uses.Loads) {
+      diag(Op.Loc, "atomic counter %0 is loaded with the implicit sequentially "
+                   "consistent memory order, although it is only modified "
+                   "with relaxed operations; consider a relaxed load")
+          << Counter.first << Op.Fixes;
+    }
+  }
+  Counters.clear();
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
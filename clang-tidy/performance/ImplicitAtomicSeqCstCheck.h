@@ -0,0 +1,65 @@
+//===--- ImplicitAtomicSeqCstCheck.h - clang-tidy----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_IMPLICIT_ATOMIC_SEQ_CST_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_IMPLICIT_ATOMIC_SEQ_CST_H
+
+#include "../ClangTidy.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds operations with the default sequentially consistent memory order on
+/// `std::atomic` integers which are only used as counters, and suggests
+/// relaxed operations.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-implicit-atomic-seq-cst.html
+class ImplicitAtomicSeqCstCheck : public ClangTidyCheck {
+public:
+  ImplicitAtomicSeqCstCheck(StringRef Name, ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void onEndOfTranslationUnit() override;
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  enum OperationKind { OK_Increment, OK_Decrement, OK_Load };
+
+  // An operation with the default memory order on a counter.
+  struct Operation {
+    SourceLocation Loc;
+    OperationKind Kind;
+    llvm::SmallVector<FixItHint, 1> Fixes;
+  };
+
+  struct CounterUses {
+    // Whether the counter is used in a way that may synchronize other memory,
+    // or escapes so that its uses can't be analyzed.
+    bool IsCounter = true;
+    // Whether the counter is modified with the default memory order, or with
+    // an explicit relaxed one.
+    bool HasImplicitWriter = false;
+    bool HasRelaxedWriter = false;
+    llvm::SmallVector<Operation, 4> Writes;
+    llvm::SmallVector<Operation, 4> Loads;
+  };
+
+  const bool OnlyInLoops;
+  llvm::MapVector<const ValueDecl *, CounterUses> Counters;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_IMPLICIT_ATOMIC_SEQ_CST_H
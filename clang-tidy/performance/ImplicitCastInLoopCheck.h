@@ -25,6 +25,7 @@ public:
       : ClangTidyCheck(Name, Context) {}
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
 
 private:
   void ReportAndFix(const ASTContext *Context, const VarDecl *VD,
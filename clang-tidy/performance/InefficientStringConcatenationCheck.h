@@ -28,6 +28,7 @@ public:
                                       ClangTidyContext *Context);
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
   void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
 
 private:
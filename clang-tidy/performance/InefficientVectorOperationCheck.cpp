@@ -10,9 +10,10 @@
 #include "InefficientVectorOperationCheck.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
-#include "clang/Lex/Lexer.h"
 #include "../utils/DeclRefExprUtils.h"
+#include "../utils/LoopTripCount.h"
 #include "../utils/OptionsUtils.h"
+#include <algorithm>
 
 using namespace clang::ast_matchers;
 
@@ -34,104 +35,139 @@ namespace {
 // \endcode
 //
 // The matcher names are bound to following parts of the AST:
-//   - LoopCounterName: The entire for loop (as ForStmt).
+//   - LoopName: The entire for loop (as ForStmt or CXXForRangeStmt).
 //   - LoopParentName: The body of function f (as CompoundStmt).
-//   - VectorVarDeclName: 'v' in  (as VarDecl).
-//   - VectorVarDeclStmatName: The entire 'std::vector<T> v;' statement (as
+//   - ContainerVarDeclName: 'v' in  (as VarDecl).
+//   - ContainerVarDeclStmtName: The entire 'std::vector<T> v;' statement (as
 //     DeclStmt).
-//   - PushBackOrEmplaceBackCallName: 'v.push_back(i)' (as cxxMemberCallExpr).
-//   - LoopInitVarName: 'i' (as VarDecl).
-//   - LoopEndExpr: '10+1' (as Expr).
-static const char LoopCounterName[] = "for_loop_counter";
+//   - AppendCallName: 'v.push_back(i)' (as CallExpr).
+//   - HashContainerInsertCallName, StringAppendCallName: The same call if
+//     'v' is a hash container or a string.
+static const char LoopName[] = "loop";
 static const char LoopParentName[] = "loop_parent";
-static const char VectorVarDeclName[] = "vector_var_decl";
-static const char VectorVarDeclStmtName[] = "vector_var_decl_stmt";
-static const char PushBackOrEmplaceBackCallName[] = "append_call";
-static const char LoopInitVarName[] = "loop_init_var";
-static const char LoopEndExprName[] = "loop_end_expr";
-
-static const char RangeLoopName[] = "for_range_loop";
-
-ast_matchers::internal::Matcher<Expr> supportedContainerTypesMatcher() {
-  return hasType(cxxRecordDecl(hasAnyName(
-      "::std::vector", "::std::set", "::std::unordered_set", "::std::map",
-      "::std::unordered_map", "::std::array", "::std::deque")));
-}
+static const char ContainerVarDeclName[] = "container_var_decl";
+static const char ContainerVarDeclStmtName[] = "container_var_decl_stmt";
+static const char AppendCallName[] = "append_call";
+static const char HashContainerInsertCallName[] = "hash_container_insert_call";
+static const char StringAppendCallName[] = "string_append_call";
 
 } // namespace
 
+static const char DefaultHashContainerClasses[] =
+    "::std::unordered_map;::std::unordered_set;::std::unordered_multimap;"
+    "::std::unordered_multiset";
+
+// Collects the loops enclosing \p Call up to \p Loop, innermost first.
+// Returns false unless the body of each loop consists of the call or the next
+// inner loop only.
+static bool collectLoops(const Stmt *Call, const Stmt *Loop,
+                         ASTContext &Context,
+                         SmallVectorImpl<const Stmt *> &Loops) {
+  const Stmt *Child = Call;
+  while (Child != Loop) {
+    ASTContext::DynTypedNodeList Parents = Context.getParents(*Child);
+    const auto *Parent = Parents.empty() ? nullptr : Parents[0].get<Stmt>();
+    if (!Parent)
+      return false;
+    if (const auto *Compound = dyn_cast<CompoundStmt>(Parent)) {
+      if (Compound->size() != 1)
+        return false;
+    } else if (const auto *For = dyn_cast<ForStmt>(Parent)) {
+      if (For->getBody() != Child)
+        return false;
+      Loops.push_back(For);
+    } else if (const auto *RangeFor = dyn_cast<CXXForRangeStmt>(Parent)) {
+      if (RangeFor->getBody() != Child)
+        return false;
+      Loops.push_back(RangeFor);
+    } else if (!isa<ExprWithCleanups>(Parent) || Child != Call) {
+      return false;
+    }
+    Child = Parent;
+  }
+  return true;
+}
+
 InefficientVectorOperationCheck::InefficientVectorOperationCheck(
     StringRef Name, ClangTidyContext *Context)
     : ClangTidyCheck(Name, Context),
       VectorLikeClasses(utils::options::parseStringList(
-          Options.get("VectorLikeClasses", "::std::vector"))) {}
+          Options.get("VectorLikeClasses", "::std::vector"))),
+      HashContainerClasses(utils::options::parseStringList(
+          Options.get("HashContainerClasses", DefaultHashContainerClasses))),
+      StringLikeClasses(utils::options::parseStringList(
+          Options.get("StringLikeClasses", "::std::basic_string"))) {}
 
 void InefficientVectorOperationCheck::storeOptions(
     ClangTidyOptions::OptionMap &Opts) {
   Options.store(Opts, "VectorLikeClasses",
                 utils::options::serializeStringList(VectorLikeClasses));
+  Options.store(Opts, "HashContainerClasses",
+                utils::options::serializeStringList(HashContainerClasses));
+  Options.store(Opts, "StringLikeClasses",
+                utils::options::serializeStringList(StringLikeClasses));
 }
 
 void InefficientVectorOperationCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus)
+    return;
+
   const auto VectorDecl = cxxRecordDecl(hasAnyName(SmallVector<StringRef, 5>(
       VectorLikeClasses.begin(), VectorLikeClasses.end())));
-  const auto VectorDefaultConstructorCall = cxxConstructExpr(
-      hasType(VectorDecl),
+  const auto HashContainerDecl =
+      cxxRecordDecl(hasAnyName(SmallVector<StringRef, 5>(
+          HashContainerClasses.begin(), HashContainerClasses.end())));
+  const auto StringDecl = cxxRecordDecl(hasAnyName(SmallVector<StringRef, 5>(
+      StringLikeClasses.begin(), StringLikeClasses.end())));
+  const auto ContainerDefaultConstructorCall = cxxConstructExpr(
       hasDeclaration(cxxConstructorDecl(isDefaultConstructor())));
-  const auto VectorVarDecl =
-      varDecl(hasInitializer(VectorDefaultConstructorCall))
-          .bind(VectorVarDeclName);
-  const auto VectorAppendCallExpr =
+  const auto ContainerVarDecl =
+      varDecl(hasInitializer(ContainerDefaultConstructorCall))
+          .bind(ContainerVarDeclName);
+  const auto ContainerVarRef = declRefExpr(to(ContainerVarDecl));
+
+  const auto VectorAppendCall = cxxMemberCallExpr(
+      callee(cxxMethodDecl(hasAnyName("push_back", "emplace_back"))),
+      on(hasType(VectorDecl)), onImplicitObjectArgument(ContainerVarRef));
+  const auto HashContainerInsertCall =
       cxxMemberCallExpr(
-          callee(cxxMethodDecl(hasAnyName("push_back", "emplace_back"))),
-          on(hasType(VectorDecl)),
-          onImplicitObjectArgument(declRefExpr(to(VectorVarDecl))))
-          .bind(PushBackOrEmplaceBackCallName);
-  const auto VectorAppendCall = expr(ignoringImplicit(VectorAppendCallExpr));
-  const auto VectorVarDefStmt =
-      declStmt(hasSingleDecl(equalsBoundNode(VectorVarDeclName)))
-          .bind(VectorVarDeclStmtName);
-
-  const auto LoopVarInit =
-      declStmt(hasSingleDecl(varDecl(hasInitializer(integerLiteral(equals(0))))
-                                 .bind(LoopInitVarName)));
-  const auto RefersToLoopVar = ignoringParenImpCasts(
-      declRefExpr(to(varDecl(equalsBoundNode(LoopInitVarName)))));
-
-  // Matchers for the loop whose body has only 1 push_back/emplace_back calling
-  // statement.
-  const auto HasInterestingLoopBody =
-      hasBody(anyOf(compoundStmt(statementCountIs(1), has(VectorAppendCall)),
-                    VectorAppendCall));
-  const auto InInterestingCompoundStmt =
-      hasParent(compoundStmt(has(VectorVarDefStmt)).bind(LoopParentName));
-
-  // Match counter-based for loops:
-  //  for (int i = 0; i < n; ++i) { v.push_back(...); }
-  //
-  // FIXME: Support more types of counter-based loops like decrement loops.
-  Finder->addMatcher(
-      forStmt(
-          hasLoopInit(LoopVarInit),
-          hasCondition(binaryOperator(
-              hasOperatorName("<"), hasLHS(RefersToLoopVar),
-              hasRHS(expr(unless(hasDescendant(expr(RefersToLoopVar))))
-                         .bind(LoopEndExprName)))),
-          hasIncrement(unaryOperator(hasOperatorName("++"),
-                                     hasUnaryOperand(RefersToLoopVar))),
-          HasInterestingLoopBody, InInterestingCompoundStmt)
-          .bind(LoopCounterName),
-      this);
-
-  // Match for-range loops:
+          anyOf(callee(cxxMethodDecl(hasName("emplace"))),
+                allOf(callee(cxxMethodDecl(hasName("insert"))),
+                      argumentCountIs(1))),
+          on(hasType(HashContainerDecl)),
+          onImplicitObjectArgument(ContainerVarRef))
+          .bind(HashContainerInsertCallName);
+  const auto StringAppendCall =
+      expr(anyOf(cxxMemberCallExpr(
+                     callee(cxxMethodDecl(hasAnyName("push_back", "append"))),
+                     on(hasType(StringDecl)),
+                     onImplicitObjectArgument(ContainerVarRef)),
+                 cxxOperatorCallExpr(
+                     hasOverloadedOperatorName("+="),
+                     hasArgument(0, ignoringParenImpCasts(declRefExpr(
+                                        hasType(StringDecl),
+                                        to(ContainerVarDecl)))))))
+          .bind(StringAppendCallName);
+  const auto AppendCall =
+      expr(anyOf(VectorAppendCall, HashContainerInsertCall, StringAppendCall))
+          .bind(AppendCallName);
+  const auto ContainerVarDefStmt =
+      declStmt(hasSingleDecl(equalsBoundNode(ContainerVarDeclName)))
+          .bind(ContainerVarDeclStmtName);
+
+  // Match loops, possibly nested, whose innermost body is a single append
+  // call:
+  //   for (int i = 0; i < n; ++i) { v.push_back(...); }
   //   for (const auto& E : data) { v.push_back(...); }
+  //   for (int i = 0; i < n; ++i) for (int j = 0; j < m; ++j) s += ' ';
   //
-  // FIXME: Support more complex range-expressions.
+  // The shape of the loop nest is verified and the trip count is computed in
+  // check().
   Finder->addMatcher(
-      cxxForRangeStmt(
-          hasRangeInit(declRefExpr(supportedContainerTypesMatcher())),
-          HasInterestingLoopBody, InInterestingCompoundStmt)
-          .bind(RangeLoopName),
+      stmt(anyOf(forStmt(), cxxForRangeStmt()), hasDescendant(AppendCall),
+           hasParent(compoundStmt(has(ContainerVarDefStmt))
+                         .bind(LoopParentName)))
+          .bind(LoopName),
       this);
 }
 
@@ -142,24 +178,24 @@ void InefficientVectorOperationCheck::check(
     return;
 
   const SourceManager &SM = *Result.SourceManager;
-  const auto *VectorVarDecl =
-      Result.Nodes.getNodeAs<VarDecl>(VectorVarDeclName);
-  const auto *ForLoop = Result.Nodes.getNodeAs<ForStmt>(LoopCounterName);
-  const auto *RangeLoop =
-      Result.Nodes.getNodeAs<CXXForRangeStmt>(RangeLoopName);
-  const auto *VectorAppendCall =
-      Result.Nodes.getNodeAs<CXXMemberCallExpr>(PushBackOrEmplaceBackCallName);
-  const auto *LoopEndExpr = Result.Nodes.getNodeAs<Expr>(LoopEndExprName);
+  const auto *ContainerVarDecl =
+      Result.Nodes.getNodeAs<VarDecl>(ContainerVarDeclName);
+  const auto *LoopStmt = Result.Nodes.getNodeAs<Stmt>(LoopName);
+  const auto *AppendCall = Result.Nodes.getNodeAs<CallExpr>(AppendCallName);
   const auto *LoopParent = Result.Nodes.getNodeAs<CompoundStmt>(LoopParentName);
+  const FunctionDecl *Callee = AppendCall->getDirectCallee();
+  if (!Callee)
+    return;
 
-  const Stmt *LoopStmt = ForLoop;
-  if (!LoopStmt)
-    LoopStmt = RangeLoop;
+  SmallVector<const Stmt *, 2> Loops;
+  if (!collectLoops(AppendCall, LoopStmt, *Context, Loops))
+    return;
+  std::reverse(Loops.begin(), Loops.end());
 
-  llvm::SmallPtrSet<const DeclRefExpr *, 16> AllVectorVarRefs =
-      utils::decl_ref_expr::allDeclRefExprs(*VectorVarDecl, *LoopParent,
+  llvm::SmallPtrSet<const DeclRefExpr *, 16> AllContainerVarRefs =
+      utils::decl_ref_expr::allDeclRefExprs(*ContainerVarDecl, *LoopParent,
                                             *Context);
-  for (const auto *Ref : AllVectorVarRefs) {
+  for (const auto *Ref : AllContainerVarRefs) {
     // Skip cases where there are usages (defined as DeclRefExpr that refers to
     // "v") of vector variable `v` before the for loop. We consider these usages
     // are operations causing memory preallocation (e.g. "v.resize(n)",
@@ -173,40 +209,32 @@ void InefficientVectorOperationCheck::check(
     }
   }
 
-  llvm::StringRef VectorVarName = Lexer::getSourceText(
-      CharSourceRange::getTokenRange(
-          VectorAppendCall->getImplicitObjectArgument()->getSourceRange()),
-      SM, Context->getLangOpts());
-
-  std::string ReserveStmt;
-  // Handle for-range loop cases.
-  if (RangeLoop) {
-    // Get the range-expression in a for-range statement represented as
-    // `for (range-declarator: range-expression)`.
-    StringRef RangeInitExpName = Lexer::getSourceText(
-        CharSourceRange::getTokenRange(
-            RangeLoop->getRangeInit()->getSourceRange()),
-        SM, Context->getLangOpts());
-
-    ReserveStmt =
-        (VectorVarName + ".reserve(" + RangeInitExpName + ".size()" + ");\n")
-            .str();
-  } else if (ForLoop) {
-    // Handle counter-based loop cases.
-    StringRef LoopEndSource = Lexer::getSourceText(
-        CharSourceRange::getTokenRange(LoopEndExpr->getSourceRange()), SM,
-        Context->getLangOpts());
-    ReserveStmt = (VectorVarName + ".reserve(" + LoopEndSource + ");\n").str();
-  }
+  llvm::Optional<std::string> TripCount =
+      utils::getNestedLoopTripCount(Loops, *Context);
+  if (!TripCount)
+    return;
 
-  auto Diag =
-      diag(VectorAppendCall->getLocStart(),
-           "%0 is called inside a loop; "
-           "consider pre-allocating the vector capacity before the loop")
-      << VectorAppendCall->getMethodDecl()->getDeclName();
+  StringRef ContainerKind = "vector";
+  if (Result.Nodes.getNodeAs<Expr>(HashContainerInsertCallName))
+    ContainerKind = "container";
+  else if (Result.Nodes.getNodeAs<Expr>(StringAppendCallName))
+    ContainerKind = "string";
+
+  auto Diag = diag(AppendCall->getLocStart(),
+                   "%0 is called inside a loop; "
+                   "consider pre-allocating the %1 capacity before the loop")
+              << Callee->getDeclName() << ContainerKind;
+
+  // The number of characters appended to a string is only known if a single
+  // character is appended in each iteration.
+  if (ContainerKind == "string" &&
+      (Callee->getNumParams() != 1 ||
+       !Callee->getParamDecl(0)->getType()->isAnyCharacterType()))
+    return;
 
-  if (!ReserveStmt.empty())
-    Diag << FixItHint::CreateInsertion(LoopStmt->getLocStart(), ReserveStmt);
+  std::string ReserveStmt =
+      (ContainerVarDecl->getName() + ".reserve(" + *TripCount + ");\n").str();
+  Diag << FixItHint::CreateInsertion(LoopStmt->getLocStart(), ReserveStmt);
 }
 
 } // namespace performance
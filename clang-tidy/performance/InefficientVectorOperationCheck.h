@@ -16,8 +16,9 @@ namespace clang {
 namespace tidy {
 namespace performance {
 
-/// Finds possible inefficient `std::vector` operations (e.g. `push_back`) in
-/// for loops that may cause unnecessary memory reallocations.
+/// Finds possible inefficient `std::vector` operations (e.g. `push_back`), hash
+/// container insertions and string appends in for loops that may cause
+/// unnecessary memory reallocations.
 ///
 /// For the user-facing documentation see:
 /// http://clang.llvm.org/extra/clang-tidy/checks/performance-inefficient-vector-operation.html
@@ -26,10 +27,13 @@ public:
   InefficientVectorOperationCheck(StringRef Name, ClangTidyContext *Context);
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
   void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
 
 private:
   const std::vector<std::string> VectorLikeClasses;
+  const std::vector<std::string> HashContainerClasses;
+  const std::vector<std::string> StringLikeClasses;
 };
 
 } // namespace performance
@@ -0,0 +1,164 @@
+//===--- IostreamHotPathCheck.cpp - clang-tidy-----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IostreamHotPathCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/DeclRefExprUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Lex/Lexer.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+// Returns the expression written to \p Stream if \p S is a statement of the
+// form `Stream << Value;`.
+static const Expr *getInsertedValue(const Stmt *S, const VarDecl *Stream) {
+  if (const auto *Cleanups = dyn_cast<ExprWithCleanups>(S))
+    S = Cleanups->getSubExpr();
+  const auto *Call = dyn_cast<CXXOperatorCallExpr>(S);
+  if (!Call || Call->getOperator() != OO_LessLess || Call->getNumArgs() != 2)
+    return nullptr;
+  const auto *Ref = dyn_cast<DeclRefExpr>(Call->getArg(0)->IgnoreImpCasts());
+  if (!Ref || Ref->getDecl() != Stream)
+    return nullptr;
+  return Call->getArg(1)->IgnoreImpCasts();
+}
+
+void IostreamHotPathCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  Finder->addMatcher(
+      declRefExpr(to(functionDecl(hasName("::std::endl"))),
+                  hasParent(implicitCastExpr(hasParent(cxxOperatorCallExpr(
+                      hasOverloadedOperatorName("<<"))))),
+                  unless(isInTemplateInstantiation()))
+          .bind("endl"),
+      this);
+
+  const auto StringStream = classTemplateSpecializationDecl(
+      hasAnyName("::std::basic_stringstream", "::std::basic_ostringstream",
+                 "::std::basic_istringstream"),
+      templateArgumentCountIs(3),
+      hasTemplateArgument(0, refersToType(asString("char"))));
+  Finder->addMatcher(
+      varDecl(hasLocalStorage(), unless(parmVarDecl()),
+              hasType(qualType(hasUnqualifiedDesugaredType(
+                  recordType(hasDeclaration(StringStream))))),
+              hasParent(declStmt(hasParent(compoundStmt().bind("scope")))
+                            .bind("decl-stmt")),
+              unless(isInTemplateInstantiation()))
+          .bind("stream"),
+      this);
+}
+
+void IostreamHotPathCheck::check(const MatchFinder::MatchResult &Result) {
+  ASTContext &Context = *Result.Context;
+  if (const auto *Endl = Result.Nodes.getNodeAs<DeclRefExpr>("endl")) {
+    if (!utils::getRepeatingLoop(Endl, Context))
+      return;
+    auto Diag = diag(Endl->getLocStart(),
+                     "'std::endl' flushes the stream in each loop iteration; "
+                     "use '\\n' instead and flush the stream after the loop "
+                     "if needed");
+    if (!Endl->getLocStart().isMacroID() && !Endl->getLocEnd().isMacroID())
+      Diag << FixItHint::CreateReplacement(Endl->getSourceRange(), "'\\n'");
+    return;
+  }
+
+  const auto *Stream = Result.Nodes.getNodeAs<VarDecl>("stream");
+  const auto *StreamDecl = Result.Nodes.getNodeAs<DeclStmt>("decl-stmt");
+  const auto *Scope = Result.Nodes.getNodeAs<CompoundStmt>("scope");
+  if (checkSingleConversion(Stream, StreamDecl, Scope, Context))
+    return;
+  if (utils::getRepeatingLoop(StreamDecl, Context))
+    diag(Stream->getLocation(),
+         "string stream %0 is constructed in each loop iteration; declare it "
+         "before the loop and reset it with 'str(\"\")' and 'clear()'")
+        << Stream;
+}
+
+bool IostreamHotPathCheck::checkSingleConversion(const VarDecl *Stream,
+                                                 const DeclStmt *StreamDecl,
+                                                 const CompoundStmt *Scope,
+                                                 ASTContext &Context) {
+  // The stream must be default constructed.
+  const auto *Construct = dyn_cast_or_null<CXXConstructExpr>(Stream->getInit());
+  if (!Construct || !StreamDecl->isSingleDecl())
+    return false;
+  for (const Expr *Arg : Construct->arguments())
+    if (!isa<CXXDefaultArgExpr>(Arg))
+      return false;
+
+  // It's written to by the statement following the declaration, and its
+  // contents are retrieved by the one after that.
+  auto It = std::find(Scope->body_begin(), Scope->body_end(), StreamDecl);
+  if (Scope->body_end() - It < 3)
+    return false;
+  const Stmt *Insertion = *++It;
+  const Stmt *Use = *++It;
+  const Expr *Value = getInsertedValue(Insertion, Stream);
+  if (!Value || Value->HasSideEffects(Context))
+    return false;
+  const auto *Builtin = Value->getType()->getAs<BuiltinType>();
+  if (!Builtin || Builtin->isBooleanType() || Builtin->isAnyCharacterType() ||
+      !(Builtin->isInteger() || Builtin->isFloatingPoint()))
+    return false;
+
+  const CXXMemberCallExpr *StrCall = nullptr;
+  auto Refs = utils::decl_ref_expr::allDeclRefExprs(*Stream, *Scope, Context);
+  if (Refs.size() != 2)
+    return false;
+  for (const BoundNodes &Nodes :
+       match(findAll(cxxMemberCallExpr(
+                         on(declRefExpr(to(varDecl(equalsNode(Stream))))),
+                         callee(cxxMethodDecl(hasName("str"),
+                                              parameterCountIs(0))))
+                         .bind("str")),
+             *Use, Context))
+    StrCall = Nodes.getNodeAs<CXXMemberCallExpr>("str");
+  if (!StrCall || utils::getRepeatingLoop(StrCall, Context) !=
+                      utils::getRepeatingLoop(StreamDecl, Context))
+    return false;
+  for (const DeclRefExpr *Ref : Refs)
+    if (Ref->refersToEnclosingVariableOrCapture())
+      return false;
+
+  const bool IsInteger = Builtin->isInteger();
+  auto Diag = diag(Stream->getLocation(),
+                   "string stream %0 is only used to convert a single "
+                   "%select{integer|floating-point value}1 to a string; use "
+                   "'%select{std::to_string|std::to_chars}1' instead")
+              << Stream << (IsInteger ? 0 : 1);
+  // 'std::to_string' formats floating-point values differently than streams
+  // do, so only integers are replaced.
+  if (!IsInteger || StreamDecl->getLocStart().isMacroID() ||
+      Use->getLocStart().isMacroID() || Value->getLocStart().isMacroID() ||
+      Value->getLocEnd().isMacroID() || StrCall->getLocStart().isMacroID() ||
+      StrCall->getLocEnd().isMacroID())
+    return true;
+  StringRef ValueText = Lexer::getSourceText(
+      CharSourceRange::getTokenRange(Value->getSourceRange()),
+      Context.getSourceManager(), getLangOpts());
+  Diag << FixItHint::CreateRemoval(
+              CharSourceRange::getCharRange(StreamDecl->getLocStart(),
+                                            Use->getLocStart()))
+       << FixItHint::CreateReplacement(
+              StrCall->getSourceRange(),
+              (llvm::Twine("std::to_string(") + ValueText + ")").str());
+  return true;
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
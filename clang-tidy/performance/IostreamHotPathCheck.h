@@ -0,0 +1,42 @@
+//===--- IostreamHotPathCheck.h - clang-tidy---------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_IOSTREAM_HOT_PATH_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_IOSTREAM_HOT_PATH_H
+
+#include "../ClangTidy.h"
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds expensive uses of iostreams: `std::endl` flushing the stream in each
+/// loop iteration, string streams which are only used to convert a single
+/// number to a string, and string streams constructed in each loop iteration.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-iostream-hot-path.html
+class IostreamHotPathCheck : public ClangTidyCheck {
+public:
+  IostreamHotPathCheck(StringRef Name, ClangTidyContext *Context)
+      : ClangTidyCheck(Name, Context) {}
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
+
+private:
+  bool checkSingleConversion(const VarDecl *Stream, const DeclStmt *StreamDecl,
+                             const CompoundStmt *Scope, ASTContext &Context);
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_IOSTREAM_HOT_PATH_H
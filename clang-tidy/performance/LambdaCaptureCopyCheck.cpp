@@ -0,0 +1,311 @@
+//===--- LambdaCaptureCopyCheck.cpp - clang-tidy---------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LambdaCaptureCopyCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/DeclRefExprUtils.h"
+#include "../utils/OptionsUtils.h"
+#include "../utils/TypeTraits.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Basic/CharInfo.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Preprocessor.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+static const char DefaultNonEscapingFunctions[] =
+    "::std::all_of;::std::any_of;::std::none_of;::std::for_each;"
+    "::std::find_if;::std::find_if_not;::std::count_if;::std::remove_if;"
+    "::std::transform;::std::sort;::std::stable_sort;::std::accumulate";
+
+enum SuggestionKind { SK_Reference, SK_Move };
+
+// Returns the node which uses the value of \p E, skipping parentheses,
+// implicit conversions and copies, and updates \p E to the outermost skipped
+// expression.
+static ast_type_traits::DynTypedNode getUser(const Expr *&E,
+                                             ASTContext &Context) {
+  while (true) {
+    ASTContext::DynTypedNodeList Parents = Context.getParents(*E);
+    if (Parents.empty())
+      return ast_type_traits::DynTypedNode();
+    const auto *Parent = Parents[0].get<Expr>();
+    const auto *Construct = dyn_cast_or_null<CXXConstructExpr>(Parent);
+    if (!Parent ||
+        !(isa<ParenExpr>(Parent) || isa<ImplicitCastExpr>(Parent) ||
+          isa<MaterializeTemporaryExpr>(Parent) ||
+          isa<CXXBindTemporaryExpr>(Parent) || isa<ExprWithCleanups>(Parent) ||
+          (Construct && !isa<CXXTemporaryObjectExpr>(Construct) &&
+           Construct->getNumArgs() == 1)))
+      return Parents[0];
+    E = Parent;
+  }
+}
+
+// Returns true if \p E is only used as the callee of a call.
+static bool isCalled(const Expr *E, ASTContext &Context) {
+  const auto *Call = getUser(E, Context).get<CXXOperatorCallExpr>();
+  return Call && Call->getOperator() == OO_Call && Call->getArg(0) == E;
+}
+
+// Returns true if \p Var isn't read or aliased after the creation of
+// \p Lambda, so that it can be moved into the closure.
+static bool isDeadAfter(const VarDecl *Var, const LambdaExpr *Lambda,
+                        const FunctionDecl *Function, ASTContext &Context) {
+  if (!Var->hasLocalStorage() || Var->getType().isConstQualified())
+    return false;
+  const SourceManager &SM = Context.getSourceManager();
+
+  // A later iteration of a loop around the lambda reads the variable again.
+  for (const Stmt *Parent = utils::getParentStmt(Lambda, Context); Parent;
+       Parent = utils::getParentStmt(Parent, Context)) {
+    if (isa<LambdaExpr>(Parent))
+      return false;
+    if ((isa<ForStmt>(Parent) || isa<CXXForRangeStmt>(Parent) ||
+         isa<WhileStmt>(Parent) || isa<DoStmt>(Parent)) &&
+        SM.isBeforeInTranslationUnit(Var->getLocation(),
+                                     Parent->getLocStart()))
+      return false;
+  }
+
+  for (const DeclRefExpr *Ref :
+       utils::decl_ref_expr::allDeclRefExprs(*Var, *Function, Context)) {
+    SourceLocation Loc = Ref->getLocation();
+    if (SM.isBeforeInTranslationUnit(Lambda->getLocEnd(), Loc))
+      return false;
+    if (!SM.isBeforeInTranslationUnit(Loc, Lambda->getLocStart()))
+      continue;
+    // References and pointers to the variable may be used later.
+    const Expr *E = Ref;
+    ast_type_traits::DynTypedNode User = getUser(E, Context);
+    if (const auto *Alias = User.get<VarDecl>()) {
+      if (Alias->getType()->isReferenceType())
+        return false;
+    } else if (const auto *Op = User.get<UnaryOperator>()) {
+      if (Op->getOpcode() == UO_AddrOf)
+        return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if an argument of \p Call other than \p Lambda refers to
+// \p Var, e.g. an output iterator into a container.
+static bool isReferencedByOtherArgs(const VarDecl *Var, const CallExpr *Call,
+                                    const LambdaExpr *Lambda,
+                                    ASTContext &Context) {
+  for (const Expr *Arg : Call->arguments()) {
+    if (match(findAll(expr(equalsNode(Lambda))), *Arg, Context).empty() &&
+        !match(findAll(declRefExpr(to(equalsNode(Var)))), *Arg, Context)
+             .empty())
+      return true;
+  }
+  return false;
+}
+
+// Returns the location of the comma right before \p Loc, or an invalid
+// location if there is anything but whitespace in between.
+static SourceLocation getPrecedingComma(SourceLocation Loc,
+                                        const SourceManager &SM) {
+  const char *Begin = SM.getCharacterData(Loc);
+  const char *P = Begin - 1;
+  while (isWhitespace(*P))
+    --P;
+  return *P == ',' ? Loc.getLocWithOffset(P - Begin) : SourceLocation();
+}
+
+LambdaCaptureCopyCheck::LambdaCaptureCopyCheck(StringRef Name,
+                                               ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      NonEscapingFunctions(utils::options::parseStringList(Options.get(
+          "NonEscapingFunctions", DefaultNonEscapingFunctions))),
+      IncludeStyle(utils::IncludeSorter::parseIncludeStyle(
+          Options.get("IncludeStyle", "llvm"))) {}
+
+void LambdaCaptureCopyCheck::storeOptions(ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "NonEscapingFunctions",
+                utils::options::serializeStringList(NonEscapingFunctions));
+  Options.store(Opts, "IncludeStyle",
+                utils::IncludeSorter::toString(IncludeStyle));
+}
+
+void LambdaCaptureCopyCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  Finder->addMatcher(
+      lambdaExpr(unless(isInTemplateInstantiation())).bind("lambda"), this);
+}
+
+// Returns true if the closure created by \p Lambda may be called after the
+// full expression or the variable it is stored in ends. Sets \p Closure if the
+// closure is stored in a local variable, and \p Algorithm if it is passed to
+// one of the NonEscapingFunctions.
+bool LambdaCaptureCopyCheck::outlivesScope(const LambdaExpr *Lambda,
+                                           ASTContext &Context,
+                                           const VarDecl *&Closure,
+                                           const CallExpr *&Algorithm) const {
+  const Expr *E = Lambda;
+  ast_type_traits::DynTypedNode User = getUser(E, Context);
+
+  if (const auto *Call = User.get<CallExpr>()) {
+    // Immediately invoked lambdas.
+    if (const auto *Op = dyn_cast<CXXOperatorCallExpr>(Call))
+      return Op->getOperator() != OO_Call || Op->getArg(0) != E;
+    // Algorithms which only call the lambda before they return.
+    const FunctionDecl *Callee = Call->getDirectCallee();
+    if (!Callee || Call->getCallee()->IgnoreParenImpCasts() == E)
+      return true;
+    const std::string Name = Callee->getQualifiedNameAsString();
+    for (StringRef NonEscaping : NonEscapingFunctions) {
+      if (NonEscaping.ltrim(':') == Name) {
+        Algorithm = Call;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Local variables holding the closure, which are only called.
+  const auto *Var = User.get<VarDecl>();
+  if (!Var || !Var->hasLocalStorage() ||
+      Var->getType()->getAsCXXRecordDecl() != Lambda->getLambdaClass())
+    return true;
+  const FunctionDecl *Function =
+      utils::getSurroundingFunction(Context, *Lambda);
+  if (!Function)
+    return true;
+  for (const DeclRefExpr *Ref :
+       utils::decl_ref_expr::allDeclRefExprs(*Var, *Function, Context)) {
+    if (!isCalled(Ref, Context))
+      return true;
+  }
+  Closure = Var;
+  return false;
+}
+
+void LambdaCaptureCopyCheck::check(const MatchFinder::MatchResult &Result) {
+  const auto *Lambda = Result.Nodes.getNodeAs<LambdaExpr>("lambda");
+  ASTContext &Context = *Result.Context;
+  const FunctionDecl *Function =
+      utils::getSurroundingFunction(Context, *Lambda);
+  if (!Function || !Function->getBody())
+    return;
+
+  const VarDecl *Closure = nullptr;
+  const CallExpr *Algorithm = nullptr;
+  const bool Outlives = outlivesScope(Lambda, Context, Closure, Algorithm);
+  const bool CanMove = getLangOpts().CPlusPlus14;
+
+  struct Suggestion {
+    const LambdaCapture *Capture;
+    SuggestionKind Kind;
+  };
+  llvm::SmallVector<Suggestion, 4> Suggestions;
+  for (const LambdaCapture &Capture : Lambda->captures()) {
+    if (!Capture.capturesVariable() ||
+        Capture.getCaptureKind() != LCK_ByCopy || Capture.isPackExpansion())
+      continue;
+    const VarDecl *Var = Capture.getCapturedVar();
+    if (Var->isInitCapture() || Var->getType()->isReferenceType() ||
+        Var->getType()->isDependentType())
+      continue;
+    llvm::Optional<bool> Expensive =
+        utils::type_traits::isExpensiveToCopy(Var->getType(), Context);
+    if (!Expensive || !*Expensive)
+      continue;
+    if (!utils::decl_ref_expr::isOnlyUsedAsConst(*Var, *Lambda->getBody(),
+                                                 Context))
+      continue;
+
+    // A closure stored in a variable may be called after the captured
+    // variable changes, and an algorithm may change it through its other
+    // arguments while calling the lambda. The lambda must not observe either.
+    const bool ReferencedByArgs =
+        Algorithm && isReferencedByOtherArgs(Var, Algorithm, Lambda, Context);
+    if (!Outlives &&
+        ((!Closure && !ReferencedByArgs) ||
+         utils::decl_ref_expr::isOnlyUsedAsConst(*Var, *Function->getBody(),
+                                                 Context)))
+      Suggestions.push_back({&Capture, SK_Reference});
+    else if (CanMove && !ReferencedByArgs &&
+             isDeadAfter(Var, Lambda, Function, Context))
+      Suggestions.push_back({&Capture, SK_Move});
+  }
+
+  // Implicit captures can only be spelled out after the capture default, so
+  // their fixes are combined into a single insertion.
+  std::string ImplicitCaptures;
+  for (const Suggestion &S : Suggestions) {
+    if (S.Capture->isImplicit()) {
+      const std::string Name = S.Capture->getCapturedVar()->getName();
+      ImplicitCaptures += S.Kind == SK_Reference
+                              ? ", &" + Name
+                              : ", " + Name + " = std::move(" + Name + ")";
+    }
+  }
+
+  const bool CanFix = !Lambda->getLocStart().isMacroID() &&
+                      !Lambda->getLocEnd().isMacroID();
+  bool InsertedImplicit = false;
+  bool InsertedInclude = false;
+  for (const Suggestion &S : Suggestions) {
+    const VarDecl *Var = S.Capture->getCapturedVar();
+    auto Diag = diag(S.Capture->getLocation(),
+                     "%0 of type %1 is copied into the lambda which only "
+                     "reads it; consider %select{capturing it by "
+                     "reference|moving it into an init-capture}2")
+                << Var << Var->getType() << S.Kind;
+    if (!CanFix)
+      continue;
+    if (S.Capture->isExplicit() && S.Kind == SK_Reference &&
+        Lambda->getCaptureDefault() == LCD_ByRef) {
+      // '&Name' is redundant after a '&' capture default, which is an error,
+      // so the capture is removed instead.
+      SourceLocation Comma =
+          getPrecedingComma(S.Capture->getLocation(), *Result.SourceManager);
+      if (Comma.isValid())
+        Diag << FixItHint::CreateRemoval(
+            CharSourceRange::getTokenRange(Comma, S.Capture->getLocation()));
+    } else if (S.Capture->isExplicit()) {
+      const std::string Name = Var->getName();
+      Diag << FixItHint::CreateReplacement(
+          CharSourceRange::getTokenRange(S.Capture->getLocation()),
+          S.Kind == SK_Reference ? "&" + Name
+                                 : Name + " = std::move(" + Name + ")");
+    } else if (!InsertedImplicit) {
+      Diag << FixItHint::CreateInsertion(
+          Lambda->getCaptureDefaultLoc().getLocWithOffset(1),
+          ImplicitCaptures);
+      InsertedImplicit = true;
+    }
+    if (S.Kind == SK_Move && !InsertedInclude) {
+      if (auto IncludeFixit = Inserter->CreateIncludeInsertion(
+              Result.SourceManager->getFileID(Lambda->getLocStart()),
+              "utility", /*IsAngled=*/true))
+        Diag << *IncludeFixit;
+      InsertedInclude = true;
+    }
+  }
+}
+
+void LambdaCaptureCopyCheck::registerPPCallbacks(CompilerInstance &Compiler) {
+  Inserter.reset(new utils::IncludeInserter(
+      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
+  Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,390 @@
+//===--- LockInLoopCheck.cpp - clang-tidy----------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LockInLoopCheck.h"
+#include "../utils/OptionsUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "llvm/ADT/StringSwitch.h"
+#include <algorithm>
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+static const char DefaultLockTypes[] =
+    "::std::lock_guard;::std::unique_lock;::std::scoped_lock;"
+    "::std::shared_lock";
+
+static const char DefaultMutexTypes[] =
+    "::std::mutex;::std::recursive_mutex;::std::timed_mutex;"
+    "::std::recursive_timed_mutex;::std::shared_mutex;"
+    "::std::shared_timed_mutex";
+
+static const char DefaultSlowFunctions[] =
+    "::printf;::fprintf;::puts;::fputs;::fwrite;::fread;::fflush;::fopen;"
+    "::fclose;::read;::write;::std::getline;::std::this_thread::sleep_for;"
+    "::std::this_thread::sleep_until";
+
+// Returns the variable or field \p E refers to, if it names a mutex directly.
+static const ValueDecl *getMutexDecl(const Expr *E) {
+  E = E->IgnoreParenImpCasts();
+  if (const auto *Ref = dyn_cast<DeclRefExpr>(E))
+    return Ref->getDecl();
+  if (const auto *Member = dyn_cast<MemberExpr>(E))
+    return Member->getMemberDecl();
+  return nullptr;
+}
+
+static bool isWithin(SourceLocation Loc, const Stmt *S,
+                     const SourceManager &SM) {
+  return !SM.isBeforeInTranslationUnit(Loc, S->getLocStart()) &&
+         !SM.isBeforeInTranslationUnit(S->getLocEnd(), Loc);
+}
+
+// Returns true if \p E names the same mutex in each iteration of \p Loop.
+static bool isLoopInvariant(const Expr *E, const Stmt *Loop,
+                            const SourceManager &SM) {
+  E = E->IgnoreParenImpCasts();
+  if (isa<CXXThisExpr>(E))
+    return true;
+  if (const auto *Member = dyn_cast<MemberExpr>(E))
+    return isLoopInvariant(Member->getBase(), Loop, SM);
+  if (const auto *Ref = dyn_cast<DeclRefExpr>(E)) {
+    // Pointers may be reassigned in the loop.
+    const auto *Var = dyn_cast<VarDecl>(Ref->getDecl());
+    return Var && !Var->getType()->isPointerType() &&
+           !isWithin(Var->getLocation(), Loop, SM);
+  }
+  return false;
+}
+
+static bool refersTo(const Stmt *S, const VarDecl *Var) {
+  if (const auto *Ref = dyn_cast_or_null<DeclRefExpr>(S))
+    return Ref->getDecl() == Var;
+  for (const Stmt *Child : S->children())
+    if (Child && refersTo(Child, Var))
+      return true;
+  return false;
+}
+
+// Returns true if \p S unlocks the mutex acquired by \p Guard, or \p Mutex if
+// it was locked by calling 'lock()'.
+static bool isUnlock(const Stmt *S, const VarDecl *Guard,
+                     const ValueDecl *Mutex) {
+  const auto *Call = dyn_cast<CXXMemberCallExpr>(S);
+  if (!Call || !Call->getMethodDecl() ||
+      !Call->getMethodDecl()->getDeclName().isIdentifier() ||
+      Call->getMethodDecl()->getName() != "unlock")
+    return false;
+  const Expr *Object = Call->getImplicitObjectArgument();
+  if (Guard) {
+    const auto *Ref = dyn_cast<DeclRefExpr>(Object->IgnoreParenImpCasts());
+    return Ref && Ref->getDecl() == Guard;
+  }
+  return getMutexDecl(Object) == Mutex;
+}
+
+static bool isStdFunction(const FunctionDecl *Function) {
+  for (const DeclContext *Context = Function->getDeclContext(); Context;
+       Context = Context->getParent())
+    if (Context->isStdNamespace())
+      return true;
+  return false;
+}
+
+static bool isStreamClass(const CXXRecordDecl *Record) {
+  if (!Record || !Record->hasDefinition())
+    return false;
+  const std::string Name = Record->getQualifiedNameAsString();
+  if (Name == "std::basic_ostream" || Name == "std::basic_istream")
+    return true;
+  for (const CXXBaseSpecifier &Base : Record->bases())
+    if (isStreamClass(Base.getType()->getAsCXXRecordDecl()))
+      return true;
+  return false;
+}
+
+static bool isLoop(const Stmt *S) {
+  return isa<ForStmt>(S) || isa<CXXForRangeStmt>(S) || isa<WhileStmt>(S) ||
+         isa<DoStmt>(S);
+}
+
+// Returns true if \p S allocates memory, either directly or by growing a
+// standard container.
+static bool containsAllocation(const Stmt *S) {
+  if (isa<CXXNewExpr>(S))
+    return true;
+  if (isa<LambdaExpr>(S))
+    return false;
+  if (const auto *Call = dyn_cast<CallExpr>(S)) {
+    const FunctionDecl *Callee = Call->getDirectCallee();
+    if (Callee && Callee->getDeclName().isIdentifier()) {
+      const auto *Method = dyn_cast<CXXMethodDecl>(Callee);
+      if (Method ? isStdFunction(Method) &&
+                       llvm::StringSwitch<bool>(Method->getName())
+                           .Cases("push_back", "emplace_back", "emplace",
+                                  "insert", true)
+                           .Cases("append", "resize", "reserve", true)
+                           .Default(false)
+                 : llvm::StringSwitch<bool>(Callee->getName())
+                       .Cases("malloc", "calloc", "realloc", true)
+                       .Default(false))
+        return true;
+    }
+  }
+  for (const Stmt *Child : S->children())
+    if (Child && containsAllocation(Child))
+      return true;
+  return false;
+}
+
+LockInLoopCheck::LockInLoopCheck(StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      LockTypes(utils::options::parseStringList(
+          Options.get("LockTypes", DefaultLockTypes))),
+      MutexTypes(utils::options::parseStringList(
+          Options.get("MutexTypes", DefaultMutexTypes))),
+      SlowFunctions(utils::options::parseStringList(
+          Options.get("SlowFunctions", DefaultSlowFunctions))) {}
+
+void LockInLoopCheck::storeOptions(ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "LockTypes",
+                utils::options::serializeStringList(LockTypes));
+  Options.store(Opts, "MutexTypes",
+                utils::options::serializeStringList(MutexTypes));
+  Options.store(Opts, "SlowFunctions",
+                utils::options::serializeStringList(SlowFunctions));
+}
+
+void LockInLoopCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  // Lock guards constructed from a single mutex, which lock it until the end
+  // of the scope.
+  if (!LockTypes.empty()) {
+    const auto LockType = qualType(hasUnqualifiedDesugaredType(
+        recordType(hasDeclaration(classTemplateSpecializationDecl(hasAnyName(
+            SmallVector<StringRef, 4>(LockTypes.begin(), LockTypes.end())))))));
+    Finder->addMatcher(
+        declStmt(hasSingleDecl(varDecl(hasLocalStorage(), hasType(LockType),
+                                       hasInitializer(ignoringImplicit(
+                                           cxxConstructExpr(argumentCountIs(1))
+                                               .bind("construct"))))
+                                   .bind("guard")),
+                 hasParent(compoundStmt().bind("scope")),
+                 unless(isInTemplateInstantiation()))
+            .bind("lock"),
+        this);
+  }
+
+  // Explicit calls to 'lock()', which must be followed by 'unlock()' in the
+  // same scope.
+  if (!MutexTypes.empty()) {
+    Finder->addMatcher(
+        cxxMemberCallExpr(
+            callee(cxxMethodDecl(
+                hasName("lock"),
+                ofClass(cxxRecordDecl(hasAnyName(SmallVector<StringRef, 8>(
+                    MutexTypes.begin(), MutexTypes.end())))))),
+            hasParent(compoundStmt().bind("scope")),
+            unless(isInTemplateInstantiation()))
+            .bind("lock"),
+        this);
+  }
+}
+
+bool LockInLoopCheck::isSlowFunction(const FunctionDecl *Function,
+                                     ASTContext &Context) const {
+  if (SlowFunctions.empty())
+    return false;
+  return !match(functionDecl(hasAnyName(SmallVector<StringRef, 8>(
+                    SlowFunctions.begin(), SlowFunctions.end()))),
+                *Function, Context)
+              .empty();
+}
+
+// Returns true if \p S may access state guarded by the lock. Without
+// annotations, members, globals and objects referred to by references or
+// pointers declared before the critical section are all assumed to be
+// guarded, as is everything reachable from calls to functions outside the
+// standard library.
+bool LockInLoopCheck::accessesGuardedState(const Stmt *S,
+                                           const VarDecl *Guard,
+                                           SourceLocation SectionStart,
+                                           ASTContext &Context) const {
+  const SourceManager &SM = Context.getSourceManager();
+  if (isa<CXXThisExpr>(S))
+    return true;
+  if (const auto *Ref = dyn_cast<DeclRefExpr>(S)) {
+    const auto *Var = dyn_cast<VarDecl>(Ref->getDecl());
+    if (!Var)
+      return false;
+    if (Var == Guard)
+      return true;
+    QualType Type = Var->getType();
+    if (Var->hasGlobalStorage())
+      return !Type.isConstQualified() && !Var->isInStdNamespace() &&
+             !SM.isInSystemHeader(Var->getLocation());
+    return (Type->isReferenceType() || Type->isPointerType()) &&
+           SM.isBeforeInTranslationUnit(Var->getLocation(), SectionStart);
+  }
+
+  const FunctionDecl *Callee = nullptr;
+  if (const auto *Call = dyn_cast<CallExpr>(S)) {
+    Callee = Call->getDirectCallee();
+    if (!Callee)
+      return true;
+  } else if (const auto *Construct = dyn_cast<CXXConstructExpr>(S)) {
+    if (!Construct->getConstructor()->isTrivial())
+      Callee = Construct->getConstructor();
+  }
+  if (Callee && !isStdFunction(Callee) && !isSlowFunction(Callee, Context))
+    return true;
+
+  for (const Stmt *Child : S->children())
+    if (Child && accessesGuardedState(Child, Guard, SectionStart, Context))
+      return true;
+  return false;
+}
+
+// Returns the first call to a slow function, stream operation or loop
+// allocating memory in \p S.
+const Stmt *LockInLoopCheck::findExpensiveStmt(const Stmt *S,
+                                               ExpensiveKind &Kind,
+                                               const FunctionDecl *&Callee,
+                                               ASTContext &Context) const {
+  if (isa<LambdaExpr>(S))
+    return nullptr;
+  if (const auto *Call = dyn_cast<CallExpr>(S)) {
+    Callee = Call->getDirectCallee();
+    if (Callee && isSlowFunction(Callee, Context)) {
+      Kind = EK_SlowCall;
+      return Call;
+    }
+    const auto *Operator = dyn_cast<CXXOperatorCallExpr>(Call);
+    if (Operator &&
+        (Operator->getOperator() == OO_LessLess ||
+         Operator->getOperator() == OO_GreaterGreater) &&
+        isStreamClass(Operator->getArg(0)->getType()->getAsCXXRecordDecl())) {
+      Kind = EK_StreamIO;
+      return Call;
+    }
+  }
+  if (isLoop(S) && containsAllocation(S)) {
+    Kind = EK_AllocatingLoop;
+    return S;
+  }
+  for (const Stmt *Child : S->children()) {
+    if (!Child)
+      continue;
+    if (const Stmt *Expensive = findExpensiveStmt(Child, Kind, Callee, Context))
+      return Expensive;
+  }
+  return nullptr;
+}
+
+void LockInLoopCheck::check(const MatchFinder::MatchResult &Result) {
+  const auto *Scope = Result.Nodes.getNodeAs<CompoundStmt>("scope");
+  const auto *LockStmt = Result.Nodes.getNodeAs<Stmt>("lock");
+  const auto *Guard = Result.Nodes.getNodeAs<VarDecl>("guard");
+  ASTContext &Context = *Result.Context;
+  const SourceManager &SM = *Result.SourceManager;
+  if (LockStmt->getLocStart().isMacroID())
+    return;
+
+  const Expr *MutexExpr =
+      Guard ? Result.Nodes.getNodeAs<CXXConstructExpr>("construct")->getArg(0)
+            : cast<CXXMemberCallExpr>(LockStmt)->getImplicitObjectArgument();
+  const ValueDecl *Mutex = getMutexDecl(MutexExpr);
+  if (!Mutex)
+    return;
+
+  // The critical section consists of the statements following the lock in
+  // its scope, up to an explicit unlock.
+  ArrayRef<Stmt *> Body(Scope->body_begin(), Scope->body_end());
+  const auto LockPos = std::find(Body.begin(), Body.end(), LockStmt);
+  if (LockPos == Body.end())
+    return;
+  ArrayRef<Stmt *> Section = Body.drop_front(LockPos - Body.begin() + 1);
+  const Stmt *Unlock = nullptr;
+  for (size_t I = 0; I < Section.size(); ++I) {
+    if (isUnlock(Section[I], Guard, Mutex)) {
+      Unlock = Section[I];
+      Section = Section.take_front(I);
+      break;
+    }
+  }
+  if (!Guard && !Unlock)
+    return;
+
+  SmallVector<bool, 8> Accesses;
+  SmallVector<const Stmt *, 8> Expensive;
+  SmallVector<ExpensiveKind, 8> Kinds;
+  SmallVector<const FunctionDecl *, 8> Callees;
+  for (const Stmt *S : Section) {
+    ExpensiveKind Kind = EK_SlowCall;
+    const FunctionDecl *Callee = nullptr;
+    Accesses.push_back(
+        accessesGuardedState(S, Guard, LockStmt->getLocEnd(), Context));
+    Expensive.push_back(findExpensiveStmt(S, Kind, Callee, Context));
+    Kinds.push_back(Kind);
+    Callees.push_back(Callee);
+  }
+
+  // A lock held for the whole body of a loop without expensive statements:
+  // the loop spends a large part of its time locking and unlocking.
+  ASTContext::DynTypedNodeList Parents = Context.getParents(*Scope);
+  const auto *Loop = Parents.empty() ? nullptr : Parents[0].get<Stmt>();
+  if (Loop && isLoop(Loop) && LockPos == Body.begin() &&
+      (!Unlock || Unlock == Body.back()) &&
+      std::none_of(Expensive.begin(), Expensive.end(),
+                   [](const Stmt *S) { return S != nullptr; }) &&
+      (!Guard || std::none_of(Section.begin(), Section.end(),
+                              [&](const Stmt *S) {
+                                return refersTo(S, Guard);
+                              })) &&
+      isLoopInvariant(MutexExpr, Loop, SM)) {
+    diag(LockStmt->getLocStart(),
+         "mutex %0 is locked and unlocked in each iteration of the loop; "
+         "consider locking it once around the loop")
+        << Mutex;
+    return;
+  }
+
+  // Expensive statements which don't access guarded state can be moved out of
+  // the critical section if they are not preceded or not followed by
+  // statements accessing it.
+  const auto FirstAccess = std::find(Accesses.begin(), Accesses.end(), true);
+  const auto LastAccess =
+      std::find(Accesses.rbegin(), Accesses.rend(), true).base();
+  for (size_t I = 0; I < Section.size(); ++I) {
+    if (!Expensive[I] || Accesses[I])
+      continue;
+    bool ReleaseBefore = Accesses.begin() + I >= LastAccess;
+    if (!ReleaseBefore && Accesses.begin() + I >= FirstAccess)
+      continue;
+    diag(Expensive[I]->getLocStart(),
+         "%select{call to %1|stream I/O|loop allocating memory}0 doesn't "
+         "access state guarded by %2; consider %select{acquiring the lock "
+         "after|releasing the lock before}3 it")
+        << Kinds[I] << Callees[I] << Mutex << ReleaseBefore;
+    diag(LockStmt->getLocStart(), "the critical section spans %0 "
+                                  "statement%s0",
+         DiagnosticIDs::Note)
+        << static_cast<unsigned>(Section.size());
+  }
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
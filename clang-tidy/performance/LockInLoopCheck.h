@@ -0,0 +1,55 @@
+//===--- LockInLoopCheck.h - clang-tidy--------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_LOCK_IN_LOOP_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_LOCK_IN_LOOP_H
+
+#include "../ClangTidy.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds mutexes which are locked and unlocked in each iteration of a tight
+/// loop, and critical sections which contain expensive statements that don't
+/// access the state guarded by the mutex.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-lock-in-loop.html
+class LockInLoopCheck : public ClangTidyCheck {
+public:
+  LockInLoopCheck(StringRef Name, ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  enum ExpensiveKind { EK_SlowCall, EK_StreamIO, EK_AllocatingLoop };
+
+  bool isSlowFunction(const FunctionDecl *Function, ASTContext &Context) const;
+  bool accessesGuardedState(const Stmt *S, const VarDecl *Guard,
+                            SourceLocation SectionStart,
+                            ASTContext &Context) const;
+  const Stmt *findExpensiveStmt(const Stmt *S, ExpensiveKind &Kind,
+                                const FunctionDecl *&Callee,
+                                ASTContext &Context) const;
+
+  const std::vector<std::string> LockTypes;
+  const std::vector<std::string> MutexTypes;
+  const std::vector<std::string> SlowFunctions;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_LOCK_IN_LOOP_H
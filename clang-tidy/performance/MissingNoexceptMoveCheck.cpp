@@ -0,0 +1,330 @@
+//===--- MissingNoexceptMoveCheck.cpp - clang-tidy-------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MissingNoexceptMoveCheck.h"
+#include "../utils/OptionsUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+namespace {
+
+/// One step of the explanation why a constructor is not `noexcept`.
+struct Blame {
+  enum BlameKind {
+    BK_Base,
+    BK_Member,
+    BK_Constructor,
+    BK_NoMoveConstructor
+  } Kind;
+  SourceLocation Loc;
+  // The member, the constructor, or the declaration suppressing the implicit
+  // move constructor.
+  const NamedDecl *D;
+  // The type of the base class or the member.
+  QualType Type;
+  // Whether the move or the copy constructor is blamed.
+  bool Move;
+};
+
+} // namespace
+
+// Returns the copy or move constructor of \p Record, preferring user-declared
+// ones, or null if it hasn't been declared yet.
+static const CXXConstructorDecl *getConstructor(const CXXRecordDecl *Record,
+                                                bool Move) {
+  const CXXConstructorDecl *Result = nullptr;
+  for (const CXXConstructorDecl *Ctor : Record->ctors()) {
+    if (Move ? !Ctor->isMoveConstructor() : !Ctor->isCopyConstructor())
+      continue;
+    if (!Ctor->isImplicit())
+      return Ctor;
+    Result = Ctor;
+  }
+  return Result;
+}
+
+// Returns the user-declared member which prevents the implicit declaration of
+// the move constructor of \p Record, and its kind as selected in the
+// diagnostic.
+static const CXXMethodDecl *getMoveSuppressor(const CXXRecordDecl *Record,
+                                              unsigned &Kind) {
+  if (const CXXConstructorDecl *Copy = getConstructor(Record, false)) {
+    if (!Copy->isImplicit()) {
+      Kind = 0;
+      return Copy;
+    }
+  }
+  for (const CXXMethodDecl *Method : Record->methods()) {
+    if (Method->isImplicit())
+      continue;
+    if (Method->isCopyAssignmentOperator()) {
+      Kind = 1;
+      return Method;
+    }
+    if (Method->isMoveAssignmentOperator()) {
+      Kind = 2;
+      return Method;
+    }
+  }
+  Kind = 3;
+  return Record->getDestructor();
+}
+
+// Returns true if \p Record can be copied.
+static bool isCopyable(const CXXRecordDecl *Record) {
+  if (const CXXConstructorDecl *Copy = getConstructor(Record, false))
+    return !Copy->isDeleted();
+  // A user-declared move operation deletes the implicit copy constructor.
+  if (Record->hasUserDeclaredMoveConstructor() ||
+      Record->hasUserDeclaredMoveAssignment())
+    return false;
+  for (const CXXBaseSpecifier &Base : Record->bases()) {
+    const CXXRecordDecl *BaseRecord = Base.getType()->getAsCXXRecordDecl();
+    if (BaseRecord && BaseRecord->hasDefinition() &&
+        !isCopyable(BaseRecord->getDefinition()))
+      return false;
+  }
+  for (const FieldDecl *Field : Record->fields()) {
+    const CXXRecordDecl *FieldRecord =
+        Field->getType()->getBaseElementTypeUnsafe()->getAsCXXRecordDecl();
+    if (FieldRecord && FieldRecord->hasDefinition() &&
+        !isCopyable(FieldRecord->getDefinition()))
+      return false;
+  }
+  return true;
+}
+
+static bool mayThrowOnConstruction(const CXXRecordDecl *Record, bool Move,
+                                   SmallVectorImpl<Blame> &Chain,
+                                   ASTContext &Context);
+
+// Returns true if copying or moving one of the bases or members of \p Record
+// may throw, and appends the explanation to \p Chain.
+static bool mayThrowOnMemberwiseConstruction(const CXXRecordDecl *Record,
+                                             bool Move,
+                                             SmallVectorImpl<Blame> &Chain,
+                                             ASTContext &Context) {
+  for (const CXXBaseSpecifier &Base : Record->bases()) {
+    const CXXRecordDecl *BaseRecord = Base.getType()->getAsCXXRecordDecl();
+    if (!BaseRecord || !BaseRecord->hasDefinition())
+      continue;
+    Chain.push_back({Blame::BK_Base, Base.getLocStart(), nullptr,
+                     Base.getType(), Move});
+    if (mayThrowOnConstruction(BaseRecord->getDefinition(), Move, Chain,
+                               Context))
+      return true;
+    Chain.pop_back();
+  }
+  for (const FieldDecl *Field : Record->fields()) {
+    const CXXRecordDecl *FieldRecord =
+        Field->getType()->getBaseElementTypeUnsafe()->getAsCXXRecordDecl();
+    if (!FieldRecord || !FieldRecord->hasDefinition())
+      continue;
+    Chain.push_back({Blame::BK_Member, Field->getLocation(), Field,
+                     Field->getType(), Move});
+    if (mayThrowOnConstruction(FieldRecord->getDefinition(), Move, Chain,
+                               Context))
+      return true;
+    Chain.pop_back();
+  }
+  return false;
+}
+
+// Returns true if the constructor used to move (or copy, if \p Move is false)
+// \p Record isn't `noexcept`, and appends the explanation to \p Chain.
+static bool mayThrowOnConstruction(const CXXRecordDecl *Record, bool Move,
+                                   SmallVectorImpl<Blame> &Chain,
+                                   ASTContext &Context) {
+  const CXXConstructorDecl *Ctor = getConstructor(Record, Move);
+  if (Move && !Ctor && !Record->needsImplicitMoveConstructor()) {
+    // Moving the object calls its copy constructor instead.
+    unsigned Kind = 0;
+    const CXXMethodDecl *Suppressor = getMoveSuppressor(Record, Kind);
+    if (!Suppressor)
+      return false;
+    Chain.push_back({Blame::BK_NoMoveConstructor, Suppressor->getLocation(),
+                     Suppressor, QualType(), Move});
+    if (mayThrowOnConstruction(Record, false, Chain, Context))
+      return true;
+    Chain.pop_back();
+    return false;
+  }
+
+  if (Ctor && Ctor->isDeleted()) {
+    // A deleted move constructor is still selected, so that the container has
+    // to fall back to copying.
+    if (!Move || Ctor->isImplicit())
+      return false;
+    Chain.push_back({Blame::BK_Constructor, Ctor->getLocation(), Ctor,
+                     QualType(), Move});
+    return true;
+  }
+  if (Ctor && Ctor->isUserProvided()) {
+    const auto *Proto = Ctor->getType()->getAs<FunctionProtoType>();
+    if (isUnresolvedExceptionSpec(Proto->getExceptionSpecType()))
+      return false;
+    FunctionProtoType::NoexceptResult Spec = Proto->getNoexceptSpec(Context);
+    if (Spec != FunctionProtoType::NR_NoNoexcept &&
+        Spec != FunctionProtoType::NR_Throw)
+      return false;
+    Chain.push_back({Blame::BK_Constructor, Ctor->getLocation(), Ctor,
+                     QualType(), Move});
+    return true;
+  }
+
+  // The constructor is implicit or defaulted, which makes it `noexcept` unless
+  // the constructor of a base or a member isn't.
+  if (Move ? Record->hasTrivialMoveConstructor()
+           : Record->hasTrivialCopyConstructor())
+    return false;
+  return mayThrowOnMemberwiseConstruction(Record, Move, Chain, Context);
+}
+
+// Returns the number of user-provided copy constructors called when copying
+// \p Record.
+static unsigned countCopyConstructorCalls(const CXXRecordDecl *Record,
+                                          ASTContext &Context) {
+  const CXXConstructorDecl *Copy = getConstructor(Record, false);
+  if (Copy && Copy->isUserProvided())
+    return 1;
+  unsigned Count = 0;
+  for (const CXXBaseSpecifier &Base : Record->bases())
+    if (const CXXRecordDecl *BaseRecord = Base.getType()->getAsCXXRecordDecl())
+      if (BaseRecord->hasDefinition())
+        Count += countCopyConstructorCalls(BaseRecord->getDefinition(),
+                                           Context);
+  for (const FieldDecl *Field : Record->fields()) {
+    QualType Type = Field->getType();
+    uint64_t Elements = 1;
+    while (const ConstantArrayType *Array =
+               Context.getAsConstantArrayType(Type)) {
+      Elements *= Array->getSize().getZExtValue();
+      Type = Array->getElementType();
+    }
+    const CXXRecordDecl *FieldRecord = Type->getAsCXXRecordDecl();
+    if (FieldRecord && FieldRecord->hasDefinition())
+      Count += Elements * countCopyConstructorCalls(
+                              FieldRecord->getDefinition(), Context);
+  }
+  return Count;
+}
+
+MissingNoexceptMoveCheck::MissingNoexceptMoveCheck(StringRef Name,
+                                                   ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      ContainerTypes(utils::options::parseStringList(
+          Options.get("ContainerTypes", "::std::vector;::std::deque"))) {}
+
+void MissingNoexceptMoveCheck::storeOptions(ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "ContainerTypes",
+                utils::options::serializeStringList(ContainerTypes));
+}
+
+void MissingNoexceptMoveCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11 || ContainerTypes.empty())
+    return;
+
+  Finder->addMatcher(
+      classTemplateSpecializationDecl(
+          hasAnyName(SmallVector<StringRef, 4>(ContainerTypes.begin(),
+                                               ContainerTypes.end())),
+          hasTemplateArgument(
+              0, refersToType(hasUnqualifiedDesugaredType(recordType(
+                     hasDeclaration(cxxRecordDecl().bind("element")))))))
+          .bind("container"),
+      this);
+}
+
+void MissingNoexceptMoveCheck::check(const MatchFinder::MatchResult &Result) {
+  const auto *Container =
+      Result.Nodes.getNodeAs<ClassTemplateSpecializationDecl>("container");
+  const auto *Element = Result.Nodes.getNodeAs<CXXRecordDecl>("element");
+  ASTContext &Context = *Result.Context;
+  const SourceManager &SM = *Result.SourceManager;
+
+  // Only containers which are instantiated by the user's code store elements.
+  SourceLocation Use = Container->getPointOfInstantiation();
+  if (Use.isInvalid() || SM.isInSystemHeader(SM.getExpansionLoc(Use)))
+    return;
+  if (!Element->hasDefinition())
+    return;
+  Element = Element->getDefinition();
+  if (Element->isDependentContext() ||
+      SM.isInSystemHeader(SM.getExpansionLoc(Element->getLocation())) ||
+      !Reported.insert(Element->getCanonicalDecl()).second)
+    return;
+
+  // Move-only types are moved regardless of whether that may throw.
+  if (!isCopyable(Element))
+    return;
+  SmallVector<Blame, 4> Chain;
+  if (!mayThrowOnConstruction(Element, /*Move=*/true, Chain, Context))
+    return;
+
+  // A deque never relocates its elements when it grows, only when it shrinks
+  // to fit.
+  const bool IsDeque = Container->getQualifiedNameAsString() == "std::deque";
+  diag(Element->getLocation(),
+       "%0 has no noexcept move constructor, so %1 copies its elements "
+       "%select{when it grows|in 'shrink_to_fit'}4 (%2 bytes and %3 "
+       "user-provided copy constructor call%s3 per element)")
+      << Element << Container->getSpecializedTemplate()
+      << static_cast<unsigned>(
+             Context.getTypeSizeInChars(Context.getRecordType(Element))
+                 .getQuantity())
+      << countCopyConstructorCalls(Element, Context) << IsDeque;
+  diag(Use, "%0 is used as an element type of %1 here", DiagnosticIDs::Note)
+      << Element << Container->getSpecializedTemplate();
+  for (const Blame &B : Chain) {
+    switch (B.Kind) {
+    case Blame::BK_Base:
+      diag(B.Loc, "base class %0 has no noexcept %select{copy|move}1 "
+                  "constructor",
+           DiagnosticIDs::Note)
+          << B.Type << B.Move;
+      break;
+    case Blame::BK_Member:
+      diag(B.Loc, "member %0 of type %1 has no noexcept %select{copy|move}2 "
+                  "constructor",
+           DiagnosticIDs::Note)
+          << B.D << B.Type << B.Move;
+      break;
+    case Blame::BK_Constructor:
+      diag(B.Loc, "%select{copy|move}0 constructor of %1 is %select{not "
+                  "noexcept|deleted}2",
+           DiagnosticIDs::Note)
+          << B.Move << cast<CXXMethodDecl>(B.D)->getParent()
+          << cast<CXXMethodDecl>(B.D)->isDeleted();
+      break;
+    case Blame::BK_NoMoveConstructor: {
+      unsigned Kind = 0;
+      const CXXRecordDecl *Record = cast<CXXMethodDecl>(B.D)->getParent();
+      getMoveSuppressor(Record, Kind);
+      diag(B.Loc, "%0 has no move constructor because of this user-declared "
+                  "%select{copy constructor|copy assignment operator|move "
+                  "assignment operator|destructor}1, so it is copied instead",
+           DiagnosticIDs::Note)
+          << Record << Kind;
+      break;
+    }
+    }
+  }
+}
+
+void MissingNoexceptMoveCheck::onEndOfTranslationUnit() { Reported.clear(); }
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
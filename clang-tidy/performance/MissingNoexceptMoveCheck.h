@@ -0,0 +1,47 @@
+//===--- MissingNoexceptMoveCheck.h - clang-tidy-----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_MISSING_NOEXCEPT_MOVE_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_MISSING_NOEXCEPT_MOVE_H
+
+#include "../ClangTidy.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds element types of containers like `std::vector` whose move
+/// constructor, whether user-declared or implicit, is not `noexcept`, so that
+/// the container copies the elements when it grows, and points to the member,
+/// base class or declaration responsible for it.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-missing-noexcept-move.html
+class MissingNoexceptMoveCheck : public ClangTidyCheck {
+public:
+  MissingNoexceptMoveCheck(StringRef Name, ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void onEndOfTranslationUnit() override;
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  const std::vector<std::string> ContainerTypes;
+  // Element types which have been reported already.
+  llvm::SmallPtrSet<const CXXRecordDecl *, 8> Reported;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_MISSING_NOEXCEPT_MOVE_H
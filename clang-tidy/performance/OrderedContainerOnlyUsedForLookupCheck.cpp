@@ -0,0 +1,498 @@
+//===--- OrderedContainerOnlyUsedForLookupCheck.cpp - clang-tidy-----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OrderedContainerOnlyUsedForLookupCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/DeclRefExprUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/StringSwitch.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+// Returns the parent of \p E after skipping parentheses, implicit conversions
+// and copies, and updates \p E to the outermost skipped expression.
+static const Stmt *getUser(const Expr *&E, ASTContext &Context) {
+  const Stmt *Parent = utils::getParentStmt(E, Context);
+  while (Parent) {
+    const auto *Construct = dyn_cast<CXXConstructExpr>(Parent);
+    if (!isa<ParenExpr>(Parent) && !isa<ImplicitCastExpr>(Parent) &&
+        !isa<MaterializeTemporaryExpr>(Parent) &&
+        !isa<CXXBindTemporaryExpr>(Parent) &&
+        !(Construct && !isa<CXXTemporaryObjectExpr>(Construct) &&
+          Construct->getNumArgs() == 1))
+      break;
+    E = cast<Expr>(Parent);
+    Parent = utils::getParentStmt(E, Context);
+  }
+  return Parent;
+}
+
+// Returns the variable initialized by \p E, if any.
+static const VarDecl *getInitializedVar(const Expr *E, ASTContext &Context) {
+  while (true) {
+    ASTContext::DynTypedNodeList Parents = Context.getParents(*E);
+    if (Parents.empty())
+      return nullptr;
+    if (const auto *Var = Parents[0].get<VarDecl>())
+      return Var;
+    const auto *Parent = Parents[0].get<Expr>();
+    if (!Parent)
+      return nullptr;
+    const auto *Construct = dyn_cast<CXXConstructExpr>(Parent);
+    if (!isa<ImplicitCastExpr>(Parent) &&
+        !isa<MaterializeTemporaryExpr>(Parent) &&
+        !isa<CXXBindTemporaryExpr>(Parent) && !isa<ExprWithCleanups>(Parent) &&
+        !(Construct && !isa<CXXTemporaryObjectExpr>(Construct) &&
+          Construct->getNumArgs() == 1))
+      return nullptr;
+    E = Parent;
+  }
+}
+
+// Returns true if \p E is assigned to an existing variable.
+static bool isAssigned(const Expr *E, ASTContext &Context) {
+  const Stmt *Parent = getUser(E, Context);
+  if (const auto *Op = dyn_cast_or_null<CXXOperatorCallExpr>(Parent))
+    return Op->getOperator() == OO_Equal;
+  if (const auto *Op = dyn_cast_or_null<BinaryOperator>(Parent))
+    return Op->isAssignmentOp();
+  return false;
+}
+
+// Returns true if \p E is compared for (in)equality.
+static bool isCompared(const Expr *E, ASTContext &Context) {
+  const Stmt *Parent = getUser(E, Context);
+  if (const auto *Op = dyn_cast_or_null<CXXOperatorCallExpr>(Parent))
+    return Op->getOperator() == OO_EqualEqual ||
+           Op->getOperator() == OO_ExclaimEqual;
+  if (const auto *Op = dyn_cast_or_null<BinaryOperator>(Parent))
+    return Op->isEqualityOp();
+  return false;
+}
+
+// Returns true if the iterator referenced by \p E is moved to a neighbouring
+// element, which depends on the ordering of the container.
+static bool isAdvanced(const Expr *E, ASTContext &Context) {
+  const Stmt *Parent = getUser(E, Context);
+  // Look through the iterator member of the result of insert().
+  if (const auto *Member = dyn_cast_or_null<MemberExpr>(Parent)) {
+    if (!Member->getMemberDecl()->getDeclName().isIdentifier() ||
+        Member->getMemberDecl()->getName() != "first")
+      return false;
+    E = Member;
+    Parent = getUser(E, Context);
+  }
+  if (!Parent)
+    return false;
+  if (const auto *Op = dyn_cast<UnaryOperator>(Parent))
+    return Op->isIncrementDecrementOp();
+  if (const auto *Op = dyn_cast<CXXOperatorCallExpr>(Parent))
+    return Op->getOperator() == OO_PlusPlus ||
+           Op->getOperator() == OO_MinusMinus;
+  if (const auto *Call = dyn_cast<CallExpr>(Parent)) {
+    const auto *Callee = Call->getDirectCallee();
+    if (!Callee || !Callee->getDeclName().isIdentifier())
+      return false;
+    return llvm::StringSwitch<bool>(Callee->getName())
+        .Cases("next", "prev", "advance", "distance", true)
+        .Default(false);
+  }
+  return false;
+}
+
+static bool isWithin(SourceLocation Loc, const Stmt *S,
+                     const SourceManager &SM) {
+  return !SM.isBeforeInTranslationUnit(Loc, S->getLocStart()) &&
+         !SM.isBeforeInTranslationUnit(S->getLocEnd(), Loc);
+}
+
+// Returns true if the iterator stored in \p Iterator may be used after
+// \p Insertion, in the same function \p Function.
+static bool isUsedAfter(const VarDecl *Iterator, const Expr *Insertion,
+                        const FunctionDecl &Function, ASTContext &Context) {
+  const SourceManager &SM = Context.getSourceManager();
+  if (!SM.isBeforeInTranslationUnit(Iterator->getInit()->getLocEnd(),
+                                    Insertion->getLocStart()))
+    return false;
+  // Uses before the insertion in a loop around it which doesn't declare the
+  // iterator are evaluated after it in the next iteration.
+  const Stmt *Loop = utils::getRepeatingLoop(Insertion, Context);
+  if (Loop && isWithin(Iterator->getLocation(), Loop, SM))
+    Loop = nullptr;
+  for (const DeclRefExpr *Ref :
+       utils::decl_ref_expr::allDeclRefExprs(*Iterator, Function, Context))
+    if (SM.isBeforeInTranslationUnit(Insertion->getLocEnd(),
+                                     Ref->getLocStart()) ||
+        (Loop && isWithin(Ref->getLocStart(), Loop, SM)))
+      return true;
+  return false;
+}
+
+// Returns true if the constructor arguments of the container don't depend on
+// its type: no arguments, an initializer list or an iterator range.
+static bool isPortableInitializer(const Expr *Init) {
+  if (!Init)
+    return true;
+  const auto *Construct = dyn_cast<CXXConstructExpr>(Init->IgnoreImplicit());
+  if (!Construct)
+    return false;
+  unsigned NumArgs = 0;
+  for (const Expr *Arg : Construct->arguments()) {
+    if (!isa<CXXDefaultArgExpr>(Arg))
+      ++NumArgs;
+  }
+  if (NumArgs == 0)
+    return true;
+  if (NumArgs == 1)
+    return isa<CXXStdInitializerListExpr>(
+        Construct->getArg(0)->IgnoreImplicit());
+  return NumArgs == 2 && Construct->getConstructor()->getPrimaryTemplate();
+}
+
+// Returns true if all code which can access the private fields of \p Record
+// is defined in this translation unit.
+static bool isFullyDefined(const CXXRecordDecl *Record) {
+  if (Record->friend_begin() != Record->friend_end())
+    return false;
+  for (const Decl *D : Record->decls()) {
+    if (const auto *Nested = dyn_cast<CXXRecordDecl>(D)) {
+      if (!Nested->isImplicit() && Nested->hasDefinition() &&
+          !isFullyDefined(Nested->getDefinition()))
+        return false;
+    } else if (isa<FunctionTemplateDecl>(D)) {
+      return false;
+    } else if (const auto *Method = dyn_cast<CXXMethodDecl>(D)) {
+      if (!Method->isImplicit() && !Method->isDeleted() &&
+          !Method->isDefaulted() && !Method->isPure() && !Method->hasBody())
+        return false;
+    }
+  }
+  return true;
+}
+
+// Returns the type template argument \p Index of \p Specialization.
+static QualType
+getTypeArg(const ClassTemplateSpecializationDecl *Specialization,
+           unsigned Index) {
+  const TemplateArgumentList &Args = Specialization->getTemplateArgs();
+  if (Args.size() <= Index || Args[Index].getKind() != TemplateArgument::Type)
+    return QualType();
+  return Args[Index].getAsType().getCanonicalType();
+}
+
+// Returns \p Type if it is a specialization of the class template \p Name.
+static const ClassTemplateSpecializationDecl *
+getSpecialization(QualType Type, StringRef Name) {
+  if (Type.isNull())
+    return nullptr;
+  const auto *Specialization =
+      dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+          Type->getAsCXXRecordDecl());
+  return Specialization && Specialization->getQualifiedNameAsString() == Name
+             ? Specialization
+             : nullptr;
+}
+
+OrderedContainerOnlyUsedForLookupCheck::OrderedContainerOnlyUsedForLookupCheck(
+    StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      IncludeStyle(utils::IncludeSorter::parseIncludeStyle(
+          Options.get("IncludeStyle", "llvm"))) {}
+
+void OrderedContainerOnlyUsedForLookupCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "IncludeStyle",
+                utils::IncludeSorter::toString(IncludeStyle));
+}
+
+void OrderedContainerOnlyUsedForLookupCheck::registerMatchers(
+    MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  const auto OrderedType = qualType(hasUnqualifiedDesugaredType(
+      recordType(hasDeclaration(classTemplateSpecializationDecl(
+          hasAnyName("::std::map", "::std::set"))))));
+  const auto LocalContainer =
+      varDecl(hasType(OrderedType), anyOf(hasLocalStorage(), isStaticLocal()),
+              unless(parmVarDecl()));
+  const auto PrivateContainer = fieldDecl(hasType(OrderedType), isPrivate());
+
+  Finder->addMatcher(
+      decl(anyOf(LocalContainer, PrivateContainer),
+           unless(isInTemplateInstantiation()),
+           unless(isExpansionInSystemHeader()))
+          .bind("container"),
+      this);
+  Finder->addMatcher(declRefExpr(to(LocalContainer),
+                                 unless(isInTemplateInstantiation()))
+                         .bind("ref"),
+                     this);
+  Finder->addMatcher(memberExpr(member(PrivateContainer),
+                                unless(isInTemplateInstantiation()))
+                         .bind("ref"),
+                     this);
+  Finder->addMatcher(
+      classTemplateSpecializationDecl(hasName("::std::hash")).bind("hash"),
+      this);
+}
+
+void OrderedContainerOnlyUsedForLookupCheck::check(
+    const MatchFinder::MatchResult &Result) {
+  SM = Result.SourceManager;
+  if (const auto *Hash =
+          Result.Nodes.getNodeAs<ClassTemplateSpecializationDecl>("hash")) {
+    if (Hash->isExplicitSpecialization()) {
+      QualType Key = getTypeArg(Hash, 0);
+      if (!Key.isNull())
+        HashedTypes.insert(Key.getTypePtr());
+    }
+    return;
+  }
+
+  if (const auto *Container =
+          Result.Nodes.getNodeAs<DeclaratorDecl>("container")) {
+    ContainerUses &Uses = Containers[Container];
+    if (Container->getDeclContext()->isDependentContext())
+      Uses.OnlyLookups = false;
+    if (const auto *Var = dyn_cast<VarDecl>(Container)) {
+      if (!isPortableInitializer(Var->getInit()))
+        Uses.OnlyLookups = false;
+    } else {
+      const auto *Field = cast<FieldDecl>(Container);
+      if (!isPortableInitializer(Field->getInClassInitializer()))
+        Uses.OnlyLookups = false;
+      const auto *Record = cast<CXXRecordDecl>(Field->getParent());
+      for (const CXXConstructorDecl *Ctor : Record->ctors()) {
+        const FunctionDecl *Definition = nullptr;
+        if (!Ctor->hasBody(Definition))
+          continue;
+        for (const CXXCtorInitializer *Init :
+             cast<CXXConstructorDecl>(Definition)->inits()) {
+          if (Init->isWritten() && Init->getMember() == Field &&
+              !isPortableInitializer(Init->getInit()))
+            Uses.OnlyLookups = false;
+        }
+      }
+    }
+    return;
+  }
+
+  const auto *Ref = Result.Nodes.getNodeAs<Expr>("ref");
+  const DeclaratorDecl *Container = nullptr;
+  if (const auto *DeclRef = dyn_cast<DeclRefExpr>(Ref))
+    Container = cast<DeclaratorDecl>(DeclRef->getDecl());
+  else
+    Container = cast<DeclaratorDecl>(cast<MemberExpr>(Ref)->getMemberDecl());
+  ContainerUses &Uses = Containers[Container];
+  if (Uses.OnlyLookups)
+    checkUse(Ref, Uses, *Result.Context);
+}
+
+void OrderedContainerOnlyUsedForLookupCheck::checkUse(const Expr *Ref,
+                                                      ContainerUses &Uses,
+                                                      ASTContext &Context) {
+  const Expr *E = Ref;
+  const Stmt *Parent = getUser(E, Context);
+
+  if (const auto *Op = dyn_cast_or_null<CXXOperatorCallExpr>(Parent)) {
+    if (Op->getOperator() != OO_Subscript || Op->getArg(0) != E)
+      Uses.OnlyLookups = false;
+    else
+      addInsertion(Op, Uses, Context);
+    return;
+  }
+
+  // Anything but a member call, e.g. iterating over the container, passing
+  // it to a function or copying it, may depend on the ordering or on the
+  // type of the container.
+  const auto *Member = dyn_cast_or_null<MemberExpr>(Parent);
+  const auto *Call = Member ? dyn_cast_or_null<CXXMemberCallExpr>(
+                                  utils::getParentStmt(Member, Context))
+                            : nullptr;
+  if (!Call || Member->getBase() != E) {
+    Uses.OnlyLookups = false;
+    return;
+  }
+  const CXXMethodDecl *Method = Call->getMethodDecl();
+  if (!Method || !Method->getDeclName().isIdentifier()) {
+    Uses.OnlyLookups = false;
+    return;
+  }
+  StringRef Name = Method->getName();
+
+  // end() may only be used to check the result of a lookup.
+  if (Name == "end" || Name == "cend") {
+    if (!isCompared(Call, Context))
+      Uses.OnlyLookups = false;
+    return;
+  }
+
+  const bool IsInsertion =
+      llvm::StringSwitch<bool>(Name)
+          .Cases("insert", "emplace", "emplace_hint", "try_emplace",
+                 "insert_or_assign", true)
+          .Default(false);
+  const bool IsLookup =
+      IsInsertion || llvm::StringSwitch<bool>(Name)
+                         .Cases("find", "count", "at", "contains", true)
+                         .Cases("erase", "clear", "size", "empty", "max_size",
+                                true)
+                         .Default(false);
+  if (!IsLookup) {
+    Uses.OnlyLookups = false;
+    return;
+  }
+  if (IsInsertion) {
+    addInsertion(Call, Uses, Context);
+    if (!Uses.OnlyLookups)
+      return;
+  }
+
+  // Iterators returned by lookups may be dereferenced and compared, but not
+  // advanced to the neighbouring elements.
+  if (isAssigned(Call, Context)) {
+    Uses.OnlyLookups = false;
+    return;
+  }
+  const VarDecl *Iterator = getInitializedVar(Call, Context);
+  if (!Iterator)
+    return;
+  if (!Iterator->getType()->getContainedAutoType())
+    Uses.CanChangeType = false;
+  const FunctionDecl *Function = utils::getSurroundingFunction(Context, *Call);
+  if (!Function)
+    return;
+  for (const DeclRefExpr *IteratorRef :
+       utils::decl_ref_expr::allDeclRefExprs(*Iterator, *Function, Context)) {
+    if (isAdvanced(IteratorRef, Context)) {
+      Uses.OnlyLookups = false;
+      return;
+    }
+  }
+  addIterator(Iterator, Function, Uses, Context);
+}
+
+// Inserting into an unordered container may rehash it, which invalidates all
+// of its iterators. Iterators used after an insertion therefore depend on the
+// stability of the ordered container.
+void OrderedContainerOnlyUsedForLookupCheck::addInsertion(
+    const Expr *Insertion, ContainerUses &Uses, ASTContext &Context) {
+  const FunctionDecl *Function =
+      utils::getSurroundingFunction(Context, *Insertion);
+  if (!Function)
+    return;
+  for (const auto &Iterator : Uses.Iterators) {
+    if (Iterator.second == Function &&
+        isUsedAfter(Iterator.first, Insertion, *Function, Context)) {
+      Uses.OnlyLookups = false;
+      return;
+    }
+  }
+  Uses.Insertions.emplace_back(Insertion, Function);
+}
+
+void OrderedContainerOnlyUsedForLookupCheck::addIterator(
+    const VarDecl *Iterator, const FunctionDecl *Function, ContainerUses &Uses,
+    ASTContext &Context) {
+  for (const auto &Insertion : Uses.Insertions) {
+    if (Insertion.second == Function &&
+        isUsedAfter(Iterator, Insertion.first, *Function, Context)) {
+      Uses.OnlyLookups = false;
+      return;
+    }
+  }
+  Uses.Iterators.emplace_back(Iterator, Function);
+}
+
+void OrderedContainerOnlyUsedForLookupCheck::onEndOfTranslationUnit() {
+  for (const auto &Entry : Containers) {
+    const DeclaratorDecl *Container = Entry.first;
+    if (!Entry.second.OnlyLookups || Container->getLocation().isMacroID() ||
+        SM->isInSystemHeader(Container->getLocation()) ||
+        !Container->getTypeSourceInfo())
+      continue;
+    if (const auto *Field = dyn_cast<FieldDecl>(Container)) {
+      const auto *Record = cast<CXXRecordDecl>(Field->getParent());
+      if (Record->getDescribedClassTemplate() ||
+          isa<ClassTemplateSpecializationDecl>(Record) ||
+          !isFullyDefined(Record))
+        continue;
+    }
+
+    const auto *Specialization = cast<ClassTemplateSpecializationDecl>(
+        Container->getType()->getAsCXXRecordDecl());
+    const bool IsMap = Specialization->getName() == "map";
+    const unsigned NumArgs = IsMap ? 2 : 1;
+    // Custom comparators and allocators are deliberate choices, and have no
+    // direct unordered equivalent.
+    QualType Key = getTypeArg(Specialization, 0);
+    const auto *Less =
+        getSpecialization(getTypeArg(Specialization, NumArgs), "std::less");
+    if (Key.isNull() || !Less || getTypeArg(Less, 0) != Key ||
+        !getSpecialization(getTypeArg(Specialization, NumArgs + 1),
+                           "std::allocator"))
+      continue;
+
+    const StringRef Replacement = IsMap ? "unordered_map" : "unordered_set";
+    auto Diag = diag(Container->getLocation(),
+                     "%0 is only used for lookups which don't depend on the "
+                     "ordering of its elements; consider using 'std::%1'")
+                << Container << Replacement;
+
+    const bool IsHashable = Key->isArithmeticType() ||
+                            Key->isEnumeralType() || Key->isAnyPointerType() ||
+                            Key->isNullPtrType() ||
+                            HashedTypes.count(Key.getTypePtr());
+    if (!IsHashable || !Entry.second.CanChangeType)
+      continue;
+
+    // Replace the template name of `std::map<Key, Value>`, unless the type is
+    // spelled through an alias or names the comparator, which would become
+    // the hash function of the unordered container.
+    TypeLoc Loc =
+        Container->getTypeSourceInfo()->getTypeLoc().getUnqualifiedLoc();
+    if (auto Elaborated = Loc.getAs<ElaboratedTypeLoc>())
+      Loc = Elaborated.getNamedTypeLoc();
+    auto TemplateLoc = Loc.getAs<TemplateSpecializationTypeLoc>();
+    if (!TemplateLoc || TemplateLoc.getNumArgs() != NumArgs)
+      continue;
+    SourceLocation NameLoc = TemplateLoc.getTemplateNameLoc();
+    const StringRef Original = IsMap ? "map" : "set";
+    if (NameLoc.isMacroID() ||
+        StringRef(SM->getCharacterData(NameLoc), Original.size()) != Original)
+      continue;
+    Diag << FixItHint::CreateReplacement(
+        SourceRange(NameLoc, NameLoc.getLocWithOffset(Original.size() - 1)),
+        Replacement);
+    if (auto IncludeFixit = Inserter->CreateIncludeInsertion(
+            SM->getFileID(NameLoc), Replacement, /*IsAngled=*/true))
+      Diag << *IncludeFixit;
+  }
+  Containers.clear();
+  HashedTypes.clear();
+}
+
+void OrderedContainerOnlyUsedForLookupCheck::registerPPCallbacks(
+    CompilerInstance &Compiler) {
+  Inserter.reset(new utils::IncludeInserter(
+      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
+  Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
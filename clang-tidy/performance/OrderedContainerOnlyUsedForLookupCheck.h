@@ -0,0 +1,69 @@
+//===--- OrderedContainerOnlyUsedForLookupCheck.h - clang-tidy---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_ORDERED_CONTAINER_ONLY_USED_FOR_LOOKUP_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_ORDERED_CONTAINER_ONLY_USED_FOR_LOOKUP_H
+
+#include "../ClangTidy.h"
+#include "../utils/IncludeInserter.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds local variables and private fields of type `std::map` or `std::set`
+/// which are only used for insertions, lookups and removals, and suggests the
+/// unordered equivalent.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-ordered-container-only-used-for-lookup.html
+class OrderedContainerOnlyUsedForLookupCheck : public ClangTidyCheck {
+public:
+  OrderedContainerOnlyUsedForLookupCheck(StringRef Name,
+                                         ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void onEndOfTranslationUnit() override;
+  void registerPPCallbacks(CompilerInstance &Compiler) override;
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  struct ContainerUses {
+    // Whether all uses seen so far are independent of the ordering of the
+    // elements.
+    bool OnlyLookups = true;
+    // Whether changing the type of the declaration keeps the code valid.
+    bool CanChangeType = true;
+    // Variables holding iterators returned by lookups, and insertions, with
+    // the functions they are in.
+    SmallVector<std::pair<const VarDecl *, const FunctionDecl *>, 4> Iterators;
+    SmallVector<std::pair<const Expr *, const FunctionDecl *>, 4> Insertions;
+  };
+
+  void checkUse(const Expr *Ref, ContainerUses &Uses, ASTContext &Context);
+  void addInsertion(const Expr *Insertion, ContainerUses &Uses,
+                    ASTContext &Context);
+  void addIterator(const VarDecl *Iterator, const FunctionDecl *Function,
+                   ContainerUses &Uses, ASTContext &Context);
+
+  llvm::MapVector<const DeclaratorDecl *, ContainerUses> Containers;
+  // Canonical key types for which `std::hash` is explicitly specialized.
+  llvm::SmallPtrSet<const Type *, 8> HashedTypes;
+  SourceManager *SM = nullptr;
+  std::unique_ptr<utils::IncludeInserter> Inserter;
+  const utils::IncludeSorter::IncludeStyle IncludeStyle;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_ORDERED_CONTAINER_ONLY_USED_FOR_LOOKUP_H
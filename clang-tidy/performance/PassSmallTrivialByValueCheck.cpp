@@ -0,0 +1,180 @@
+//===--- PassSmallTrivialByValueCheck.cpp - clang-tidy---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassSmallTrivialByValueCheck.h"
+
+#include "../utils/DeclRefExprUtils.h"
+#include "../utils/FixItHintUtils.h"
+#include "../utils/TypeTraits.h"
+#include "clang/AST/ASTContext.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+namespace {
+
+// Returns true if \p Arg is passed to a reference parameter of \p Callee. The
+// first \p FirstParamArg arguments aren't passed to parameters, e.g. the
+// object argument of a member operator call.
+bool isPassedToReferenceParam(const FunctionDecl *Callee,
+                              ArrayRef<const Expr *> Args, const Stmt *Arg,
+                              unsigned FirstParamArg) {
+  for (unsigned I = FirstParamArg, E = Args.size(); I != E; ++I) {
+    if (Args[I] != Arg)
+      continue;
+    if (!Callee)
+      return true;
+    // Arguments matching the ellipsis are copied.
+    return I - FirstParamArg < Callee->getNumParams() &&
+           Callee->getParamDecl(I - FirstParamArg)
+               ->getType()
+               ->isReferenceType();
+  }
+  return false;
+}
+
+bool isInCtorInitializer(ast_type_traits::DynTypedNode Node,
+                         ASTContext &Context) {
+  while (true) {
+    ASTContext::DynTypedNodeList Parents = Context.getParents(Node);
+    if (Parents.empty() || Parents[0].get<Decl>())
+      return false;
+    if (Parents[0].get<CXXCtorInitializer>())
+      return true;
+    Node = Parents[0];
+  }
+}
+
+// Returns true if the parameter referenced by \p Ref may be bound to a
+// reference or pointer there, which would dangle or observe a different
+// object once the parameter is a copy.
+bool mayBindReference(const DeclRefExpr &Ref, ASTContext &Context) {
+  if (Ref.refersToEnclosingVariableOrCapture())
+    return true;
+  ast_type_traits::DynTypedNode Node =
+      ast_type_traits::DynTypedNode::create(Ref);
+  const Stmt *Child = &Ref;
+  while (true) {
+    ASTContext::DynTypedNodeList Parents = Context.getParents(Node);
+    if (Parents.empty())
+      return false;
+    const ast_type_traits::DynTypedNode &Parent = Parents[0];
+    if (const auto *Var = Parent.get<VarDecl>())
+      return Var->getType()->isReferenceType();
+    if (const auto *Init = Parent.get<CXXCtorInitializer>())
+      return !Init->getMember() ||
+             Init->getMember()->getType()->isReferenceType();
+    const auto *S = Parent.get<Stmt>();
+    if (!S)
+      return true;
+    if (const auto *Unary = dyn_cast<UnaryOperator>(S))
+      return Unary->getOpcode() == UO_AddrOf;
+    // A constructed object may keep a reference to its arguments, e.g. a view
+    // stored in a member.
+    if (const auto *Construct = dyn_cast<CXXConstructExpr>(S))
+      return isPassedToReferenceParam(
+          Construct->getConstructor(),
+          llvm::makeArrayRef(Construct->getArgs(), Construct->getNumArgs()),
+          Child, 0);
+    // So may the result of a call initializing a member, e.g. a view created
+    // by a factory function.
+    if (const auto *Call = dyn_cast<CallExpr>(S)) {
+      const FunctionDecl *Callee = Call->getDirectCallee();
+      bool IsMemberOperator = isa<CXXOperatorCallExpr>(Call) && Callee &&
+                              isa<CXXMethodDecl>(Callee);
+      return isInCtorInitializer(Parent, Context) &&
+             isPassedToReferenceParam(
+                 Callee,
+                 llvm::makeArrayRef(Call->getArgs(), Call->getNumArgs()),
+                 Child, IsMemberOperator ? 1 : 0);
+    }
+    const auto *Cast = dyn_cast<ImplicitCastExpr>(S);
+    const auto *Member = dyn_cast<MemberExpr>(S);
+    // Look through parentheses, const qualification and member accesses.
+    if (!isa<ParenExpr>(S) && !(Cast && Cast->getCastKind() == CK_NoOp) &&
+        !(Member && !Member->isArrow()))
+      return false;
+    Node = Parent;
+    Child = S;
+  }
+}
+
+} // namespace
+
+PassSmallTrivialByValueCheck::PassSmallTrivialByValueCheck(
+    StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context), MaxSize(Options.get("MaxSize", 16U)) {}
+
+void PassSmallTrivialByValueCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "MaxSize", MaxSize);
+}
+
+void PassSmallTrivialByValueCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus)
+    return;
+
+  const auto ConstRefParamDecl =
+      parmVarDecl(hasType(lValueReferenceType()), decl().bind("param"));
+  // Functions returning references or pointers may return a reference to the
+  // parameter, and copy operations need their reference parameters.
+  Finder->addMatcher(
+      functionDecl(
+          hasBody(stmt()), isDefinition(), unless(isImplicit()),
+          unless(returns(qualType(anyOf(referenceType(), pointerType())))),
+          unless(cxxMethodDecl(anyOf(isOverride(), isFinal(),
+                                     isCopyAssignmentOperator()))),
+          unless(cxxConstructorDecl(isCopyConstructor())),
+          has(typeLoc(forEach(ConstRefParamDecl))), unless(isInstantiated()),
+          decl().bind("functionDecl")),
+      this);
+}
+
+void PassSmallTrivialByValueCheck::check(
+    const MatchFinder::MatchResult &Result) {
+  const auto *Param = Result.Nodes.getNodeAs<ParmVarDecl>("param");
+  const auto *Function = Result.Nodes.getNodeAs<FunctionDecl>("functionDecl");
+  QualType Pointee = Param->getType()->getPointeeType();
+  if (!Pointee.isConstQualified())
+    return;
+  llvm::Optional<bool> IsCheap = utils::type_traits::isCheapToPassByValue(
+      Pointee, *Result.Context, MaxSize);
+  if (!IsCheap || !*IsCheap)
+    return;
+
+  for (const DeclRefExpr *Ref : utils::decl_ref_expr::allDeclRefExprs(
+           *Param, *Function, *Result.Context))
+    if (mayBindReference(*Ref, *Result.Context))
+      return;
+
+  const size_t Index = std::find(Function->parameters().begin(),
+                                 Function->parameters().end(), Param) -
+                       Function->parameters().begin();
+  auto Diag = diag(Param->getLocation(),
+                   "the parameter %0 of the trivially copyable type %1 is "
+                   "passed by const reference; consider passing it by value")
+              << utils::fixit::paramNameOrIndex(Param->getName(), Index)
+              << Pointee;
+  if (!utils::fixit::canChangeParamType(*Function, *Param, *Result.Context))
+    return;
+  for (const auto *FunctionDecl = Function; FunctionDecl != nullptr;
+       FunctionDecl = FunctionDecl->getPreviousDecl()) {
+    const auto &CurrentParam = *FunctionDecl->getParamDecl(Index);
+    FixItHint Fix = utils::fixit::changeVarDeclToValue(CurrentParam);
+    if (!Fix.isNull() && !Fix.RemoveRange.getBegin().isMacroID())
+      Diag << Fix;
+  }
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
@@ -10,13 +10,32 @@
 #include "../ClangTidy.h"
 #include "../ClangTidyModule.h"
 #include "../ClangTidyModuleRegistry.h"
+#include "AvoidStdFunctionInHotPathsCheck.h"
+#include "CopyOnLastUseCheck.h"
+#include "DevirtualizationFinalCheck.h"
+#include "FalseSharingCheck.h"
 #include "FasterStringFindCheck.h"
 #include "ForRangeCopyCheck.h"
+#include "ImplicitAtomicSeqCstCheck.h"
 #include "ImplicitCastInLoopCheck.h"
 #include "InefficientStringConcatenationCheck.h"
 #include "InefficientVectorOperationCheck.h"
+#include "IostreamHotPathCheck.h"
+#include "LambdaCaptureCopyCheck.h"
+#include "LockInLoopCheck.h"
+#include "MissingNoexceptMoveCheck.h"
+#include "OrderedContainerOnlyUsedForLookupCheck.h"
+#include "PassSmallTrivialByValueCheck.h"
+#include "PessimizingMoveInReturnCheck.h"
+#include "QuadraticEraseInLoopCheck.h"
+#include "RedundantAssociativeLookupCheck.h"
+#include "RegexOrLocaleConstructionInLoopCheck.h"
+#include "SmallFixedSizeContainerCheck.h"
+#include "StructPaddingCheck.h"
+#include "TemporaryStringMaterializationCheck.h"
 #include "TypePromotionInMathFnCheck.h"
 #include "UnnecessaryCopyInitialization.h"
+#include "UnnecessaryHeapAllocationCheck.h"
 #include "UnnecessaryValueParamCheck.h"
 
 namespace clang {
@@ -26,20 +45,58 @@ namespace performance {
 class PerformanceModule : public ClangTidyModule {
 public:
   void addCheckFactories(ClangTidyCheckFactories &CheckFactories) override {
+    CheckFactories.registerCheck<AvoidStdFunctionInHotPathsCheck>(
+        "performance-avoid-std-function-in-hot-paths");
+    CheckFactories.registerCheck<CopyOnLastUseCheck>(
+        "performance-copy-on-last-use");
+    CheckFactories.registerCheck<DevirtualizationFinalCheck>(
+        "performance-devirtualization-final");
+    CheckFactories.registerCheck<FalseSharingCheck>(
+        "performance-false-sharing");
     CheckFactories.registerCheck<FasterStringFindCheck>(
         "performance-faster-string-find");
     CheckFactories.registerCheck<ForRangeCopyCheck>(
         "performance-for-range-copy");
+    CheckFactories.registerCheck<ImplicitAtomicSeqCstCheck>(
+        "performance-implicit-atomic-seq-cst");
     CheckFactories.registerCheck<ImplicitCastInLoopCheck>(
         "performance-implicit-cast-in-loop");
     CheckFactories.registerCheck<InefficientStringConcatenationCheck>(
         "performance-inefficient-string-concatenation");
     CheckFactories.registerCheck<InefficientVectorOperationCheck>(
         "performance-inefficient-vector-operation");
+    CheckFactories.registerCheck<IostreamHotPathCheck>(
+        "performance-iostream-hot-path");
+    CheckFactories.registerCheck<LambdaCaptureCopyCheck>(
+        "performance-lambda-capture-copy");
+    CheckFactories.registerCheck<LockInLoopCheck>(
+        "performance-lock-in-loop");
+    CheckFactories.registerCheck<MissingNoexceptMoveCheck>(
+        "performance-missing-noexcept-move");
+    CheckFactories.registerCheck<OrderedContainerOnlyUsedForLookupCheck>(
+        "performance-ordered-container-only-used-for-lookup");
+    CheckFactories.registerCheck<PassSmallTrivialByValueCheck>(
+        "performance-pass-small-trivial-by-value");
+    CheckFactories.registerCheck<PessimizingMoveInReturnCheck>(
+        "performance-pessimizing-move-in-return");
+    CheckFactories.registerCheck<QuadraticEraseInLoopCheck>(
+        "performance-quadratic-erase-in-loop");
+    CheckFactories.registerCheck<RedundantAssociativeLookupCheck>(
+        "performance-redundant-associative-lookup");
+    CheckFactories.registerCheck<RegexOrLocaleConstructionInLoopCheck>(
+        "performance-regex-or-locale-construction-in-loop");
+    CheckFactories.registerCheck<SmallFixedSizeContainerCheck>(
+        "performance-small-fixed-size-container");
+    CheckFactories.registerCheck<StructPaddingCheck>(
+        "performance-struct-padding");
+    CheckFactories.registerCheck<TemporaryStringMaterializationCheck>(
+        "performance-temporary-string-materialization");
     CheckFactories.registerCheck<TypePromotionInMathFnCheck>(
         "performance-type-promotion-in-math-fn");
     CheckFactories.registerCheck<UnnecessaryCopyInitialization>(
         "performance-unnecessary-copy-initialization");
+    CheckFactories.registerCheck<UnnecessaryHeapAllocationCheck>(
+        "performance-unnecessary-heap-allocation");
     CheckFactories.registerCheck<UnnecessaryValueParamCheck>(
         "performance-unnecessary-value-param");
   }
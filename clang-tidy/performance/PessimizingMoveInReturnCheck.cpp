@@ -0,0 +1,131 @@
+//===--- PessimizingMoveInReturnCheck.cpp - clang-tidy---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PessimizingMoveInReturnCheck.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Lex/Lexer.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+static void replaceCallWithArg(const CallExpr *Call, DiagnosticBuilder &Diag,
+                               const SourceManager &SM,
+                               const LangOptions &LangOpts) {
+  const Expr *Arg = Call->getArg(0);
+
+  CharSourceRange BeforeArgumentsRange = Lexer::makeFileCharRange(
+      CharSourceRange::getCharRange(Call->getLocStart(), Arg->getLocStart()),
+      SM, LangOpts);
+  CharSourceRange AfterArgumentsRange = Lexer::makeFileCharRange(
+      CharSourceRange::getCharRange(Call->getLocEnd(),
+                                    Call->getLocEnd().getLocWithOffset(1)),
+      SM, LangOpts);
+
+  if (BeforeArgumentsRange.isValid() && AfterArgumentsRange.isValid()) {
+    Diag << FixItHint::CreateRemoval(BeforeArgumentsRange)
+         << FixItHint::CreateRemoval(AfterArgumentsRange);
+  }
+}
+
+// Returns true if returning \p Var, an automatic variable, moves it
+// implicitly into the object constructed by \p Construct.
+static bool isMovedImplicitly(const VarDecl *Var,
+                              const CXXConstructExpr *Construct,
+                              const ASTContext &Context) {
+  // C++11 [class.copy]p32: The object is treated as an rvalue if it could be
+  // elided, i.e. it has the return type, or if it's a function parameter.
+  QualType VarType = Var->getType();
+  if (Context.hasSameUnqualifiedType(VarType, Construct->getType()))
+    return true;
+  // CWG1579, applied since C++14: The object is also treated as an rvalue if
+  // the selected constructor takes an rvalue reference to its type.
+  if (!Context.getLangOpts().CPlusPlus14)
+    return false;
+  const CXXConstructorDecl *Ctor = Construct->getConstructor();
+  if (Ctor->getNumParams() == 0)
+    return false;
+  const auto *Param =
+      Ctor->getParamDecl(0)->getType()->getAs<RValueReferenceType>();
+  return Param &&
+         Context.hasSameUnqualifiedType(Param->getPointeeType(), VarType);
+}
+
+void PessimizingMoveInReturnCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  const auto MoveCall =
+      callExpr(callee(functionDecl(hasName("::std::move"))),
+               argumentCountIs(1), unless(isInTemplateInstantiation()))
+          .bind("move");
+  const auto ConstructFromMove =
+      cxxConstructExpr(hasArgument(0, ignoringParenImpCasts(MoveCall)))
+          .bind("construct");
+
+  Finder->addMatcher(
+      returnStmt(hasReturnValue(ignoringImplicit(ConstructFromMove)))
+          .bind("return"),
+      this);
+  Finder->addMatcher(
+      varDecl(hasInitializer(ignoringImplicit(ConstructFromMove))), this);
+}
+
+void PessimizingMoveInReturnCheck::check(
+    const MatchFinder::MatchResult &Result) {
+  const ASTContext &Context = *Result.Context;
+  const auto *Move = Result.Nodes.getNodeAs<CallExpr>("move");
+  const auto *Construct =
+      Result.Nodes.getNodeAs<CXXConstructExpr>("construct");
+  const SourceManager &SM = *Result.SourceManager;
+  if (Move->getLocStart().isMacroID())
+    return;
+
+  // std::move(T()): The move constructor is called instead of constructing
+  // the object in place.
+  const Expr *Arg = Move->getArg(0)->IgnoreParens();
+  if (const auto *Temporary = dyn_cast<MaterializeTemporaryExpr>(Arg)) {
+    if (!Context.hasSameUnqualifiedType(Temporary->getType(),
+                                        Construct->getType()))
+      return;
+    auto Diag = diag(Move->getLocStart(),
+                     "std::move of a temporary object prevents copy elision; "
+                     "remove std::move()");
+    replaceCallWithArg(Move, Diag, SM, getLangOpts());
+    return;
+  }
+
+  if (!Result.Nodes.getNodeAs<ReturnStmt>("return"))
+    return;
+  const auto *Ref = dyn_cast<DeclRefExpr>(Arg->IgnoreParenImpCasts());
+  const auto *Var = Ref ? dyn_cast<VarDecl>(Ref->getDecl()) : nullptr;
+  // Only automatic objects of the returning function are moved implicitly.
+  if (!Var || !Var->hasLocalStorage() || Var->getType()->isReferenceType() ||
+      Var->getType().isVolatileQualified() || Var->isExceptionVariable() ||
+      Ref->refersToEnclosingVariableOrCapture() ||
+      !isMovedImplicitly(Var, Construct, Context))
+    return;
+
+  bool IsElisionCandidate =
+      !isa<ParmVarDecl>(Var) &&
+      Context.hasSameUnqualifiedType(Var->getType(), Construct->getType());
+  auto Diag = diag(Move->getLocStart(),
+                   "%select{redundant move of %1 in return statement|moving "
+                   "local object %1 in return statement prevents copy "
+                   "elision}0; remove std::move()")
+              << IsElisionCandidate << Var;
+  replaceCallWithArg(Move, Diag, SM, getLangOpts());
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,420 @@
+//===--- QuadraticEraseInLoopCheck.cpp - clang-tidy------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "QuadraticEraseInLoopCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/OptionsUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/Preprocessor.h"
+#include <algorithm>
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+static const char DefaultVectorLikeClasses[] =
+    "::std::vector;::std::deque;::std::basic_string";
+
+// The name of the lambda parameter in the erase-remove rewrite.
+static const char ElementName[] = "Element";
+
+// Returns the variable or field the container expression \p E refers to.
+static const ValueDecl *getContainerDecl(const Expr *E) {
+  E = E->IgnoreParenImpCasts();
+  if (const auto *Ref = dyn_cast<DeclRefExpr>(E))
+    return Ref->getDecl();
+  if (const auto *Member = dyn_cast<MemberExpr>(E))
+    return Member->getMemberDecl();
+  return nullptr;
+}
+
+// Returns true if \p S refers to the variable or field \p D.
+static bool refersTo(const Stmt *S, const ValueDecl *D, ASTContext &Context) {
+  if (!S)
+    return false;
+  return !match(findAll(expr(anyOf(declRefExpr(to(equalsNode(D))),
+                                   memberExpr(member(equalsNode(D)))))),
+                *S, Context)
+              .empty();
+}
+
+// Returns true if the statement \p S leaves the enclosing loop.
+static bool isLoopExit(const Stmt *S) {
+  if (const auto *E = dyn_cast<Expr>(S))
+    return isa<CXXThrowExpr>(E->IgnoreImplicit());
+  return isa<BreakStmt>(S) || isa<ReturnStmt>(S) || isa<GotoStmt>(S);
+}
+
+// Returns the innermost loop around \p Erase which iterates over the
+// container \p Container, unless the loop is left right after the erase.
+static const Stmt *getLoopOverContainer(const Stmt *Erase,
+                                        const ValueDecl *Container,
+                                        ASTContext &Context) {
+  const Stmt *S = Erase;
+  for (const Stmt *Parent = utils::getParentStmt(S, Context); Parent;
+       S = Parent, Parent = utils::getParentStmt(Parent, Context)) {
+    if (isa<LambdaExpr>(Parent) || isa<ReturnStmt>(Parent))
+      return nullptr;
+    if (const auto *Compound = dyn_cast<CompoundStmt>(Parent)) {
+      const auto *Child = std::find(Compound->body_begin(),
+                                    Compound->body_end(), S);
+      if (std::any_of(Child, Compound->body_end(), isLoopExit))
+        return nullptr;
+    } else if (const auto *For = dyn_cast<ForStmt>(Parent)) {
+      if (S != For->getInit() &&
+          (refersTo(For->getInit(), Container, Context) ||
+           refersTo(For->getCond(), Container, Context) ||
+           refersTo(For->getInc(), Container, Context)))
+        return For;
+    } else if (const auto *While = dyn_cast<WhileStmt>(Parent)) {
+      if (refersTo(While->getCond(), Container, Context))
+        return While;
+    } else if (const auto *Do = dyn_cast<DoStmt>(Parent)) {
+      if (refersTo(Do->getCond(), Container, Context))
+        return Do;
+    } else if (const auto *RangeFor = dyn_cast<CXXForRangeStmt>(Parent)) {
+      if (S == RangeFor->getBody() &&
+          refersTo(RangeFor->getRangeInit(), Container, Context))
+        return RangeFor;
+    }
+  }
+  return nullptr;
+}
+
+// Strips implicit nodes, copies of iterators and conversions to const
+// iterators.
+static const Expr *ignoreImplicitCopies(const Expr *E) {
+  E = E->IgnoreImplicit();
+  while (const auto *Construct = dyn_cast<CXXConstructExpr>(E)) {
+    if (Construct->getNumArgs() != 1 || isa<CXXTemporaryObjectExpr>(Construct))
+      break;
+    E = Construct->getArg(0)->IgnoreImplicit();
+  }
+  return E;
+}
+
+static bool isRefTo(const Expr *E, const VarDecl *Var) {
+  const auto *Ref = dyn_cast<DeclRefExpr>(ignoreImplicitCopies(E));
+  return Ref && Ref->getDecl() == Var;
+}
+
+// Returns true if \p E calls the method \p Name without arguments on
+// \p Container.
+static bool isCallOn(const Expr *E, StringRef Name,
+                     const ValueDecl *Container) {
+  const auto *Call = dyn_cast<CXXMemberCallExpr>(ignoreImplicitCopies(E));
+  if (!Call || Call->getNumArgs() != 0 || !Call->getMethodDecl())
+    return false;
+  const CXXMethodDecl *Method = Call->getMethodDecl();
+  return Method->getDeclName().isIdentifier() && Method->getName() == Name &&
+         getContainerDecl(Call->getImplicitObjectArgument()) == Container;
+}
+
+// Returns the operands of the comparison or assignment \p E, if it uses the
+// operator \p BinaryOp or \p OverloadedOp.
+static bool getOperands(const Expr *E, BinaryOperatorKind BinaryOp,
+                        OverloadedOperatorKind OverloadedOp, const Expr *&LHS,
+                        const Expr *&RHS) {
+  E = E->IgnoreImplicit();
+  if (const auto *Op = dyn_cast<BinaryOperator>(E)) {
+    if (Op->getOpcode() != BinaryOp)
+      return false;
+    LHS = Op->getLHS();
+    RHS = Op->getRHS();
+    return true;
+  }
+  const auto *Call = dyn_cast<CXXOperatorCallExpr>(E);
+  if (!Call || Call->getOperator() != OverloadedOp || Call->getNumArgs() != 2)
+    return false;
+  LHS = Call->getArg(0);
+  RHS = Call->getArg(1);
+  return true;
+}
+
+// Returns true if \p E is the position of the last element of \p Container,
+// i.e. `C.end() - 1`, `--C.end()`, `std::prev(C.end())` or the index
+// `C.size() - 1`.
+static bool isLastElement(const Expr *E, const ValueDecl *Container) {
+  E = ignoreImplicitCopies(E);
+  const Expr *LHS, *RHS;
+  if (getOperands(E, BO_Sub, OO_Minus, LHS, RHS)) {
+    const auto *One = dyn_cast<IntegerLiteral>(RHS->IgnoreParenImpCasts());
+    return One && One->getValue() == 1 &&
+           (isCallOn(LHS, "end", Container) ||
+            isCallOn(LHS->IgnoreParenImpCasts(), "size", Container));
+  }
+  if (const auto *Op = dyn_cast<UnaryOperator>(E))
+    return Op->getOpcode() == UO_PreDec &&
+           isCallOn(Op->getSubExpr(), "end", Container);
+  if (const auto *Call = dyn_cast<CXXOperatorCallExpr>(E))
+    return Call->getOperator() == OO_MinusMinus && Call->getNumArgs() == 1 &&
+           isCallOn(Call->getArg(0), "end", Container);
+  const auto *Call = dyn_cast<CallExpr>(E);
+  const FunctionDecl *Callee = Call ? Call->getDirectCallee() : nullptr;
+  return Callee && Callee->getQualifiedNameAsString() == "std::prev" &&
+         Call->getNumArgs() >= 1 &&
+         isCallOn(Call->getArg(0), "end", Container) &&
+         (Call->getNumArgs() == 1 || isa<CXXDefaultArgExpr>(Call->getArg(1)));
+}
+
+static bool isIncrementOf(const Stmt *S, const VarDecl *Iterator) {
+  if (const auto *Op = dyn_cast<UnaryOperator>(S))
+    return Op->isIncrementOp() && isRefTo(Op->getSubExpr(), Iterator);
+  const auto *Call = dyn_cast<CXXOperatorCallExpr>(S);
+  return Call && Call->getOperator() == OO_PlusPlus &&
+         isRefTo(Call->getArg(0), Iterator);
+}
+
+// Returns the only statement of a compound statement, or \p S itself.
+static const Stmt *getSingleStmt(const Stmt *S) {
+  const auto *Compound = dyn_cast_or_null<CompoundStmt>(S);
+  return Compound && Compound->size() == 1 ? Compound->body_front() : S;
+}
+
+static StringRef getText(CharSourceRange Range, const ASTContext &Context) {
+  return Lexer::getSourceText(Range, Context.getSourceManager(),
+                              Context.getLangOpts());
+}
+
+// Rewrites the condition \p Cond to a predicate on the element the iterator
+// points to, e.g. `*It == 0` to `Element == 0`.
+static llvm::Optional<std::string> getPredicate(const Expr *Cond,
+                                                const VarDecl *Iterator,
+                                                ASTContext &Context) {
+  const SourceManager &SM = Context.getSourceManager();
+  const LangOptions &LangOpts = Context.getLangOpts();
+  if (Cond->getLocStart().isMacroID() || Cond->getLocEnd().isMacroID())
+    return llvm::None;
+  // The lambda parameter must not hide a variable used in the condition.
+  for (const auto &Match : match(findAll(declRefExpr().bind("ref")), *Cond,
+                                 Context)) {
+    const ValueDecl *D = Match.getNodeAs<DeclRefExpr>("ref")->getDecl();
+    if (D->getDeclName().isIdentifier() && D->getName() == ElementName)
+      return llvm::None;
+  }
+
+  // Collect the replacements of `*It` and `It->`.
+  std::vector<std::pair<CharSourceRange, std::string>> Replacements;
+  for (const auto &Match :
+       match(findAll(declRefExpr(to(varDecl(equalsNode(Iterator))))
+                         .bind("ref")),
+             *Cond, Context)) {
+    const Expr *E = Match.getNodeAs<DeclRefExpr>("ref");
+    const Stmt *Parent = utils::getParentStmt(E, Context);
+    while (Parent && isa<ImplicitCastExpr>(Parent)) {
+      E = cast<Expr>(Parent);
+      Parent = utils::getParentStmt(E, Context);
+    }
+    const auto *Deref = dyn_cast_or_null<UnaryOperator>(Parent);
+    const auto *Call = dyn_cast_or_null<CXXOperatorCallExpr>(Parent);
+    const MemberExpr *Member = nullptr;
+    if (Call && Call->getOperator() == OO_Arrow)
+      Member =
+          dyn_cast_or_null<MemberExpr>(utils::getParentStmt(Call, Context));
+    else
+      Member = dyn_cast_or_null<MemberExpr>(Parent);
+
+    if ((Deref && Deref->getOpcode() == UO_Deref) ||
+        (Call && Call->getOperator() == OO_Star)) {
+      Replacements.emplace_back(
+          CharSourceRange::getTokenRange(Parent->getSourceRange()),
+          ElementName);
+    } else if (Member && Member->isArrow() &&
+               (Call ? Member->getBase()->IgnoreImplicit() == Call
+                     : Member->getBase() == E)) {
+      Replacements.emplace_back(
+          CharSourceRange::getCharRange(E->getLocStart(),
+                                        Member->getMemberLoc()),
+          (llvm::Twine(ElementName) + ".").str());
+    } else {
+      return llvm::None;
+    }
+  }
+
+  // Apply the replacements to the text of the condition.
+  std::sort(Replacements.begin(), Replacements.end(),
+            [&SM](const std::pair<CharSourceRange, std::string> &LHS,
+                  const std::pair<CharSourceRange, std::string> &RHS) {
+              return SM.isBeforeInTranslationUnit(LHS.first.getBegin(),
+                                                  RHS.first.getBegin());
+            });
+  std::string Predicate;
+  SourceLocation Pos = Cond->getLocStart();
+  for (const auto &Replacement : Replacements) {
+    CharSourceRange Range =
+        Lexer::makeFileCharRange(Replacement.first, SM, LangOpts);
+    if (Range.isInvalid())
+      return llvm::None;
+    Predicate += getText(CharSourceRange::getCharRange(Pos, Range.getBegin()),
+                         Context);
+    Predicate += Replacement.second;
+    Pos = Range.getEnd();
+  }
+  Predicate += getText(CharSourceRange::getCharRange(
+                           Pos, Lexer::getLocForEndOfToken(
+                                    Cond->getLocEnd(), 0, SM, LangOpts)),
+                       Context);
+  return Predicate;
+}
+
+// Returns the erase-remove rewrite of the loop \p Loop if it has the shape
+//
+//   for (auto It = C.begin(); It != C.end();) {
+//     if (Cond)
+//       It = C.erase(It);
+//     else
+//       ++It;
+//   }
+static llvm::Optional<std::string>
+getEraseRemoveRewrite(const Stmt *Loop, const CXXMemberCallExpr *Erase,
+                      const ValueDecl *Container, ASTContext &Context) {
+  const auto *For = dyn_cast<ForStmt>(Loop);
+  if (!For || For->getInc() || !For->getCond() ||
+      !isa<CompoundStmt>(For->getBody()) || Erase->getNumArgs() != 1)
+    return llvm::None;
+  const auto *Init = dyn_cast_or_null<DeclStmt>(For->getInit());
+  const auto *Iterator =
+      Init && Init->isSingleDecl() ? dyn_cast<VarDecl>(Init->getSingleDecl())
+                                   : nullptr;
+  if (!Iterator || !Iterator->getInit() ||
+      !isCallOn(Iterator->getInit(), "begin", Container))
+    return llvm::None;
+
+  const Expr *LHS, *RHS;
+  if (!getOperands(For->getCond(), BO_NE, OO_ExclaimEqual, LHS, RHS) ||
+      !isRefTo(LHS, Iterator) || !isCallOn(RHS, "end", Container))
+    return llvm::None;
+
+  const auto *If = dyn_cast<IfStmt>(getSingleStmt(For->getBody()));
+  if (!If || If->getInit() || If->getConditionVariable() || !If->getElse() ||
+      !isIncrementOf(getSingleStmt(If->getElse()), Iterator))
+    return llvm::None;
+  const auto *Assign = dyn_cast<Expr>(getSingleStmt(If->getThen()));
+  if (!Assign ||
+      !getOperands(Assign, BO_Assign, OO_Equal, LHS, RHS) ||
+      !isRefTo(LHS, Iterator) || ignoreImplicitCopies(RHS) != Erase ||
+      !isRefTo(Erase->getArg(0), Iterator) ||
+      refersTo(If->getCond(), Container, Context))
+    return llvm::None;
+
+  llvm::Optional<std::string> Predicate =
+      getPredicate(If->getCond(), Iterator, Context);
+  if (!Predicate)
+    return llvm::None;
+
+  const Expr *Object = Erase->getImplicitObjectArgument();
+  const auto *Callee = dyn_cast<MemberExpr>(Erase->getCallee());
+  if (!Callee || Object->getLocStart().isMacroID() ||
+      Object->getLocEnd().isMacroID())
+    return llvm::None;
+  std::string Access =
+      (getText(CharSourceRange::getTokenRange(Object->getSourceRange()),
+               Context) +
+       (Callee->isArrow() ? "->" : "."))
+          .str();
+  std::string Param =
+      Context.getLangOpts().CPlusPlus14
+          ? "auto &"
+          : "decltype(*" + Access + "begin()) ";
+  return Access + "erase(std::remove_if(" + Access + "begin(), " + Access +
+         "end(), [&](" + Param + ElementName + ") { return " + *Predicate +
+         "; }), " + Access + "end());";
+}
+
+QuadraticEraseInLoopCheck::QuadraticEraseInLoopCheck(StringRef Name,
+                                                     ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      VectorLikeClasses(utils::options::parseStringList(
+          Options.get("VectorLikeClasses", DefaultVectorLikeClasses))),
+      IncludeStyle(utils::IncludeSorter::parseIncludeStyle(
+          Options.get("IncludeStyle", "llvm"))) {}
+
+void QuadraticEraseInLoopCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "VectorLikeClasses",
+                utils::options::serializeStringList(VectorLikeClasses));
+  Options.store(Opts, "IncludeStyle",
+                utils::IncludeSorter::toString(IncludeStyle));
+}
+
+void QuadraticEraseInLoopCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus)
+    return;
+
+  const auto VectorDecl = cxxRecordDecl(hasAnyName(SmallVector<StringRef, 5>(
+      VectorLikeClasses.begin(), VectorLikeClasses.end())));
+  Finder->addMatcher(
+      cxxMemberCallExpr(
+          thisPointerType(VectorDecl), callee(cxxMethodDecl(hasName("erase"))),
+          hasAncestor(stmt(anyOf(forStmt(), cxxForRangeStmt(), whileStmt(),
+                                 doStmt()))),
+          unless(isInTemplateInstantiation()))
+          .bind("erase"),
+      this);
+}
+
+void QuadraticEraseInLoopCheck::check(const MatchFinder::MatchResult &Result) {
+  const auto *Erase = Result.Nodes.getNodeAs<CXXMemberCallExpr>("erase");
+  ASTContext &Context = *Result.Context;
+  const ValueDecl *Container =
+      getContainerDecl(Erase->getImplicitObjectArgument());
+  if (!Container)
+    return;
+  // Erasing up to the end, e.g. to truncate the container, is linear in the
+  // number of erased elements.
+  if (Erase->getNumArgs() == 2 && isCallOn(Erase->getArg(1), "end", Container))
+    return;
+  // Erasing the last element doesn't move any other element, e.g. to pop the
+  // elements of a stack.
+  if (Erase->getNumArgs() >= 1 && isLastElement(Erase->getArg(0), Container))
+    return;
+  // A deque also erases the first element without moving the others, e.g. to
+  // pop the elements of a queue.
+  if (Erase->getNumArgs() >= 1 &&
+      isCallOn(Erase->getArg(0), "begin", Container) &&
+      !match(cxxRecordDecl(hasName("::std::deque")),
+             *Erase->getMethodDecl()->getParent(), Context)
+           .empty())
+    return;
+  const Stmt *Loop = getLoopOverContainer(Erase, Container, Context);
+  if (!Loop)
+    return;
+
+  const auto *Callee = dyn_cast<MemberExpr>(Erase->getCallee());
+  auto Diag = diag(Callee ? Callee->getMemberLoc() : Erase->getLocStart(),
+                   "'erase' is called inside a loop over the same container, "
+                   "which has quadratic complexity; consider the "
+                   "erase-remove idiom");
+  llvm::Optional<std::string> Rewrite =
+      getEraseRemoveRewrite(Loop, Erase, Container, Context);
+  if (!Rewrite || Loop->getLocStart().isMacroID() ||
+      Loop->getLocEnd().isMacroID())
+    return;
+  Diag << FixItHint::CreateReplacement(Loop->getSourceRange(), *Rewrite);
+  if (auto IncludeFixit = Inserter->CreateIncludeInsertion(
+          Context.getSourceManager().getFileID(Loop->getLocStart()),
+          "algorithm", /*IsAngled=*/true))
+    Diag << *IncludeFixit;
+}
+
+void QuadraticEraseInLoopCheck::registerPPCallbacks(
+    CompilerInstance &Compiler) {
+  Inserter.reset(new utils::IncludeInserter(
+      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
+  Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,586 @@
+//===--- RedundantAssociativeLookupCheck.cpp - clang-tidy------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RedundantAssociativeLookupCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/DeclRefExprUtils.h"
+#include "../utils/OptionsUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/StringSwitch.h"
+#include <algorithm>
+#include <iterator>
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+namespace {
+
+// How a call on the container relates to the lookup of a key.
+enum class CallKind {
+  // Any other call, which may modify the container.
+  Other,
+  // Doesn't modify the container and doesn't look up a key, e.g. 'end()'.
+  Observer,
+  // Looks up a key without modifying the container: 'count', 'find', ...
+  Query,
+  // Looks up a key and inserts it if it's missing: 'operator[]', 'insert',
+  // ...
+  Insertion,
+};
+
+} // namespace
+
+static const char DefaultAssociativeClasses[] =
+    "::std::map;::std::set;::std::unordered_map;::std::unordered_set";
+
+static StringRef getCalleeName(const CallExpr *Call) {
+  if (const auto *Operator = dyn_cast<CXXOperatorCallExpr>(Call))
+    return Operator->getOperator() == OO_Subscript ? "operator[]" : "";
+  const FunctionDecl *Callee = Call->getDirectCallee();
+  if (!Callee || !Callee->getDeclName().isIdentifier())
+    return "";
+  return Callee->getName();
+}
+
+static CallKind getCallKind(const CallExpr *Call) {
+  return llvm::StringSwitch<CallKind>(getCalleeName(Call))
+      .Cases("count", "find", "at", "contains", CallKind::Query)
+      .Cases("operator[]", "insert", "emplace", "try_emplace",
+             CallKind::Insertion)
+      .Cases("begin", "cbegin", "end", "cend", "size", "empty",
+             CallKind::Observer)
+      .Cases("equal_range", "lower_bound", "upper_bound", CallKind::Observer)
+      .Default(CallKind::Other);
+}
+
+static bool isDescendantOrEqual(const Stmt *Descendant, const Stmt *Ancestor,
+                                ASTContext &Context) {
+  for (const Stmt *S = Descendant; S; S = utils::getParentStmt(S, Context))
+    if (S == Ancestor)
+      return true;
+  return false;
+}
+
+// Returns the call on the container made through \p Ref, if any.
+static const CallExpr *getContainerCall(const DeclRefExpr *Ref,
+                                        ASTContext &Context) {
+  const Stmt *Child = Ref;
+  for (const Stmt *Parent = utils::getParentStmt(Child, Context); Parent;
+       Child = Parent, Parent = utils::getParentStmt(Parent, Context)) {
+    if (isa<ImplicitCastExpr>(Parent) || isa<ParenExpr>(Parent) ||
+        isa<MemberExpr>(Parent))
+      continue;
+    if (const auto *Call = dyn_cast<CXXMemberCallExpr>(Parent))
+      return Call->getImplicitObjectArgument()->IgnoreParenImpCasts() == Ref
+                 ? Call
+                 : nullptr;
+    if (const auto *Call = dyn_cast<CXXOperatorCallExpr>(Parent))
+      return Call->getNumArgs() > 0 &&
+                     Call->getArg(0)->IgnoreParenImpCasts() == Ref
+                 ? Call
+                 : nullptr;
+    return nullptr;
+  }
+  return nullptr;
+}
+
+// Strips implicit conversions of a key, e.g. from a string literal to
+// 'std::string'.
+static const Expr *stripKey(const Expr *E) {
+  while (true) {
+    E = E->IgnoreImplicit()->IgnoreParens();
+    const auto *Construct = dyn_cast<CXXConstructExpr>(E);
+    if (!Construct || Construct->getNumArgs() != 1 ||
+        Construct->isListInitialization() || isa<CXXTemporaryObjectExpr>(E))
+      return E;
+    E = Construct->getArg(0);
+  }
+}
+
+static bool isPair(QualType Type) {
+  const auto *Record = Type->getAsCXXRecordDecl();
+  return Record && Record->getName() == "pair" && Record->isInStdNamespace();
+}
+
+// Returns the key looked up by \p Call.
+static const Expr *getLookupKey(const CallExpr *Call) {
+  unsigned FirstArg = isa<CXXOperatorCallExpr>(Call) ? 1 : 0;
+  if (Call->getNumArgs() <= FirstArg)
+    return nullptr;
+  const Expr *Arg = Call->getArg(FirstArg);
+  if (getCalleeName(Call) != "insert" || !isPair(Arg->getType()))
+    return Arg;
+
+  // Map insertion: 'insert(std::make_pair(k, v))' or 'insert({k, v})'.
+  const Expr *Value = Arg->IgnoreImplicit()->IgnoreParens();
+  if (const auto *MakePair = dyn_cast<CallExpr>(Value)) {
+    const FunctionDecl *Callee = MakePair->getDirectCallee();
+    if (Callee && Callee->getDeclName().isIdentifier() &&
+        Callee->getName() == "make_pair" && Callee->isInStdNamespace() &&
+        MakePair->getNumArgs() == 2)
+      return MakePair->getArg(0);
+    return nullptr;
+  }
+  if (const auto *Construct = dyn_cast<CXXConstructExpr>(Value))
+    if (Construct->getNumArgs() == 2)
+      return Construct->getArg(0);
+  return nullptr;
+}
+
+static bool areSameKeys(const Expr *LHS, const Expr *RHS,
+                        const ASTContext &Context) {
+  llvm::FoldingSetNodeID LHSID, RHSID;
+  stripKey(LHS)->Profile(LHSID, Context, /*Canonical=*/true);
+  stripKey(RHS)->Profile(RHSID, Context, /*Canonical=*/true);
+  return LHSID == RHSID;
+}
+
+// Returns true if \p Child is evaluated whenever its parent \p Parent is.
+static bool isAlwaysEvaluated(const Stmt *Parent, const Stmt *Child) {
+  if (const auto *If = dyn_cast<IfStmt>(Parent))
+    return Child == If->getInit() ||
+           Child == If->getConditionVariableDeclStmt() ||
+           Child == If->getCond();
+  if (const auto *Conditional = dyn_cast<AbstractConditionalOperator>(Parent))
+    return Child == Conditional->getCond();
+  if (const auto *Binary = dyn_cast<BinaryOperator>(Parent))
+    return !Binary->isLogicalOp() || Child == Binary->getLHS();
+  if (const auto *While = dyn_cast<WhileStmt>(Parent))
+    return Child == While->getConditionVariableDeclStmt() ||
+           Child == While->getCond();
+  if (const auto *For = dyn_cast<ForStmt>(Parent))
+    return Child == For->getInit() ||
+           Child == For->getConditionVariableDeclStmt() ||
+           Child == For->getCond();
+  if (const auto *Switch = dyn_cast<SwitchStmt>(Parent))
+    return Child == Switch->getInit() ||
+           Child == Switch->getConditionVariableDeclStmt() ||
+           Child == Switch->getCond();
+  if (const auto *ForRange = dyn_cast<CXXForRangeStmt>(Parent))
+    return Child == ForRange->getRangeStmt();
+  return !isa<DoStmt>(Parent) && !isa<LambdaExpr>(Parent) &&
+         !isa<BlockExpr>(Parent) && !isa<CXXCatchStmt>(Parent) &&
+         !isa<SwitchCase>(Parent) && !isa<LabelStmt>(Parent);
+}
+
+// Returns the position of \p Child in the evaluation order of the control flow
+// statement \p Parent, or -1 if it doesn't have a fixed position.
+static int getControlFlowPosition(const Stmt *Parent, const Stmt *Child) {
+  SmallVector<const Stmt *, 5> Order;
+  if (const auto *If = dyn_cast<IfStmt>(Parent)) {
+    Order = {If->getInit(), If->getConditionVariableDeclStmt(), If->getCond()};
+    if (Child == If->getThen() || Child == If->getElse())
+      return Order.size();
+  } else if (const auto *Conditional =
+                 dyn_cast<AbstractConditionalOperator>(Parent)) {
+    Order = {Conditional->getCond()};
+    if (Child == Conditional->getTrueExpr() ||
+        Child == Conditional->getFalseExpr())
+      return Order.size();
+  } else if (const auto *Binary = dyn_cast<BinaryOperator>(Parent)) {
+    if (!Binary->isLogicalOp() && !Binary->isCommaOp())
+      return -1;
+    Order = {Binary->getLHS(), Binary->getRHS()};
+  } else if (const auto *While = dyn_cast<WhileStmt>(Parent)) {
+    Order = {While->getConditionVariableDeclStmt(), While->getCond(),
+             While->getBody()};
+  } else if (const auto *For = dyn_cast<ForStmt>(Parent)) {
+    Order = {For->getInit(), For->getConditionVariableDeclStmt(),
+             For->getCond(), For->getBody(), For->getInc()};
+  } else if (const auto *Switch = dyn_cast<SwitchStmt>(Parent)) {
+    Order = {Switch->getInit(), Switch->getConditionVariableDeclStmt(),
+             Switch->getCond(), Switch->getBody()};
+  } else {
+    return -1;
+  }
+  for (unsigned I = 0, E = Order.size(); I != E; ++I)
+    if (Order[I] && Order[I] == Child)
+      return I;
+  return -1;
+}
+
+// Returns true if \p Before is evaluated before \p After. If \p Unconditional
+// is set, \p Before also has to be evaluated whenever \p After is.
+static bool isEvaluatedBefore(const Stmt *Before, const Stmt *After,
+                              bool Unconditional,
+                              const utils::ExprSequence &Sequence,
+                              ASTContext &Context) {
+  SmallVector<const Stmt *, 16> AfterAncestors;
+  for (const Stmt *S = After; S; S = utils::getParentStmt(S, Context))
+    AfterAncestors.push_back(S);
+
+  const Stmt *Child = Before;
+  for (const Stmt *Parent = utils::getParentStmt(Child, Context); Parent;
+       Child = Parent, Parent = utils::getParentStmt(Parent, Context)) {
+    auto It = std::find(AfterAncestors.begin(), AfterAncestors.end(), Parent);
+    if (It == AfterAncestors.end()) {
+      if (Unconditional && !isAlwaysEvaluated(Parent, Child))
+        return false;
+      continue;
+    }
+    // 'Parent' is the closest common ancestor.
+    if (It == AfterAncestors.begin())
+      return false;
+    const Stmt *AfterChild = *std::prev(It);
+    int BeforePosition = getControlFlowPosition(Parent, Child);
+    int AfterPosition = getControlFlowPosition(Parent, AfterChild);
+    if (BeforePosition >= 0 && AfterPosition >= 0)
+      return BeforePosition < AfterPosition;
+    return Sequence.inSequence(Before, After);
+  }
+  return false;
+}
+
+// Returns true if \p Lookup is only evaluated if the key is missing according
+// to the result of the preceding \p Count, e.g. 'm[k] = v' in
+// 'if (!m.count(k)) m[k] = v;'. The statement or conditional operator making
+// the decision is stored in \p Guard.
+static bool isEvaluatedIfKeyMissing(const CallExpr *Count, const Stmt *Lookup,
+                                    ASTContext &Context, const Stmt *&Guard) {
+  bool Negated = false;
+  const Stmt *Child = Count;
+  for (const Stmt *Parent = utils::getParentStmt(Child, Context); Parent;
+       Child = Parent, Parent = utils::getParentStmt(Parent, Context)) {
+    if (isa<ImplicitCastExpr>(Parent) || isa<ParenExpr>(Parent))
+      continue;
+    if (const auto *Unary = dyn_cast<UnaryOperator>(Parent)) {
+      if (Unary->getOpcode() != UO_LNot)
+        return false;
+      Negated = !Negated;
+      continue;
+    }
+    if (const auto *Binary = dyn_cast<BinaryOperator>(Parent)) {
+      // 'count(k) == 0' or 'count(k) != 0'.
+      const Expr *Other = Binary->getLHS() == Child ? Binary->getRHS()
+                                                    : Binary->getLHS();
+      llvm::APSInt Value;
+      if (!Binary->isEqualityOp() ||
+          !Other->isIntegerConstantExpr(Value, Context) || Value != 0)
+        return false;
+      if (Binary->getOpcode() == BO_EQ)
+        Negated = !Negated;
+      continue;
+    }
+    const Stmt *Then = nullptr, *Else = nullptr;
+    if (const auto *If = dyn_cast<IfStmt>(Parent)) {
+      if (Child != If->getCond())
+        return false;
+      Then = If->getThen();
+      Else = If->getElse();
+    } else if (const auto *Conditional =
+                   dyn_cast<AbstractConditionalOperator>(Parent)) {
+      if (Child != Conditional->getCond())
+        return false;
+      Then = Conditional->getTrueExpr();
+      Else = Conditional->getFalseExpr();
+    } else {
+      return false;
+    }
+    Guard = Parent;
+    if (isDescendantOrEqual(Lookup, Then, Context))
+      return Negated;
+    return Else && isDescendantOrEqual(Lookup, Else, Context) && !Negated;
+  }
+  return false;
+}
+
+// Returns true if \p Ref may modify the variable it refers to.
+static bool
+isModifyingUse(const DeclRefExpr *Ref,
+               const llvm::SmallPtrSetImpl<const DeclRefExpr *> &ConstRefs,
+               ASTContext &Context) {
+  if (ConstRefs.count(Ref))
+    return false;
+  const Stmt *Parent = utils::getParentStmt(Ref, Context);
+  if (const auto *Cast = dyn_cast_or_null<ImplicitCastExpr>(Parent))
+    if (Cast->getCastKind() == CK_LValueToRValue)
+      return false;
+  if (const CallExpr *Call = getContainerCall(Ref, Context)) {
+    CallKind Kind = getCallKind(Call);
+    return Kind != CallKind::Query && Kind != CallKind::Observer;
+  }
+  return true;
+}
+
+// Returns true if a pointer or a non-const reference to \p Var may be stored
+// somewhere in \p Body, so that any call may modify it.
+static bool mayEscape(const VarDecl &Var, const Stmt &Body,
+                      ASTContext &Context) {
+  auto ConstRefs =
+      utils::decl_ref_expr::constReferenceDeclRefExprs(Var, Body, Context);
+  for (const DeclRefExpr *Ref :
+       utils::decl_ref_expr::allDeclRefExprs(Var, Body, Context))
+    if (!getContainerCall(Ref, Context) &&
+        isModifyingUse(Ref, ConstRefs, Context))
+      return true;
+  return false;
+}
+
+static StringRef getText(const Expr *E, ASTContext &Context) {
+  return Lexer::getSourceText(
+      CharSourceRange::getTokenRange(E->getSourceRange()),
+      Context.getSourceManager(), Context.getLangOpts());
+}
+
+// Returns the fix replacing \p Guard, which checks that the key is missing, by
+// the insertion \p Lookup in its branch, e.g. 'if (!m.count(k)) m[k] = v;' by
+// 'm.try_emplace(k, v);'. The fix is empty if the insertion does more than
+// that or evaluating its arguments unconditionally could change the behavior.
+static FixItHint getInsertionFix(const IfStmt *Guard, const CallExpr *Lookup,
+                                 ASTContext &Context) {
+  if (Guard->getElse() || Guard->getInit() || Guard->getConditionVariable() ||
+      Guard->getLocStart().isMacroID() || Guard->getLocEnd().isMacroID())
+    return FixItHint();
+  const Stmt *Then = Guard->getThen();
+  const auto *Compound = dyn_cast<CompoundStmt>(Then);
+  if (Compound) {
+    if (Compound->size() != 1)
+      return FixItHint();
+    Then = Compound->body_front();
+  }
+  const auto *Insertion = dyn_cast<Expr>(Then);
+  if (!Insertion)
+    return FixItHint();
+  Insertion = Insertion->IgnoreImplicit();
+
+  std::string Replacement;
+  if (Insertion == Lookup) {
+    if (isa<CXXOperatorCallExpr>(Lookup))
+      return FixItHint();
+    for (const Expr *Arg : Lookup->arguments())
+      if (Arg->HasSideEffects(Context))
+        return FixItHint();
+    Replacement = getText(Lookup, Context);
+  } else {
+    // 'm[k] = v'.
+    const Expr *Target = nullptr, *Value = nullptr;
+    if (const auto *Assign = dyn_cast<BinaryOperator>(Insertion)) {
+      if (Assign->getOpcode() == BO_Assign) {
+        Target = Assign->getLHS();
+        Value = Assign->getRHS();
+      }
+    } else if (const auto *Assign = dyn_cast<CXXOperatorCallExpr>(Insertion)) {
+      if (Assign->getOperator() == OO_Equal && Assign->getNumArgs() == 2) {
+        Target = Assign->getArg(0);
+        Value = Assign->getArg(1);
+      }
+    }
+    if (!Target || Target->IgnoreParenImpCasts() != Lookup ||
+        !isa<CXXOperatorCallExpr>(Lookup) || Value->HasSideEffects(Context))
+      return FixItHint();
+    const auto *Subscript = dyn_cast_or_null<CXXMethodDecl>(
+        Lookup->getDirectCallee());
+    if (!Subscript ||
+        Subscript->getParent()
+            ->lookup(&Context.Idents.get("try_emplace"))
+            .empty())
+      return FixItHint();
+    Replacement = (getText(Lookup->getArg(0), Context) + ".try_emplace(" +
+                   getText(Lookup->getArg(1), Context) + ", " +
+                   getText(Value, Context) + ")")
+                      .str();
+  }
+  // Without braces the semicolon isn't part of the 'if' statement.
+  if (Compound)
+    Replacement += ";";
+  return FixItHint::CreateReplacement(Guard->getSourceRange(), Replacement);
+}
+
+RedundantAssociativeLookupCheck::RedundantAssociativeLookupCheck(
+    StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      AssociativeClasses(utils::options::parseStringList(
+          Options.get("AssociativeClasses", DefaultAssociativeClasses))) {}
+
+void RedundantAssociativeLookupCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "AssociativeClasses",
+                utils::options::serializeStringList(AssociativeClasses));
+}
+
+void RedundantAssociativeLookupCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus)
+    return;
+
+  const auto ContainerDecl = cxxRecordDecl(hasAnyName(SmallVector<StringRef, 4>(
+      AssociativeClasses.begin(), AssociativeClasses.end())));
+  const auto ContainerType = qualType(
+      hasUnqualifiedDesugaredType(recordType(hasDeclaration(ContainerDecl))));
+  // Only local containers are analyzed; other functions can only modify them
+  // if their address escapes, which is checked for each lookup.
+  const auto ContainerRef = declRefExpr(
+      to(varDecl(hasLocalStorage(), unless(hasType(referenceType())))
+             .bind("container")),
+      hasType(ContainerType));
+
+  Finder->addMatcher(
+      expr(anyOf(cxxMemberCallExpr(
+                     on(ContainerRef),
+                     callee(cxxMethodDecl(hasAnyName(
+                         "count", "find", "at", "contains", "insert",
+                         "emplace", "try_emplace")))),
+                 cxxOperatorCallExpr(hasOverloadedOperatorName("[]"),
+                                     hasArgument(0, ignoringParenImpCasts(
+                                                        ContainerRef)))),
+           unless(isInTemplateInstantiation()))
+          .bind("lookup"),
+      this);
+}
+
+const utils::ExprSequence *
+RedundantAssociativeLookupCheck::getSequence(const Stmt *Body,
+                                             ASTContext &Context) {
+  if (Body == SequenceBody)
+    return Sequence.get();
+  SequenceBody = Body;
+  Sequence.reset();
+  CFG::BuildOptions Options;
+  Options.AddImplicitDtors = true;
+  Options.AddTemporaryDtors = true;
+  SequenceCFG = CFG::buildCFG(nullptr, const_cast<Stmt *>(Body), &Context,
+                              Options);
+  if (SequenceCFG)
+    Sequence.reset(new utils::ExprSequence(SequenceCFG.get(), &Context));
+  return Sequence.get();
+}
+
+void RedundantAssociativeLookupCheck::check(
+    const MatchFinder::MatchResult &Result) {
+  ASTContext &Context = *Result.Context;
+  const auto *Lookup = Result.Nodes.getNodeAs<CallExpr>("lookup");
+  const auto *Container = Result.Nodes.getNodeAs<VarDecl>("container");
+
+  const Expr *Key = getLookupKey(Lookup);
+  if (!Key || Key->isValueDependent() || Key->HasSideEffects(Context))
+    return;
+  const FunctionDecl *Function =
+      utils::getSurroundingFunction(Context, *Lookup);
+  if (!Function || !Function->getBody())
+    return;
+  const Stmt *Body = Function->getBody();
+  const utils::ExprSequence *Order = getSequence(Body, Context);
+  if (!Order)
+    return;
+
+  auto ContainerRefs =
+      utils::decl_ref_expr::allDeclRefExprs(*Container, *Body, Context);
+
+  // Find the latest lookup of the same key that is always evaluated before
+  // this one.
+  const CallExpr *Previous = nullptr;
+  for (const DeclRefExpr *Ref : ContainerRefs) {
+    const CallExpr *Call = getContainerCall(Ref, Context);
+    if (!Call || Call == Lookup)
+      continue;
+    CallKind Kind = getCallKind(Call);
+    if (Kind != CallKind::Query && Kind != CallKind::Insertion)
+      continue;
+    const Expr *OtherKey = getLookupKey(Call);
+    if (!OtherKey || !areSameKeys(Key, OtherKey, Context) ||
+        !isEvaluatedBefore(Call, Lookup, /*Unconditional=*/true, *Order,
+                           Context))
+      continue;
+    if (!Previous || Result.SourceManager->isBeforeInTranslationUnit(
+                         Previous->getLocStart(), Call->getLocStart()))
+      Previous = Call;
+  }
+  if (!Previous)
+    return;
+
+  // Bail out if the container or a variable in the key may be modified
+  // between the two lookups.
+  auto MayBeBetween = [&](const Stmt *S) {
+    if (isDescendantOrEqual(S, Previous, Context) ||
+        isDescendantOrEqual(S, Lookup, Context))
+      return false;
+    return !isEvaluatedBefore(S, Previous, /*Unconditional=*/false, *Order,
+                              Context) &&
+           !isEvaluatedBefore(Lookup, S, /*Unconditional=*/false, *Order,
+                              Context);
+  };
+  auto IsModifiedBetween = [&](const VarDecl &Var) {
+    auto ConstRefs = utils::decl_ref_expr::constReferenceDeclRefExprs(
+        Var, *Body, Context);
+    for (const DeclRefExpr *Ref :
+         utils::decl_ref_expr::allDeclRefExprs(Var, *Body, Context))
+      if (isModifyingUse(Ref, ConstRefs, Context) && MayBeBetween(Ref))
+        return true;
+    return false;
+  };
+  if (IsModifiedBetween(*Container))
+    return;
+  // If a pointer or reference to the container is stored somewhere, any call
+  // other than the ones on the container itself or on const objects may
+  // modify it.
+  if (mayEscape(*Container, *Body, Context)) {
+    llvm::SmallPtrSet<const CallExpr *, 8> ContainerCalls;
+    for (const DeclRefExpr *Ref : ContainerRefs)
+      if (const CallExpr *Call = getContainerCall(Ref, Context))
+        ContainerCalls.insert(Call);
+    for (const auto &Match :
+         match(findAll(callExpr().bind("call")), *Body, Context)) {
+      const auto *Call = Match.getNodeAs<CallExpr>("call");
+      const auto *Method =
+          dyn_cast_or_null<CXXMethodDecl>(Call->getDirectCallee());
+      if (!ContainerCalls.count(Call) &&
+          !(Method && Method->isInstance() && Method->isConst()) &&
+          MayBeBetween(Call))
+        return;
+    }
+  }
+  for (const auto &Match :
+       match(findAll(declRefExpr(to(varDecl().bind("var")))), *Key, Context))
+    if (IsModifiedBetween(*Match.getNodeAs<VarDecl>("var")))
+      return;
+
+  StringRef PreviousName = getCalleeName(Previous);
+  StringRef LookupName = getCalleeName(Lookup);
+  SourceLocation Loc = Lookup->getExprLoc();
+  bool PreviousIsCount = PreviousName == "count" || PreviousName == "contains";
+  const Stmt *Guard = nullptr;
+  if (PreviousIsCount && getCallKind(Lookup) == CallKind::Insertion &&
+      isEvaluatedIfKeyMissing(Previous, Lookup, Context, Guard)) {
+    auto Diag = diag(Loc, "redundant lookup of the same key in %0; use "
+                          "'insert' or 'try_emplace', which only insert if "
+                          "the key is missing, instead of checking with '%1' "
+                          "first")
+                << Container << PreviousName;
+    if (const auto *If = dyn_cast<IfStmt>(Guard))
+      Diag << getInsertionFix(If, Lookup, Context);
+  } else if (PreviousIsCount)
+    diag(Loc, "redundant lookup of the same key in %0; use 'find' for the "
+              "previous lookup and reuse the iterator")
+        << Container;
+  else if (getCallKind(Lookup) == CallKind::Insertion &&
+           LookupName != "operator[]")
+    diag(Loc, "redundant lookup of the same key in %0; '%1' doesn't replace "
+              "an existing element and returns its position")
+        << Container << LookupName;
+  else
+    diag(Loc, "redundant lookup of the same key in %0; reuse the result of "
+              "the previous '%1'")
+        << Container << PreviousName;
+  diag(Previous->getExprLoc(), "previous lookup of the key is here",
+       DiagnosticIDs::Note);
+}
+
+void RedundantAssociativeLookupCheck::onEndOfTranslationUnit() {
+  SequenceBody = nullptr;
+  Sequence.reset();
+  SequenceCFG.reset();
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,52 @@
+//===--- RedundantAssociativeLookupCheck.h - clang-tidy----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_REDUNDANT_ASSOCIATIVE_LOOKUP_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_REDUNDANT_ASSOCIATIVE_LOOKUP_H
+
+#include "../ClangTidy.h"
+#include "../utils/ExprSequence.h"
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds repeated lookups of the same key in the same associative container
+/// without a modification of the container or the key in between, e.g.
+/// `if (m.count(k)) use(m[k]);`.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-redundant-associative-lookup.html
+class RedundantAssociativeLookupCheck : public ClangTidyCheck {
+public:
+  RedundantAssociativeLookupCheck(StringRef Name, ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void onEndOfTranslationUnit() override;
+  bool isIndependentOfIncludingFile() const override { return true; }
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  const utils::ExprSequence *getSequence(const Stmt *Body,
+                                         ASTContext &Context);
+
+  const std::vector<std::string> AssociativeClasses;
+
+  // The evaluation order of the function body analyzed last; most lookups are
+  // close to each other.
+  const Stmt *SequenceBody = nullptr;
+  std::unique_ptr<CFG> SequenceCFG;
+  std::unique_ptr<utils::ExprSequence> Sequence;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_REDUNDANT_ASSOCIATIVE_LOOKUP_H
@@ -0,0 +1,202 @@
+//===--- RegexOrLocaleConstructionInLoopCheck.cpp - clang-tidy-------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RegexOrLocaleConstructionInLoopCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/DeclRefExprUtils.h"
+#include "../utils/OptionsUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+static const char DefaultExpensiveTypes[] =
+    "::std::basic_regex;::std::locale;::std::random_device";
+
+// Returns true if \p Ref may modify the variable it refers to.
+static bool isModifyingUse(const DeclRefExpr *Ref, ASTContext &Context) {
+  if (Ref->refersToEnclosingVariableOrCapture())
+    return true;
+  const Expr *E = Ref;
+  auto Node = ast_type_traits::DynTypedNode::create(*E);
+  while (true) {
+    ASTContext::DynTypedNodeList Parents = Context.getParents(Node);
+    if (Parents.empty())
+      return false;
+    if (const auto *Var = Parents[0].get<VarDecl>()) {
+      QualType Type = Var->getType();
+      return Type->isReferenceType() &&
+             !Type.getNonReferenceType().isConstQualified();
+    }
+    const auto *Parent = Parents[0].get<Stmt>();
+    if (!Parent)
+      return false;
+
+    const auto *Cast = dyn_cast<ImplicitCastExpr>(Parent);
+    const auto *Member = dyn_cast<MemberExpr>(Parent);
+    if (isa<ParenExpr>(Parent) || (Cast && Cast->getCastKind() == CK_NoOp) ||
+        (Member && !Member->isArrow()) ||
+        (isa<ArraySubscriptExpr>(Parent) &&
+         cast<ArraySubscriptExpr>(Parent)->getBase() == E)) {
+      E = cast<Expr>(Parent);
+      Node = Parents[0];
+      continue;
+    }
+
+    if (const auto *Op = dyn_cast<BinaryOperator>(Parent))
+      return Op->isAssignmentOp() && Op->getLHS() == E;
+    if (const auto *Op = dyn_cast<UnaryOperator>(Parent))
+      return Op->isIncrementDecrementOp() || Op->getOpcode() == UO_AddrOf;
+    if (const auto *Call = dyn_cast<CXXMemberCallExpr>(Parent)) {
+      if (Call->getImplicitObjectArgument() == E)
+        return !Call->getMethodDecl() || !Call->getMethodDecl()->isConst();
+    }
+    if (const auto *Call = dyn_cast<CXXOperatorCallExpr>(Parent)) {
+      const auto *Method =
+          dyn_cast_or_null<CXXMethodDecl>(Call->getDirectCallee());
+      if (Method && Call->getNumArgs() > 0 && Call->getArg(0) == E)
+        return !Method->isConst();
+    }
+
+    // Passing the variable to a non-const reference parameter.
+    const FunctionDecl *Callee = nullptr;
+    ArrayRef<const Expr *> Args;
+    if (const auto *Call = dyn_cast<CallExpr>(Parent)) {
+      Callee = Call->getDirectCallee();
+      Args = llvm::makeArrayRef(Call->getArgs(), Call->getNumArgs());
+      // Operator methods don't declare the implicit object parameter.
+      if (isa<CXXOperatorCallExpr>(Call) && Callee &&
+          isa<CXXMethodDecl>(Callee))
+        Args = Args.drop_front();
+    } else if (const auto *Construct = dyn_cast<CXXConstructExpr>(Parent)) {
+      Callee = Construct->getConstructor();
+      Args = llvm::makeArrayRef(Construct->getArgs(), Construct->getNumArgs());
+    } else {
+      return false;
+    }
+    if (!Callee)
+      return true;
+    for (unsigned I = 0, N = std::min<unsigned>(Args.size(),
+                                                Callee->getNumParams());
+         I < N; ++I) {
+      if (Args[I] != E)
+        continue;
+      QualType ParamType = Callee->getParamDecl(I)->getType();
+      return ParamType->isReferenceType() &&
+             !ParamType.getNonReferenceType().isConstQualified();
+    }
+    return false;
+  }
+}
+
+// Returns true if the value of \p E doesn't change between the iterations of
+// \p Loop. \p LoopVars are the variables declared inside the loop.
+static bool
+isLoopInvariant(const Stmt *E, const Stmt *Loop,
+                const llvm::SmallPtrSetImpl<const VarDecl *> &LoopVars,
+                ASTContext &Context) {
+  if (isa<CXXThisExpr>(E))
+    return false;
+  if (const auto *Ref = dyn_cast<DeclRefExpr>(E)) {
+    const auto *Var = dyn_cast<VarDecl>(Ref->getDecl());
+    if (!Var)
+      return true;
+    if (LoopVars.count(Var) ||
+        (Var->hasGlobalStorage() && !Var->getType().isConstQualified()))
+      return false;
+    for (const DeclRefExpr *Use :
+         utils::decl_ref_expr::allDeclRefExprs(*Var, *Loop, Context))
+      if (isModifyingUse(Use, Context))
+        return false;
+    return true;
+  }
+  // Calls may return a different value each time, unless they are constexpr
+  // or only read their arguments.
+  if (const auto *Call = dyn_cast<CallExpr>(E)) {
+    const FunctionDecl *Callee = Call->getDirectCallee();
+    const auto *Method = dyn_cast_or_null<CXXMethodDecl>(Callee);
+    if (!Callee ||
+        !(Callee->isConstexpr() || isa<CXXOperatorCallExpr>(Call) ||
+          (Method && Method->isConst())))
+      return false;
+  }
+  for (const Stmt *Child : E->children())
+    if (Child && !isLoopInvariant(Child, Loop, LoopVars, Context))
+      return false;
+  return true;
+}
+
+RegexOrLocaleConstructionInLoopCheck::RegexOrLocaleConstructionInLoopCheck(
+    StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      ExpensiveTypes(utils::options::parseStringList(
+          Options.get("ExpensiveTypes", DefaultExpensiveTypes))) {}
+
+void RegexOrLocaleConstructionInLoopCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "ExpensiveTypes",
+                utils::options::serializeStringList(ExpensiveTypes));
+}
+
+void RegexOrLocaleConstructionInLoopCheck::registerMatchers(
+    MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus || ExpensiveTypes.empty())
+    return;
+
+  const auto ExpensiveType =
+      qualType(hasUnqualifiedDesugaredType(recordType(hasDeclaration(
+          cxxRecordDecl(hasAnyName(SmallVector<StringRef, 8>(
+              ExpensiveTypes.begin(), ExpensiveTypes.end())))))));
+  const auto Loop =
+      stmt(anyOf(forStmt(), cxxForRangeStmt(), whileStmt(), doStmt()));
+  Finder->addMatcher(
+      cxxConstructExpr(hasType(ExpensiveType), hasAncestor(Loop),
+                       unless(isInTemplateInstantiation()))
+          .bind("construct"),
+      this);
+}
+
+void RegexOrLocaleConstructionInLoopCheck::check(
+    const MatchFinder::MatchResult &Result) {
+  const auto *Construct = Result.Nodes.getNodeAs<CXXConstructExpr>("construct");
+  ASTContext &Context = *Result.Context;
+  // Copies and moves of an existing object are not what makes these types
+  // expensive.
+  if (Construct->getConstructor()->isCopyOrMoveConstructor())
+    return;
+  for (const auto &Parent : Context.getParents(*Construct))
+    if (const auto *Var = Parent.get<VarDecl>())
+      if (Var->isStaticLocal())
+        return;
+
+  const Stmt *Loop = utils::getRepeatingLoop(Construct, Context);
+  if (!Loop)
+    return;
+  llvm::SmallPtrSet<const VarDecl *, 8> LoopVars;
+  for (const BoundNodes &Nodes :
+       match(stmt(forEachDescendant(varDecl().bind("var"))), *Loop, Context))
+    LoopVars.insert(Nodes.getNodeAs<VarDecl>("var"));
+  for (const Expr *Arg : Construct->arguments())
+    if (!isLoopInvariant(Arg, Loop, LoopVars, Context))
+      return;
+
+  diag(Construct->getLocStart(),
+       "%0 is constructed in each loop iteration from loop-invariant "
+       "arguments; construct it once before the loop or make it static")
+      << Construct->getType().getUnqualifiedType();
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
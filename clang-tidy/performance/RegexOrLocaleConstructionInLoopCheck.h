@@ -0,0 +1,44 @@
+//===--- RegexOrLocaleConstructionInLoopCheck.h - clang-tidy-----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_REGEX_OR_LOCALE_CONSTRUCTION_IN_LOOP_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_REGEX_OR_LOCALE_CONSTRUCTION_IN_LOOP_H
+
+#include "../ClangTidy.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds objects of expensive to construct types, like `std::regex` or
+/// `std::locale`, which are constructed in each iteration of a loop from
+/// loop-invariant arguments.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-regex-or-locale-construction-in-loop.html
+class RegexOrLocaleConstructionInLoopCheck : public ClangTidyCheck {
+public:
+  RegexOrLocaleConstructionInLoopCheck(StringRef Name,
+                                       ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  const std::vector<std::string> ExpensiveTypes;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_REGEX_OR_LOCALE_CONSTRUCTION_IN_LOOP_H
@@ -0,0 +1,336 @@
+//===--- SmallFixedSizeContainerCheck.cpp - clang-tidy---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "SmallFixedSizeContainerCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/DeclRefExprUtils.h"
+#include "../utils/LoopTripCount.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/StringSwitch.h"
+#include <algorithm>
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+namespace {
+
+// How a use of the vector relates to its size.
+enum UseKind {
+  // Any other use, e.g. passing the vector to a function.
+  UK_Other,
+  // Reads the elements or the size, which both replacements support.
+  UK_Read,
+  // Returns an iterator, whose type changes with the replacement.
+  UK_Iterate,
+  // Adds an element: 'push_back' and 'emplace_back'.
+  UK_Append,
+  // Methods which only a small vector type supports, e.g. 'pop_back'.
+  UK_VectorOnly,
+};
+
+} // namespace
+
+// Upper bound of the number of elements, to avoid overflows when multiplying
+// trip counts.
+static const uint64_t MaxBound = 1 << 20;
+
+// Returns true if the iterator \p E initializes a variable whose type is
+// spelled out, e.g. 'std::vector<int>::iterator It = V.begin();'.
+static bool isStoredInSpelledType(const Expr *E, ASTContext &Context) {
+  while (true) {
+    ASTContext::DynTypedNodeList Parents = Context.getParents(*E);
+    if (Parents.empty())
+      return false;
+    if (const auto *Var = Parents[0].get<VarDecl>())
+      return !Var->getType()->getContainedAutoType();
+    const auto *Parent = Parents[0].get<Expr>();
+    const auto *Construct = dyn_cast_or_null<CXXConstructExpr>(Parent);
+    if (!Parent ||
+        !(isa<ImplicitCastExpr>(Parent) ||
+          isa<MaterializeTemporaryExpr>(Parent) ||
+          isa<CXXBindTemporaryExpr>(Parent) || isa<ExprWithCleanups>(Parent) ||
+          (Construct && Construct->getNumArgs() == 1)))
+      return false;
+    E = Parent;
+  }
+}
+
+static UseKind getUseKind(const DeclRefExpr *Ref,
+                          const CXXMemberCallExpr *&Call,
+                          ASTContext &Context) {
+  const Expr *E = Ref;
+  ASTContext::DynTypedNodeList Parents = Context.getParents(*E);
+  while (!Parents.empty()) {
+    const auto *Parent = Parents[0].get<Expr>();
+    const auto *Cast = dyn_cast_or_null<ImplicitCastExpr>(Parent);
+    if (!Parent ||
+        !(isa<ParenExpr>(Parent) || (Cast && Cast->getCastKind() == CK_NoOp)))
+      break;
+    E = Parent;
+    Parents = Context.getParents(*E);
+  }
+  if (Parents.empty())
+    return UK_Other;
+
+  // Range-based for loops bind the range to an implicit reference.
+  if (const auto *Range = Parents[0].get<VarDecl>())
+    return Range->isImplicit() ? UK_Read : UK_Other;
+  if (const auto *Operator = Parents[0].get<CXXOperatorCallExpr>())
+    return Operator->getOperator() == OO_Subscript &&
+                   Operator->getArg(0) == E
+               ? UK_Read
+               : UK_Other;
+
+  const auto *Member = Parents[0].get<MemberExpr>();
+  if (!Member || Member->isArrow())
+    return UK_Other;
+  Parents = Context.getParents(*Member);
+  Call = Parents.empty() ? nullptr : Parents[0].get<CXXMemberCallExpr>();
+  if (!Call || Call->getCallee()->IgnoreParens() != Member ||
+      !Call->getMethodDecl() ||
+      !Call->getMethodDecl()->getDeclName().isIdentifier())
+    return UK_Other;
+  return llvm::StringSwitch<UseKind>(Call->getMethodDecl()->getName())
+      .Cases("size", "empty", "max_size", "front", "back", UK_Read)
+      .Cases("at", "data", UK_Read)
+      .Cases("begin", "end", "cbegin", "cend", UK_Iterate)
+      .Cases("rbegin", "rend", "crbegin", "crend", UK_Iterate)
+      .Cases("push_back", "emplace_back", UK_Append)
+      .Cases("pop_back", "clear", "reserve", "capacity", UK_VectorOnly)
+      .Default(UK_Other);
+}
+
+static llvm::Optional<uint64_t> getConstantTripCount(const Stmt &Loop,
+                                                     ASTContext &Context) {
+  llvm::Optional<utils::LoopTripCount> TripCount =
+      utils::getLoopTripCount(Loop, Context);
+  if (!TripCount)
+    return llvm::None;
+  if (const ConstantArrayType *Array =
+          Context.getAsConstantArrayType(TripCount->Bound->getType()))
+    return Array->getSize().getLimitedValue(MaxBound);
+  llvm::APSInt Value;
+  if (!TripCount->Bound->EvaluateAsInt(Value, Context) || Value.isNegative())
+    return llvm::None;
+  return Value.getLimitedValue(MaxBound);
+}
+
+// Returns how often \p S is executed during one execution of \p Scope, if
+// this is bounded by constant trip counts of the loops around \p S.
+static llvm::Optional<uint64_t> getExecutionCount(const Stmt *S,
+                                                  const Stmt *Scope,
+                                                  ASTContext &Context) {
+  uint64_t Count = 1;
+  for (const Stmt *Parent = utils::getParentStmt(S, Context); Parent;
+       S = Parent, Parent = utils::getParentStmt(Parent, Context)) {
+    if (Parent == Scope)
+      return Count;
+    if (isa<LambdaExpr>(Parent) || isa<WhileStmt>(Parent) ||
+        isa<DoStmt>(Parent))
+      return llvm::None;
+    const Stmt *Body = nullptr;
+    if (const auto *For = dyn_cast<ForStmt>(Parent))
+      Body = For->getBody();
+    else if (const auto *RangeFor = dyn_cast<CXXForRangeStmt>(Parent))
+      Body = RangeFor->getBody();
+    else
+      continue;
+    llvm::Optional<uint64_t> TripCount = getConstantTripCount(*Parent, Context);
+    if (S != Body || !TripCount)
+      return llvm::None;
+    Count = std::min(Count * *TripCount, MaxBound);
+  }
+  return llvm::None;
+}
+
+SmallFixedSizeContainerCheck::SmallFixedSizeContainerCheck(
+    StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      SmallVectorType(Options.get("SmallVectorType", "")),
+      SmallVectorHeader(Options.get("SmallVectorHeader", "")),
+      MaxStorageSize(Options.get("MaxStorageSize", 1024U)),
+      IncludeStyle(utils::IncludeSorter::parseIncludeStyle(
+          Options.get("IncludeStyle", "llvm"))) {}
+
+void SmallFixedSizeContainerCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "SmallVectorType", SmallVectorType);
+  Options.store(Opts, "SmallVectorHeader", SmallVectorHeader);
+  Options.store(Opts, "MaxStorageSize", MaxStorageSize);
+  Options.store(Opts, "IncludeStyle",
+                utils::IncludeSorter::toString(IncludeStyle));
+}
+
+void SmallFixedSizeContainerCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus11)
+    return;
+
+  const auto VectorType = qualType(hasUnqualifiedDesugaredType(
+      recordType(hasDeclaration(classTemplateSpecializationDecl(
+          hasName("::std::vector"), templateArgumentCountIs(2))))));
+  Finder->addMatcher(
+      varDecl(hasLocalStorage(), unless(parmVarDecl()),
+              unless(isInTemplateInstantiation()), hasType(VectorType),
+              hasParent(declStmt(hasParent(compoundStmt().bind("scope")))
+                            .bind("decl_stmt")))
+          .bind("var"),
+      this);
+}
+
+void SmallFixedSizeContainerCheck::check(
+    const MatchFinder::MatchResult &Result) {
+  const auto *Var = Result.Nodes.getNodeAs<VarDecl>("var");
+  const auto *DeclStatement = Result.Nodes.getNodeAs<DeclStmt>("decl_stmt");
+  const auto *Scope = Result.Nodes.getNodeAs<CompoundStmt>("scope");
+  ASTContext &Context = *Result.Context;
+  if (!DeclStatement->isSingleDecl() || Var->getLocation().isMacroID() ||
+      !Var->getInit())
+    return;
+
+  const auto *Vector = cast<ClassTemplateSpecializationDecl>(
+      Var->getType()->getAsCXXRecordDecl());
+  QualType Element = Vector->getTemplateArgs()[0].getAsType();
+  const CXXRecordDecl *Allocator =
+      Vector->getTemplateArgs()[1].getAsType()->getAsCXXRecordDecl();
+  if (Element.isNull() || Element->isDependentType() ||
+      Element->isIncompleteType() || Element->isBooleanType() || !Allocator ||
+      Allocator->getName() != "allocator" || !Allocator->isInStdNamespace())
+    return;
+
+  // The number of elements the vector is constructed with.
+  const auto *Construct =
+      dyn_cast<CXXConstructExpr>(Var->getInit()->IgnoreImplicit());
+  if (!Construct)
+    return;
+  ArrayRef<const Expr *> Args(Construct->getArgs(), Construct->getNumArgs());
+  while (!Args.empty() && isa<CXXDefaultArgExpr>(Args.back()))
+    Args = Args.drop_back();
+  uint64_t Bound = 0;
+  bool IsListInit = false;
+  if (!Args.empty()) {
+    const auto *List =
+        dyn_cast<CXXStdInitializerListExpr>(Args[0]->IgnoreImplicit());
+    llvm::APSInt Size;
+    if (List && Args.size() == 1) {
+      const auto *Inits =
+          dyn_cast<InitListExpr>(List->getSubExpr()->IgnoreImplicit());
+      if (!Inits)
+        return;
+      Bound = Inits->getNumInits();
+      IsListInit = true;
+    } else if (Args.size() <= 2 &&
+               Construct->getConstructor()
+                   ->getParamDecl(0)
+                   ->getType()
+                   ->isIntegerType() &&
+               Args[0]->EvaluateAsInt(Size, Context) && !Size.isNegative()) {
+      Bound = Size.getLimitedValue(MaxBound);
+    } else {
+      return;
+    }
+  }
+
+  // Add the elements appended by each use.
+  const FunctionDecl *Function = utils::getSurroundingFunction(Context, *Scope);
+  if (!Function || !Function->getBody())
+    return;
+  bool IsResized = false;
+  for (const DeclRefExpr *Ref : utils::decl_ref_expr::allDeclRefExprs(
+           *Var, *Function->getBody(), Context)) {
+    if (Ref->refersToEnclosingVariableOrCapture())
+      return;
+    const CXXMemberCallExpr *Call = nullptr;
+    switch (getUseKind(Ref, Call, Context)) {
+    case UK_Other:
+      return;
+    case UK_Read:
+      break;
+    case UK_Iterate:
+      if (isStoredInSpelledType(Call, Context))
+        return;
+      break;
+    case UK_Append: {
+      llvm::Optional<uint64_t> Count = getExecutionCount(Call, Scope, Context);
+      if (!Count)
+        return;
+      Bound = std::min(Bound + *Count, MaxBound);
+      IsResized = true;
+      break;
+    }
+    case UK_VectorOnly:
+      IsResized = true;
+      break;
+    }
+  }
+
+  // A vector which keeps the elements of its initializer list can be an
+  // array; other vectors need a type supporting a variable size.
+  const bool IsArray = IsListInit && !IsResized;
+  if (Bound == 0 || (!IsArray && SmallVectorType.empty()) ||
+      Bound * Context.getTypeSizeInChars(Element).getQuantity() >
+          MaxStorageSize)
+    return;
+  const std::string NewType = IsArray ? "std::array" : SmallVectorType;
+
+  auto Diag = diag(Var->getLocation(),
+                   "%0 never holds more than %1 element%s1 but allocates them "
+                   "on the heap; consider using '%2'")
+              << Var << static_cast<unsigned>(Bound)
+              << (llvm::Twine(NewType) + "<" +
+                  Element.getAsString(Context.getPrintingPolicy()) + ", " +
+                  llvm::Twine(Bound) + ">")
+                     .str();
+
+  // Replace the type if it is spelled as 'std::vector<T>'.
+  TypeLoc Loc = Var->getTypeSourceInfo()->getTypeLoc().getUnqualifiedLoc();
+  SourceRange TypeRange = Loc.getSourceRange();
+  if (auto Elaborated = Loc.getAs<ElaboratedTypeLoc>())
+    Loc = Elaborated.getNamedTypeLoc();
+  auto TemplateLoc = Loc.getAs<TemplateSpecializationTypeLoc>();
+  if (!TemplateLoc || TemplateLoc.getNumArgs() != 1 ||
+      TypeRange.getBegin().isMacroID() || TypeRange.getEnd().isMacroID())
+    return;
+  StringRef ElementText = Lexer::getSourceText(
+      CharSourceRange::getTokenRange(
+          TemplateLoc.getArgLoc(0).getSourceRange()),
+      *Result.SourceManager, getLangOpts());
+  if (ElementText.empty())
+    return;
+  Diag << FixItHint::CreateReplacement(
+      TypeRange,
+      (llvm::Twine(NewType) + "<" + ElementText + ", " + llvm::Twine(Bound) +
+       ">")
+          .str());
+
+  StringRef Header = IsArray ? "array" : StringRef(SmallVectorHeader);
+  if (!Header.empty()) {
+    if (auto IncludeFixit = Inserter->CreateIncludeInsertion(
+            Result.SourceManager->getFileID(Var->getLocStart()), Header,
+            /*IsAngled=*/IsArray))
+      Diag << *IncludeFixit;
+  }
+}
+
+void SmallFixedSizeContainerCheck::registerPPCallbacks(
+    CompilerInstance &Compiler) {
+  Inserter.reset(new utils::IncludeInserter(
+      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
+  Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,47 @@
+//===--- SmallFixedSizeContainerCheck.h - clang-tidy-------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_SMALL_FIXED_SIZE_CONTAINER_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_SMALL_FIXED_SIZE_CONTAINER_H
+
+#include "../ClangTidy.h"
+#include "../utils/IncludeInserter.h"
+#include <memory>
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds local `std::vector`s which never hold more elements than a small
+/// compile-time bound, and suggests `std::array` or a small vector type with
+/// inline storage instead.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-small-fixed-size-container.html
+class SmallFixedSizeContainerCheck : public ClangTidyCheck {
+public:
+  SmallFixedSizeContainerCheck(StringRef Name, ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void registerPPCallbacks(CompilerInstance &Compiler) override;
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  const std::string SmallVectorType;
+  const std::string SmallVectorHeader;
+  const unsigned MaxStorageSize;
+  std::unique_ptr<utils::IncludeInserter> Inserter;
+  const utils::IncludeSorter::IncludeStyle IncludeStyle;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_SMALL_FIXED_SIZE_CONTAINER_H
@@ -0,0 +1,254 @@
+//===--- StructPaddingCheck.cpp - clang-tidy-------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "StructPaddingCheck.h"
+#include "../../clang-reorder-fields/ReorderFieldsAction.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/RecordLayout.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+namespace {
+
+struct FieldLayout {
+  unsigned Index;
+  CharUnits Size;
+  CharUnits Align;
+};
+
+} // namespace
+
+/// Collects the sizes and alignments of the fields of \p Record.
+///
+/// \returns false if the layout of the record isn't determined by the plain
+/// sizes and alignments of its fields, e.g. for packed records and bit-fields.
+static bool getFieldLayouts(const RecordDecl *Record, const ASTContext &Context,
+                            SmallVectorImpl<FieldLayout> &Fields) {
+  if (Record->hasAttr<PackedAttr>() || Record->hasAttr<MaxFieldAlignmentAttr>())
+    return false;
+  if (const auto *CXXRecord = dyn_cast<CXXRecordDecl>(Record))
+    if (CXXRecord->getNumVBases() > 0)
+      return false;
+  for (const FieldDecl *Field : Record->fields()) {
+    QualType Type = Field->getType();
+    if (Field->isBitField() || Field->hasAttr<PackedAttr>() ||
+        Type->isIncompleteType() || Type->isDependentType())
+      return false;
+    // References are laid out as pointers.
+    if (const auto *Reference = Type->getAs<ReferenceType>())
+      Type = Context.getPointerType(Reference->getPointeeType());
+    Fields.push_back({Field->getFieldIndex(), Context.getTypeSizeInChars(Type),
+                      Context.getDeclAlign(Field)});
+  }
+  return Fields.size() > 1;
+}
+
+/// Returns the size of a record with the fields laid out in the given order
+/// starting at the offset \p Start.
+static CharUnits getLayoutSize(ArrayRef<FieldLayout> Fields, CharUnits Start,
+                               CharUnits RecordAlign) {
+  CharUnits Offset = Start;
+  for (const FieldLayout &Field : Fields)
+    Offset = Offset.alignTo(Field.Align) + Field.Size;
+  return Offset.alignTo(RecordAlign);
+}
+
+/// Returns true if the fields of \p Record can be moved around as a whole,
+/// i.e. each one is declared separately and outside of macros.
+static bool canMoveFields(const RecordDecl *Record) {
+  llvm::SmallPtrSet<const void *, 8> Starts;
+  for (const FieldDecl *Field : Record->fields()) {
+    SourceLocation Start = Field->getLocStart();
+    if (Start.isInvalid() || Start.isMacroID() ||
+        !Starts.insert(Start.getPtrEncoding()).second)
+      return false;
+  }
+  return true;
+}
+
+StructPaddingCheck::StructPaddingCheck(StringRef Name,
+                                       ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      MinBytesSaved(Options.get("MinBytesSaved", 1U)),
+      MinInstances(Options.get("MinInstances", 0U)) {}
+
+void StructPaddingCheck::storeOptions(ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "MinBytesSaved", MinBytesSaved);
+  Options.store(Opts, "MinInstances", MinInstances);
+}
+
+void StructPaddingCheck::registerMatchers(MatchFinder *Finder) {
+  Finder->addMatcher(
+      recordDecl(isDefinition(), unless(isImplicit()),
+                 unless(isExpansionInSystemHeader()))
+          .bind("record"),
+      this);
+
+  // Counting the objects of each record type is only needed for the
+  // threshold, and it means looking at every declaration.
+  if (MinInstances == 0)
+    return;
+  Finder->addMatcher(varDecl(unless(parmVarDecl())).bind("var"), this);
+  Finder->addMatcher(fieldDecl().bind("field"), this);
+  Finder->addMatcher(cxxNewExpr().bind("new"), this);
+  Finder->addMatcher(classTemplateSpecializationDecl().bind("specialization"),
+                     this);
+}
+
+void StructPaddingCheck::countInstances(QualType Type) {
+  if (Type.isNull())
+    return;
+  uint64_t Count = 1;
+  while (const auto *Array = ASTCtx->getAsConstantArrayType(Type)) {
+    Count =
+        llvm::SaturatingMultiply(Count, Array->getSize().getLimitedValue());
+    Type = Array->getElementType();
+  }
+  const auto *Record = ASTCtx->getBaseElementType(Type)->getAsRecordDecl();
+  if (!Record || !(Record = Record->getDefinition()))
+    return;
+  uint64_t &Total = Instances[Record];
+  Total = llvm::SaturatingAdd(Total, Count);
+}
+
+void StructPaddingCheck::check(const MatchFinder::MatchResult &Result) {
+  ASTCtx = Result.Context;
+
+  if (const auto *Record = Result.Nodes.getNodeAs<RecordDecl>("record")) {
+    if (Record->isUnion() || Record->isInvalidDecl() ||
+        Record->isDependentContext())
+      return;
+    // The layout of an instantiation depends on the template arguments, so
+    // there is no single order to suggest for the pattern.
+    if (const auto *CXXRecord = dyn_cast<CXXRecordDecl>(Record))
+      if (CXXRecord->isLambda() ||
+          clang::isTemplateInstantiation(
+              CXXRecord->getTemplateSpecializationKind()))
+        return;
+    Records.insert(Record);
+    return;
+  }
+
+  if (const auto *Var = Result.Nodes.getNodeAs<VarDecl>("var"))
+    countInstances(Var->getType());
+  else if (const auto *Field = Result.Nodes.getNodeAs<FieldDecl>("field"))
+    countInstances(Field->getType());
+  else if (const auto *New = Result.Nodes.getNodeAs<CXXNewExpr>("new"))
+    countInstances(New->getAllocatedType());
+  else if (const auto *Specialization =
+               Result.Nodes.getNodeAs<ClassTemplateSpecializationDecl>(
+                   "specialization"))
+    for (const TemplateArgument &Arg :
+         Specialization->getTemplateArgs().asArray())
+      if (Arg.getKind() == TemplateArgument::Type)
+        countInstances(Arg.getAsType());
+}
+
+void StructPaddingCheck::diagnose(const RecordDecl *Record) {
+  SmallVector<FieldLayout, 8> Fields;
+  if (!getFieldLayouts(Record, *ASTCtx, Fields))
+    return;
+
+  const ASTRecordLayout &Layout = ASTCtx->getASTRecordLayout(Record);
+  CharUnits Start = ASTCtx->toCharUnitsFromBits(Layout.getFieldOffset(0));
+  // Bail out if the simple model doesn't reproduce the actual layout, e.g.
+  // because the target ABI has additional rules.
+  if (getLayoutSize(Fields, Start, Layout.getAlignment()) != Layout.getSize())
+    return;
+
+  // Laying out the fields by decreasing alignment leaves no gaps between
+  // them, since the size of a type is a multiple of its alignment.
+  SmallVector<FieldLayout, 8> Sorted(Fields.begin(), Fields.end());
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const FieldLayout &LHS, const FieldLayout &RHS) {
+                     return LHS.Align > RHS.Align;
+                   });
+  CharUnits OldSize = Layout.getSize();
+  CharUnits NewSize = getLayoutSize(Sorted, Start, Layout.getAlignment());
+  if (NewSize >= OldSize ||
+      (OldSize - NewSize).getQuantity() < static_cast<int64_t>(MinBytesSaved))
+    return;
+  if (MinInstances > 0 && Instances.lookup(Record) < MinInstances)
+    return;
+
+  SmallVector<unsigned, 8> NewFieldsOrder;
+  for (const FieldLayout &Field : Sorted)
+    NewFieldsOrder.push_back(Field.Index);
+
+  const SourceManager &SM = ASTCtx->getSourceManager();
+  const LangOptions &LangOpts = ASTCtx->getLangOpts();
+  std::vector<FixItHint> Fixes;
+  // Only records whose uses are all visible in this translation unit can be
+  // fixed: the brace initializations of aggregates and the uses of records
+  // defined in headers can be spread over other translation units, which the
+  // fix-it wouldn't update.
+  const auto *CXXRecord = dyn_cast<CXXRecordDecl>(Record);
+  bool CanFix = CXXRecord && !CXXRecord->isAggregate() &&
+                SM.isInMainFile(Record->getLocation()) &&
+                canMoveFields(Record);
+  if (CanFix) {
+    auto Replace = [&](SourceRange Old, SourceRange New) {
+      if (Old.getBegin().isMacroID() || New.getBegin().isMacroID()) {
+        CanFix = false;
+        return;
+      }
+      Fixes.push_back(FixItHint::CreateReplacement(
+          CharSourceRange::getTokenRange(Old),
+          Lexer::getSourceText(CharSourceRange::getTokenRange(New), SM,
+                               LangOpts)));
+    };
+    if (!reorder_fields::reorderFields(CXXRecord, NewFieldsOrder, *ASTCtx,
+                                       Replace, llvm::nulls()))
+      CanFix = false;
+  }
+
+  {
+    auto Diag = diag(Record->getLocation(),
+                     "%0 can shrink from %1 to %2 bytes by reordering its "
+                     "fields")
+                << Record << static_cast<unsigned>(OldSize.getQuantity())
+                << static_cast<unsigned>(NewSize.getQuantity());
+    if (CanFix)
+      for (const FixItHint &Fix : Fixes)
+        Diag << Fix;
+  }
+  if (CanFix)
+    return;
+
+  SmallVector<const FieldDecl *, 8> FieldDecls(Record->field_begin(),
+                                               Record->field_end());
+  std::string Order;
+  for (unsigned Index : NewFieldsOrder) {
+    if (!Order.empty())
+      Order += ", ";
+    Order += FieldDecls[Index]->getName();
+  }
+  diag(Record->getLocation(), "suggested field order: %0", DiagnosticIDs::Note)
+      << Order;
+}
+
+void StructPaddingCheck::onEndOfTranslationUnit() {
+  for (const RecordDecl *Record : Records)
+    diagnose(Record);
+  Records.clear();
+  Instances.clear();
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
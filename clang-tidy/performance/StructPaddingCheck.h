@@ -0,0 +1,50 @@
+//===--- StructPaddingCheck.h - clang-tidy-----------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_STRUCT_PADDING_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_STRUCT_PADDING_H
+
+#include "../ClangTidy.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds records whose size can be reduced by reordering their fields to
+/// avoid padding, and suggests the order which minimizes the size.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-struct-padding.html
+class StructPaddingCheck : public ClangTidyCheck {
+public:
+  StructPaddingCheck(StringRef Name, ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void onEndOfTranslationUnit() override;
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  void countInstances(QualType Type);
+  void diagnose(const RecordDecl *Record);
+
+  const unsigned MinBytesSaved;
+  const unsigned MinInstances;
+
+  ASTContext *ASTCtx = nullptr;
+  llvm::SetVector<const RecordDecl *> Records;
+  llvm::DenseMap<const RecordDecl *, uint64_t> Instances;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_STRUCT_PADDING_H
@@ -0,0 +1,164 @@
+//===--- TemporaryStringMaterializationCheck.cpp - clang-tidy--------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TemporaryStringMaterializationCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/OptionsUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+enum SourceKind { SK_Conversion, SK_Substring };
+
+// Skips the constness conversion and the destructor binding of the temporary.
+static const Expr *ignoreTemporaryWrappers(const Expr *E) {
+  while (true) {
+    if (const auto *Bind = dyn_cast<CXXBindTemporaryExpr>(E))
+      E = Bind->getSubExpr();
+    else if (const auto *Cast = dyn_cast<ImplicitCastExpr>(E)) {
+      if (Cast->getCastKind() != CK_NoOp)
+        return E;
+      E = Cast->getSubExpr();
+    } else
+      return E;
+  }
+}
+
+// Returns the expression the temporary string \p Temporary is created from,
+// if it is created by an implicit conversion or a call to `substr()`.
+static const Expr *getStringSource(const Expr *Temporary, SourceKind &Kind) {
+  const Expr *E = ignoreTemporaryWrappers(Temporary);
+  if (const auto *Call = dyn_cast<CXXMemberCallExpr>(E)) {
+    const CXXMethodDecl *Method = Call->getMethodDecl();
+    if (!Method || !Method->getDeclName().isIdentifier() ||
+        Method->getName() != "substr")
+      return nullptr;
+    Kind = SK_Substring;
+    return Call;
+  }
+
+  const auto *Cast = dyn_cast<ImplicitCastExpr>(E);
+  if (!Cast)
+    return nullptr;
+  const Expr *Conversion = ignoreTemporaryWrappers(Cast->getSubExpr());
+  Kind = SK_Conversion;
+  // `std::string(const char *)` and other converting constructors.
+  if (Cast->getCastKind() == CK_ConstructorConversion) {
+    const auto *Construct = dyn_cast<CXXConstructExpr>(Conversion);
+    if (!Construct || Construct->getNumArgs() == 0)
+      return nullptr;
+    return Construct->getArg(0);
+  }
+  // Conversion operators of string view classes.
+  if (Cast->getCastKind() == CK_UserDefinedConversion) {
+    const auto *Call = dyn_cast<CXXMemberCallExpr>(Conversion);
+    if (!Call || !isa<CXXConversionDecl>(Call->getMethodDecl()))
+      return nullptr;
+    return Call->getImplicitObjectArgument();
+  }
+  return nullptr;
+}
+
+TemporaryStringMaterializationCheck::TemporaryStringMaterializationCheck(
+    StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      HotFunctions(
+          utils::options::parseStringList(Options.get("HotFunctions", ""))) {
+  for (const std::string &Function : HotFunctions)
+    HotFunctionRegexes.emplace_back(Function);
+}
+
+void TemporaryStringMaterializationCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "HotFunctions",
+                utils::options::serializeStringList(HotFunctions));
+}
+
+void TemporaryStringMaterializationCheck::registerMatchers(
+    MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus)
+    return;
+
+  const auto StringType = qualType(hasUnqualifiedDesugaredType(recordType(
+      hasDeclaration(cxxRecordDecl(hasName("::std::basic_string"))))));
+  const auto ConstStringRefParam =
+      parmVarDecl(hasType(lValueReferenceType(
+                      pointee(qualType(isConstQualified(), StringType)))))
+          .bind("param");
+  const auto Temporary = materializeTemporaryExpr().bind("temporary");
+  Finder->addMatcher(
+      callExpr(forEachArgumentWithParam(Temporary, ConstStringRefParam),
+               unless(isInTemplateInstantiation()))
+          .bind("call"),
+      this);
+  Finder->addMatcher(
+      cxxConstructExpr(forEachArgumentWithParam(Temporary, ConstStringRefParam),
+                       unless(isInTemplateInstantiation()))
+          .bind("call"),
+      this);
+}
+
+bool TemporaryStringMaterializationCheck::isHotFunction(
+    const FunctionDecl *Function) const {
+  if (!Function)
+    return false;
+  std::string Name = Function->getQualifiedNameAsString();
+  for (const llvm::Regex &Hot : HotFunctionRegexes)
+    if (Hot.match(Name))
+      return true;
+  return false;
+}
+
+void TemporaryStringMaterializationCheck::check(
+    const MatchFinder::MatchResult &Result) {
+  const auto *Call = Result.Nodes.getNodeAs<Expr>("call");
+  const auto *Temporary =
+      Result.Nodes.getNodeAs<MaterializeTemporaryExpr>("temporary");
+  const auto *Param = Result.Nodes.getNodeAs<ParmVarDecl>("param");
+  ASTContext &Context = *Result.Context;
+
+  SourceKind Kind;
+  const Expr *Source = getStringSource(Temporary->GetTemporaryExpr(), Kind);
+  if (!Source)
+    return;
+
+  // Only the callee can offer an overload taking a string view, so skip
+  // library functions and the members of the string itself.
+  const auto *Callee = dyn_cast<FunctionDecl>(Param->getDeclContext());
+  if (!Callee || Result.SourceManager->isInSystemHeader(Callee->getLocation()))
+    return;
+  if (const auto *Method = dyn_cast<CXXMethodDecl>(Callee)) {
+    if (Method->getParent()->getQualifiedNameAsString() ==
+        "std::basic_string")
+      return;
+  }
+
+  if (!utils::getRepeatingLoop(Call, Context) &&
+      !isHotFunction(utils::getSurroundingFunction(Context, *Call)))
+    return;
+
+  SourceLocation Loc =
+      Kind == SK_Substring ? Source->getExprLoc() : Source->getLocStart();
+  diag(Loc,
+       "%select{implicit conversion from %1|'substr' call}0 allocates a "
+       "temporary std::string to bind to the const reference parameter %2 of "
+       "%3; consider a std::string_view overload")
+      << Kind << Source->getType() << Param << Callee;
+  diag(Param->getLocation(), "parameter %0 declared here", DiagnosticIDs::Note)
+      << Param;
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
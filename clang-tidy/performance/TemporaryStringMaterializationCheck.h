@@ -0,0 +1,46 @@
+//===--- TemporaryStringMaterializationCheck.h - clang-tidy------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_TEMPORARY_STRING_MATERIALIZATION_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_TEMPORARY_STRING_MATERIALIZATION_H
+
+#include "../ClangTidy.h"
+#include "llvm/Support/Regex.h"
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// Finds temporary `std::string` objects which are created by an implicit
+/// conversion or a `substr()` call only to bind to a const reference
+/// parameter, inside loops or hot functions.
+///
+/// For the user-facing documentation see:
+/// http://clang.llvm.org/extra/clang-tidy/checks/performance-temporary-string-materialization.html
+class TemporaryStringMaterializationCheck : public ClangTidyCheck {
+public:
+  TemporaryStringMaterializationCheck(StringRef Name,
+                                      ClangTidyContext *Context);
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override;
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isIndependentOfIncludingFile() const override { return true; }
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+
+private:
+  bool isHotFunction(const FunctionDecl *Function) const;
+
+  const std::vector<std::string> HotFunctions;
+  std::vector<llvm::Regex> HotFunctionRegexes;
+};
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_TEMPORARY_STRING_MATERIALIZATION_H
@@ -0,0 +1,391 @@
+//===--- UnnecessaryHeapAllocationCheck.cpp - clang-tidy-------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "UnnecessaryHeapAllocationCheck.h"
+#include "../utils/ASTUtils.h"
+#include "../utils/DeclRefExprUtils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Lex/Lexer.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+// Returns the outermost expression around \p E that only adds parentheses or
+// no-op casts, together with its parent.
+static const Expr *skipParensUpwards(const Expr *E, const Stmt *&Parent,
+                                     ASTContext &Context) {
+  for (Parent = utils::getParentStmt(E, Context); Parent;
+       Parent = utils::getParentStmt(E, Context)) {
+    const auto *Cast = dyn_cast<ImplicitCastExpr>(Parent);
+    if (!isa<ParenExpr>(Parent) &&
+        !(Cast && (Cast->getCastKind() == CK_NoOp ||
+                   Cast->getCastKind() == CK_LValueToRValue)))
+      break;
+    E = cast<Expr>(Parent);
+  }
+  return E;
+}
+
+static bool isMakeUnique(const CallExpr *Call) {
+  const FunctionDecl *Callee = Call->getDirectCallee();
+  return Callee && Callee->getDeclName().isIdentifier() &&
+         Callee->getName() == "make_unique" && Callee->isInStdNamespace();
+}
+
+// Returns the 'new' expression or 'std::make_unique' call initializing a
+// pointer, looking through the construction of a 'std::unique_ptr'.
+static const Expr *getAllocation(const Expr *Init) {
+  while (true) {
+    Init = Init->IgnoreImplicit()->IgnoreParens();
+    const auto *Construct = dyn_cast<CXXConstructExpr>(Init);
+    if (!Construct || Construct->getNumArgs() != 1)
+      break;
+    Init = Construct->getArg(0);
+  }
+  if (isa<CXXNewExpr>(Init))
+    return Init;
+  const auto *Call = dyn_cast<CallExpr>(Init);
+  return Call && isMakeUnique(Call) ? Call : nullptr;
+}
+
+static StringRef getText(SourceRange Range, const ASTContext &Context) {
+  return Lexer::getSourceText(CharSourceRange::getTokenRange(Range),
+                              Context.getSourceManager(),
+                              Context.getLangOpts());
+}
+
+// Returns the range from \p Begin to \p End, extended to the whole line
+// including its line break if there is nothing else on it.
+static CharSourceRange getLineRange(SourceLocation Begin, SourceLocation End,
+                                    const SourceManager &SM) {
+  bool Invalid = false;
+  const char *BeginData = SM.getCharacterData(Begin, &Invalid);
+  if (Invalid)
+    return CharSourceRange::getCharRange(Begin, End);
+  const char *EndData = SM.getCharacterData(End, &Invalid);
+  if (Invalid)
+    return CharSourceRange::getCharRange(Begin, End);
+  StringRef Buffer = SM.getBufferData(SM.getFileID(Begin), &Invalid);
+  if (Invalid)
+    return CharSourceRange::getCharRange(Begin, End);
+
+  const char *LineBegin = BeginData;
+  while (LineBegin > Buffer.begin() &&
+         (LineBegin[-1] == ' ' || LineBegin[-1] == '\t'))
+    --LineBegin;
+  const char *LineEnd = EndData;
+  while (LineEnd < Buffer.end() && (*LineEnd == ' ' || *LineEnd == '\t'))
+    ++LineEnd;
+  if (LineEnd < Buffer.end() && *LineEnd == '\r')
+    ++LineEnd;
+  if ((LineBegin != Buffer.begin() && LineBegin[-1] != '\n') ||
+      LineEnd == Buffer.end() || *LineEnd != '\n')
+    return CharSourceRange::getCharRange(Begin, End);
+  return CharSourceRange::getCharRange(
+      Begin.getLocWithOffset(LineBegin - BeginData),
+      End.getLocWithOffset(LineEnd + 1 - EndData));
+}
+
+// Returns true if the object \p Deref, the result of dereferencing the
+// pointer, is only read, copied or used through its members.
+static bool isLocalObjectUse(const Expr *Deref, ASTContext &Context) {
+  const Stmt *Parent;
+  Deref = skipParensUpwards(Deref, Parent, Context);
+  if (!Parent)
+    return false;
+  if (const auto *Cast = dyn_cast<ImplicitCastExpr>(Deref))
+    return Cast->getCastKind() == CK_LValueToRValue;
+  if (const auto *Member = dyn_cast<MemberExpr>(Parent))
+    return !Member->isArrow();
+  if (const auto *Construct = dyn_cast<CXXConstructExpr>(Parent))
+    return Construct->getConstructor()->isCopyConstructor();
+  if (const auto *Binary = dyn_cast<BinaryOperator>(Parent))
+    return Binary->isAssignmentOp() && Binary->getLHS() == Deref;
+  if (const auto *Operator = dyn_cast<CXXOperatorCallExpr>(Parent))
+    return Operator->getDirectCallee() &&
+           isa<CXXMethodDecl>(Operator->getDirectCallee()) &&
+           Operator->getArg(0) == Deref;
+  return false;
+}
+
+namespace {
+
+// The rewrites of the uses of a pointer to uses of the automatic object.
+struct UseFixes {
+  std::vector<FixItHint> Fixes;
+  unsigned Deletes = 0;
+};
+
+} // namespace
+
+// Adds the fixes turning the use \p Ref of the pointer into a use of the
+// object to \p Fixes. Returns false if the pointer or the object may escape
+// through this use.
+static bool addUseFixes(const DeclRefExpr *Ref, const Stmt *Scope,
+                        ASTContext &Context, UseFixes &Fixes) {
+  if (Ref->refersToEnclosingVariableOrCapture())
+    return false;
+  const Stmt *Parent;
+  const Expr *Pointer = skipParensUpwards(Ref, Parent, Context);
+  if (!Parent)
+    return false;
+
+  // p->member
+  if (const auto *Member = dyn_cast<MemberExpr>(Parent)) {
+    if (!Member->isArrow() || Member->getBase() != Pointer)
+      return false;
+    Fixes.Fixes.push_back(FixItHint::CreateReplacement(
+        CharSourceRange::getTokenRange(Member->getOperatorLoc()), "."));
+    return true;
+  }
+  if (const auto *Operator = dyn_cast<CXXOperatorCallExpr>(Parent)) {
+    if (Operator->getNumArgs() != 1 || Operator->getArg(0) != Pointer)
+      return false;
+    if (Operator->getOperator() == OO_Arrow) {
+      Fixes.Fixes.push_back(FixItHint::CreateReplacement(
+          CharSourceRange::getTokenRange(Operator->getOperatorLoc()), "."));
+      return true;
+    }
+    if (Operator->getOperator() != OO_Star ||
+        !isLocalObjectUse(Operator, Context))
+      return false;
+    Fixes.Fixes.push_back(FixItHint::CreateRemoval(
+        CharSourceRange::getTokenRange(Operator->getOperatorLoc())));
+    return true;
+  }
+  // *p
+  if (const auto *Unary = dyn_cast<UnaryOperator>(Parent)) {
+    if (Unary->getOpcode() != UO_Deref || !isLocalObjectUse(Unary, Context))
+      return false;
+    Fixes.Fixes.push_back(FixItHint::CreateRemoval(
+        CharSourceRange::getTokenRange(Unary->getOperatorLoc())));
+    return true;
+  }
+  // delete p;
+  // The automatic object is destroyed at the end of the scope, so the
+  // 'delete' has to be there as well.
+  if (const auto *Delete = dyn_cast<CXXDeleteExpr>(Parent)) {
+    const auto *Block = cast<CompoundStmt>(Scope);
+    if (Delete->isArrayForm() || Block->body_empty() ||
+        Block->body_back() != Delete)
+      return false;
+    SourceLocation End = Lexer::findLocationAfterToken(
+        Delete->getLocEnd(), tok::semi, Context.getSourceManager(),
+        Context.getLangOpts(), /*SkipTrailingWhitespaceAndNewLine=*/false);
+    if (End.isInvalid() || Delete->getLocStart().isMacroID())
+      return false;
+    Fixes.Fixes.push_back(FixItHint::CreateRemoval(getLineRange(
+        Delete->getLocStart(), End, Context.getSourceManager())));
+    ++Fixes.Deletes;
+    return true;
+  }
+  return false;
+}
+
+// Returns true if \p Args can be spelled as the initializer 'p(Args)' of a
+// variable 'p' without it being parsed as a function declaration.
+static bool canDirectInitialize(ArrayRef<const Expr *> Args) {
+  if (Args.empty())
+    return false;
+  for (const Expr *Arg : Args) {
+    const Expr *Stripped = Arg->IgnoreImplicit()->IgnoreParens();
+    if (isa<CXXTemporaryObjectExpr>(Stripped) ||
+        isa<CXXScalarValueInitExpr>(Stripped))
+      return false;
+  }
+  return true;
+}
+
+// Returns the initializer of the automatic object replacing the allocation,
+// e.g. "(1, 2)" for 'new T(1, 2)', or None if it can't be spelled.
+static llvm::Optional<std::string> getInitializer(const Expr *Allocation,
+                                                  const ASTContext &Context) {
+  if (const auto *Call = dyn_cast<CallExpr>(Allocation)) {
+    ArrayRef<const Expr *> Args(Call->getArgs(), Call->getNumArgs());
+    // Value-initialize, since 'T p();' declares a function.
+    if (Args.empty())
+      return std::string("{}");
+    if (!canDirectInitialize(Args))
+      return llvm::None;
+    return ("(" +
+            getText(SourceRange(Args.front()->getLocStart(),
+                                Args.back()->getLocEnd()),
+                    Context) +
+            ")")
+        .str();
+  }
+
+  const auto *New = cast<CXXNewExpr>(Allocation);
+  const Expr *Init = New->getInitializer();
+  switch (New->getInitializationStyle()) {
+  case CXXNewExpr::NoInit:
+    return std::string();
+  case CXXNewExpr::ListInit:
+    if (const auto *Construct = dyn_cast<CXXConstructExpr>(Init))
+      return getText(Construct->getParenOrBraceRange(), Context).str();
+    return getText(Init->getSourceRange(), Context).str();
+  case CXXNewExpr::CallInit:
+    break;
+  }
+  ArrayRef<const Expr *> Args;
+  if (const auto *Construct = dyn_cast<CXXConstructExpr>(Init)) {
+    Args = llvm::makeArrayRef(Construct->getArgs(), Construct->getNumArgs());
+    while (!Args.empty() && isa<CXXDefaultArgExpr>(Args.back()))
+      Args = Args.drop_back();
+  } else if (!isa<ImplicitValueInitExpr>(Init) &&
+             !isa<CXXScalarValueInitExpr>(Init)) {
+    Args = Init;
+  }
+  if (Args.empty())
+    return std::string("{}");
+  if (!canDirectInitialize(Args))
+    return llvm::None;
+  return getText(New->getDirectInitRange(), Context).str();
+}
+
+// Returns the type of the allocated object as written in the source.
+static StringRef getAllocatedTypeText(const Expr *Allocation,
+                                      const ASTContext &Context) {
+  if (const auto *New = dyn_cast<CXXNewExpr>(Allocation))
+    return getText(
+        New->getAllocatedTypeSourceInfo()->getTypeLoc().getSourceRange(),
+        Context);
+  const auto *Callee = dyn_cast<DeclRefExpr>(
+      cast<CallExpr>(Allocation)->getCallee()->IgnoreImplicit());
+  if (!Callee || Callee->getNumTemplateArgs() != 1)
+    return "";
+  return getText(Callee->getTemplateArgs()[0].getSourceRange(), Context);
+}
+
+UnnecessaryHeapAllocationCheck::UnnecessaryHeapAllocationCheck(
+    StringRef Name, ClangTidyContext *Context)
+    : ClangTidyCheck(Name, Context),
+      MaxObjectSize(Options.get("MaxObjectSize", 1024U)) {}
+
+void UnnecessaryHeapAllocationCheck::storeOptions(
+    ClangTidyOptions::OptionMap &Opts) {
+  Options.store(Opts, "MaxObjectSize", MaxObjectSize);
+}
+
+void UnnecessaryHeapAllocationCheck::registerMatchers(MatchFinder *Finder) {
+  if (!getLangOpts().CPlusPlus)
+    return;
+
+  const auto Allocation =
+      anyOf(cxxNewExpr(),
+            callExpr(callee(functionDecl(hasName("::std::make_unique")))));
+  Finder->addMatcher(
+      varDecl(hasLocalStorage(), unless(parmVarDecl()),
+              unless(isInTemplateInstantiation()),
+              anyOf(hasType(pointerType()),
+                    hasType(cxxRecordDecl(hasName("::std::unique_ptr")))),
+              hasInitializer(
+                  expr(anyOf(Allocation, hasDescendant(Allocation)))),
+              hasParent(declStmt(hasParent(compoundStmt().bind("scope")))
+                            .bind("decl_stmt")))
+          .bind("var"),
+      this);
+}
+
+void UnnecessaryHeapAllocationCheck::check(
+    const MatchFinder::MatchResult &Result) {
+  ASTContext &Context = *Result.Context;
+  const auto *Var = Result.Nodes.getNodeAs<VarDecl>("var");
+  const auto *DeclStatement = Result.Nodes.getNodeAs<DeclStmt>("decl_stmt");
+  const auto *Scope = Result.Nodes.getNodeAs<CompoundStmt>("scope");
+  if (!DeclStatement->isSingleDecl() || Var->getLocation().isMacroID())
+    return;
+
+  const Expr *Allocation = getAllocation(Var->getInit());
+  if (!Allocation)
+    return;
+  const auto *New = dyn_cast<CXXNewExpr>(Allocation);
+  if (New && (New->isArray() || New->getNumPlacementArgs() > 0))
+    return;
+
+  // Find the types of the pointee and the allocated object.
+  QualType Pointee;
+  if (const auto *Pointer = Var->getType()->getAs<PointerType>()) {
+    if (!New)
+      return;
+    Pointee = Pointer->getPointeeType();
+  } else {
+    const auto *UniquePtr = dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+        Var->getType()->getAsCXXRecordDecl());
+    if (!UniquePtr || UniquePtr->getTemplateArgs().size() < 1)
+      return;
+    Pointee = UniquePtr->getTemplateArgs()[0].getAsType();
+  }
+  QualType Allocated;
+  if (New) {
+    Allocated = New->getAllocatedType();
+  } else {
+    const auto *MadePtr = dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+        Allocation->getType()->getAsCXXRecordDecl());
+    if (!MadePtr || MadePtr->getTemplateArgs().size() < 1)
+      return;
+    Allocated = MadePtr->getTemplateArgs()[0].getAsType();
+  }
+  if (Pointee.isNull() || Allocated.isNull() ||
+      !Context.hasSameUnqualifiedType(Pointee, Allocated) ||
+      Allocated->isDependentType() || Allocated->isIncompleteType() ||
+      Allocated->isArrayType() ||
+      Context.getTypeSizeInChars(Allocated).getQuantity() > MaxObjectSize)
+    return;
+  if (const CXXRecordDecl *Record = Allocated->getAsCXXRecordDecl())
+    if (Record->isAbstract())
+      return;
+
+  // Prove that neither the pointer nor the object escapes.
+  const FunctionDecl *Function = utils::getSurroundingFunction(Context, *Scope);
+  if (!Function || !Function->getBody())
+    return;
+  UseFixes Uses;
+  for (const DeclRefExpr *Ref : utils::decl_ref_expr::allDeclRefExprs(
+           *Var, *Function->getBody(), Context))
+    if (!addUseFixes(Ref, Scope, Context, Uses))
+      return;
+  // A raw pointer has to be deleted exactly once at the end of its scope.
+  if (Uses.Deletes != (Var->getType()->isPointerType() ? 1U : 0U))
+    return;
+
+  auto Diag = diag(Var->getLocation(),
+                   "%0 is allocated on the heap but doesn't escape the "
+                   "function; consider declaring it as an automatic object")
+              << Var;
+
+  llvm::Optional<std::string> Initializer =
+      getInitializer(Allocation, Context);
+  StringRef TypeText = getAllocatedTypeText(Allocation, Context);
+  if (!Initializer || TypeText.empty())
+    return;
+  for (const FixItHint &Fix : Uses.Fixes)
+    if (Fix.RemoveRange.getBegin().isMacroID() ||
+        Fix.RemoveRange.getEnd().isMacroID())
+      return;
+  SourceRange DeclRange = Var->getSourceRange();
+  if (DeclRange.getBegin().isMacroID() || DeclRange.getEnd().isMacroID())
+    return;
+
+  std::string Declaration;
+  if (Pointee.isConstQualified() && !Allocated.isConstQualified())
+    Declaration += "const ";
+  Declaration += (TypeText + " " + Var->getName() + *Initializer).str();
+  Diag << FixItHint::CreateReplacement(DeclRange, Declaration);
+  for (const FixItHint &Fix : Uses.Fixes)
+    Diag << Fix;
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
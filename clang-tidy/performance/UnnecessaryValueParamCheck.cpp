@@ -25,12 +25,6 @@ namespace performance {
 
 namespace {
 
-std::string paramNameOrIndex(StringRef Name, size_t Index) {
-  return (Name.empty() ? llvm::Twine('#') + llvm::Twine(Index + 1)
-                       : llvm::Twine('\'') + Name + llvm::Twine('\''))
-      .str();
-}
-
 template <typename S>
 bool isSubset(const S &SubsetCandidate, const S &SupersetCandidate) {
   for (const auto &E : SubsetCandidate)
@@ -39,14 +33,6 @@ bool isSubset(const S &SubsetCandidate, const S &SupersetCandidate) {
   return true;
 }
 
-bool isReferencedOutsideOfCallExpr(const FunctionDecl &Function,
-                                   ASTContext &Context) {
-  auto Matches = match(declRefExpr(to(functionDecl(equalsNode(&Function))),
-                                   unless(hasAncestor(callExpr()))),
-                       Context);
-  return !Matches.empty();
-}
-
 bool hasLoopStmtAncestor(const DeclRefExpr &DeclRef, const Decl &Decl,
                          ASTContext &Context) {
   auto Matches =
@@ -127,15 +113,8 @@ void UnnecessaryValueParamCheck::check(const MatchFinder::MatchResult &Result) {
                             : "the parameter %0 is copied for each "
                               "invocation but only used as a const reference; "
                               "consider making it a const reference")
-      << paramNameOrIndex(Param->getName(), Index);
-  // Do not propose fixes when:
-  // 1. the ParmVarDecl is in a macro, since we cannot place them correctly
-  // 2. the function is virtual as it might break overrides
-  // 3. the function is referenced outside of a call expression within the
-  //    compilation unit as the signature change could introduce build errors.
-  const auto *Method = llvm::dyn_cast<CXXMethodDecl>(Function);
-  if (Param->getLocStart().isMacroID() || (Method && Method->isVirtual()) ||
-      isReferencedOutsideOfCallExpr(*Function, *Result.Context))
+      << utils::fixit::paramNameOrIndex(Param->getName(), Index);
+  if (!utils::fixit::canChangeParamType(*Function, *Param, *Result.Context))
     return;
   for (const auto *FunctionDecl = Function; FunctionDecl != nullptr;
        FunctionDecl = FunctionDecl->getPreviousDecl()) {
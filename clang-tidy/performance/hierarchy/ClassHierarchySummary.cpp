@@ -0,0 +1,144 @@
+//===--- ClassHierarchySummary.cpp - clang-tidy----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ClassHierarchySummary.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/YAMLTraits.h"
+#include <set>
+
+using clang::tidy::performance::ClassSummary;
+using clang::tidy::performance::FinalCandidates;
+
+LLVM_YAML_IS_DOCUMENT_LIST_VECTOR(ClassSummary)
+LLVM_YAML_IS_SEQUENCE_VECTOR(std::string)
+
+namespace llvm {
+namespace yaml {
+
+template <> struct MappingTraits<ClassSummary> {
+  static void mapping(IO &IO, ClassSummary &Class) {
+    IO.mapRequired("Name", Class.Name);
+    IO.mapOptional("Bases", Class.Bases);
+    IO.mapOptional("Methods", Class.Methods);
+    IO.mapOptional("Overridden", Class.Overridden);
+  }
+};
+
+template <> struct MappingTraits<FinalCandidates> {
+  static void mapping(IO &IO, FinalCandidates &Candidates) {
+    IO.mapOptional("Classes", Candidates.Classes);
+    IO.mapOptional("Methods", Candidates.Methods);
+  }
+};
+
+} // namespace yaml
+} // namespace llvm
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+void writeClassSummaries(llvm::raw_ostream &OS,
+                         llvm::ArrayRef<ClassSummary> Classes) {
+  llvm::yaml::Output Out(OS);
+  for (ClassSummary Class : Classes)
+    Out << Class;
+}
+
+bool readClassSummaries(llvm::StringRef Yaml,
+                        std::vector<ClassSummary> &Classes) {
+  llvm::yaml::Input In(Yaml);
+  In >> Classes;
+  return !In.error();
+}
+
+FinalCandidates computeFinalCandidates(llvm::ArrayRef<ClassSummary> Classes) {
+  std::set<std::string> Derived;
+  std::set<std::string> Overridden;
+  for (const ClassSummary &Class : Classes) {
+    Derived.insert(Class.Bases.begin(), Class.Bases.end());
+    Overridden.insert(Class.Overridden.begin(), Class.Overridden.end());
+  }
+
+  std::set<std::string> FinalClasses;
+  std::set<std::string> FinalMethods;
+  for (const ClassSummary &Class : Classes) {
+    // Making the class final covers its methods.
+    if (!Derived.count(Class.Name)) {
+      FinalClasses.insert(Class.Name);
+      continue;
+    }
+    for (const std::string &Method : Class.Methods) {
+      if (!Overridden.count(Method))
+        FinalMethods.insert(Method);
+    }
+  }
+
+  FinalCandidates Candidates;
+  Candidates.Classes.assign(FinalClasses.begin(), FinalClasses.end());
+  Candidates.Methods.assign(FinalMethods.begin(), FinalMethods.end());
+  return Candidates;
+}
+
+void writeFinalCandidates(llvm::raw_ostream &OS,
+                          const FinalCandidates &Candidates) {
+  llvm::yaml::Output Out(OS);
+  FinalCandidates Copy = Candidates;
+  Out << Copy;
+}
+
+bool readFinalCandidates(llvm::StringRef Yaml, FinalCandidates &Candidates) {
+  llvm::yaml::Input In(Yaml);
+  In >> Candidates;
+  return !In.error();
+}
+
+bool mergeClassSummaries(llvm::StringRef SummaryDir,
+                         llvm::StringRef OutputFile) {
+  std::error_code EC;
+  std::vector<ClassSummary> Classes;
+  for (llvm::sys::fs::directory_iterator Dir(SummaryDir, EC), DirEnd;
+       Dir != DirEnd && !EC; Dir.increment(EC)) {
+    // Only read the summaries written by the check.
+    if (llvm::sys::path::extension(Dir->path()) != ".yaml")
+      continue;
+    auto Buffer = llvm::MemoryBuffer::getFile(Dir->path());
+    if (!Buffer) {
+      llvm::errs() << "Can't open " << Dir->path() << "\n";
+      return false;
+    }
+    std::vector<ClassSummary> FileClasses;
+    if (!readClassSummaries(Buffer.get()->getBuffer(), FileClasses)) {
+      llvm::errs() << "Can't parse the class hierarchy summary '"
+                   << Dir->path() << "'\n";
+      return false;
+    }
+    Classes.insert(Classes.end(), FileClasses.begin(), FileClasses.end());
+  }
+  if (EC) {
+    llvm::errs() << "Can't read '" << SummaryDir << "': " << EC.message()
+                 << '\n';
+    return false;
+  }
+
+  llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    llvm::errs() << "Can't open '" << OutputFile << "': " << EC.message()
+                 << '\n';
+    return false;
+  }
+  writeFinalCandidates(OS, computeFinalCandidates(Classes));
+  return true;
+}
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,72 @@
+//===--- ClassHierarchySummary.h - clang-tidy--------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_HIERARCHY_CLASS_HIERARCHY_SUMMARY_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_HIERARCHY_CLASS_HIERARCHY_SUMMARY_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tidy {
+namespace performance {
+
+/// \brief A polymorphic class as seen by one translation unit.
+struct ClassSummary {
+  /// \brief The fully qualified name of the class.
+  std::string Name;
+  /// \brief The fully qualified names of the direct base classes.
+  std::vector<std::string> Bases;
+  /// \brief The virtual methods of the class which could be declared `final`.
+  std::vector<std::string> Methods;
+  /// \brief The methods of base classes which the class overrides.
+  std::vector<std::string> Overridden;
+};
+
+/// \brief The classes and methods which have no derived classes or overriders
+/// in the whole program.
+struct FinalCandidates {
+  std::vector<std::string> Classes;
+  std::vector<std::string> Methods;
+};
+
+/// \brief Writes the class summaries of a translation unit as YAML documents.
+void writeClassSummaries(llvm::raw_ostream &OS,
+                         llvm::ArrayRef<ClassSummary> Classes);
+
+/// \brief Reads class summaries written by `writeClassSummaries`. Returns
+/// false if \p Yaml is malformed.
+bool readClassSummaries(llvm::StringRef Yaml,
+                        std::vector<ClassSummary> &Classes);
+
+/// \brief Computes the final candidates from the summaries of all translation
+/// units. A class may be summarized by several translation units.
+FinalCandidates computeFinalCandidates(llvm::ArrayRef<ClassSummary> Classes);
+
+void writeFinalCandidates(llvm::raw_ostream &OS,
+                          const FinalCandidates &Candidates);
+
+/// \brief Reads final candidates written by `writeFinalCandidates`. Returns
+/// false if \p Yaml is malformed.
+bool readFinalCandidates(llvm::StringRef Yaml, FinalCandidates &Candidates);
+
+/// \brief Merges the class summaries in the `.yaml` files of \p SummaryDir and
+/// writes the final candidates to \p OutputFile. Returns false if a summary
+/// can't be read.
+bool mergeClassSummaries(llvm::StringRef SummaryDir,
+                         llvm::StringRef OutputFile);
+
+} // namespace performance
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_PERFORMANCE_HIERARCHY_CLASS_HIERARCHY_SUMMARY_H
@@ -17,6 +17,7 @@
 
 #include "../ClangTidy.h"
 #include "clang/Tooling/CommonOptionsParser.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Process.h"
 
 using namespace clang::ast_matchers;
@@ -106,6 +107,19 @@ JSON array of objects:
                                        cl::init(""),
                                        cl::cat(ClangTidyCategory));
 
+static cl::opt<bool> DeduplicateHeaders("deduplicate-headers", cl::desc(R"(
+When analyzing several translation units, skip
+code in include-guarded headers that an earlier
+translation unit has already analyzed with the
+same compiler options and configuration, after
+the same headers and with the same definitions
+of the macros the header uses. Only checks that
+don't depend on the including file support
+this.
+)"),
+                                        cl::init(false),
+                                        cl::cat(ClangTidyCategory));
+
 static cl::opt<bool> Fix("fix", cl::desc(R"(
 Apply suggested fixes. Without -fix-errors
 clang-tidy will bail out if any compilation
@@ -181,6 +195,13 @@ report to stderr.
                                         cl::init(false),
                                         cl::cat(ClangTidyCategory));
 
+static cl::opt<bool> MemoryReport("memory-report", cl::desc(R"(
+Sample the memory used by each translation unit
+and print the largest consumers to stderr.
+)"),
+                                  cl::init(false),
+                                  cl::cat(ClangTidyCategory));
+
 static cl::opt<bool> AnalyzeTemporaryDtors("analyze-temporary-dtors",
                                            cl::desc(R"(
 Enable temporary destructor-aware analysis in
@@ -193,12 +214,33 @@ This option overrides the value read from a
 
 static cl::opt<std::string> ExportFixes("export-fixes", cl::desc(R"(
 YAML file to store suggested fixes in. The
-stored fixes can be applied to the input source
-code with clang-apply-replacements.
+fixes of each translation unit are written as a
+separate YAML document as soon as it is
+processed. The stored fixes can be applied to
+the input source code with
+clang-apply-replacements.
 )"),
                                         cl::value_desc("filename"),
                                         cl::cat(ClangTidyCategory));
 
+static cl::opt<std::string> TimingHistory("timing-history", cl::desc(R"(
+File to read and update the time spent on each
+translation unit. Recorded timings are used to
+process the most expensive translation units
+first and to balance -shard by cost.
+)"),
+                                          cl::value_desc("filename"),
+                                          cl::cat(ClangTidyCategory));
+
+static cl::opt<std::string> Shard("shard", cl::desc(R"(
+Process only a part of the input files, given
+as 'i/n' to select the i-th (zero-based) of n
+shards. Files are split by their predicted cost
+from -timing-history rather than by count.
+)"),
+                                  cl::value_desc("i/n"), cl::init(""),
+                                  cl::cat(ClangTidyCategory));
+
 static cl::opt<bool> Quiet("quiet", cl::desc(R"(
 Run clang-tidy in quiet mode. This suppresses
 printing statistics about ignored warnings and
@@ -278,6 +320,39 @@ static void printProfileData(const ProfileData &Profile,
   OS.flush();
 }
 
+static void
+printMemoryUsage(std::vector<TranslationUnitMemoryUsage> MemoryUsage,
+                 llvm::raw_ostream &OS) {
+  // Only the translation units that pushed the peak up are interesting when
+  // hunting down out-of-memory failures, so they go first.
+  std::sort(MemoryUsage.begin(), MemoryUsage.end(),
+            [](const TranslationUnitMemoryUsage &LHS,
+               const TranslationUnitMemoryUsage &RHS) {
+              if (LHS.PeakRSSGrowthBytes != RHS.PeakRSSGrowthBytes)
+                return LHS.PeakRSSGrowthBytes > RHS.PeakRSSGrowthBytes;
+              return LHS.ASTBytes > RHS.ASTBytes;
+            });
+  const size_t MaxEntries = 10;
+  if (MemoryUsage.size() > MaxEntries)
+    MemoryUsage.resize(MaxEntries);
+
+  auto MB = [](size_t Bytes) { return Bytes / (1024.0 * 1024.0); };
+  std::string Line = "===" + std::string(73, '-') + "===\n";
+  OS << Line;
+  OS << "  ---AST MB---  --Source MB-  --Heap MB---  --Peak MB---"
+        "  --- Name ---\n";
+  for (const TranslationUnitMemoryUsage &Usage : MemoryUsage) {
+    OS << llvm::format("  %12.1f  %12.1f  %12.1f  %12.1f  ",
+                       MB(Usage.ASTBytes), MB(Usage.SourceManagerBytes),
+                       MB(Usage.HeapGrowthBytes), MB(Usage.PeakRSSGrowthBytes))
+       << Usage.File << '\n';
+  }
+  OS << llvm::format("Peak resident memory: %.1f MB\n",
+                     MB(getPeakResidentMemory()));
+  OS << Line << "\n";
+  OS.flush();
+}
+
 static std::unique_ptr<ClangTidyOptionsProvider> createOptionsProvider() {
   ClangTidyGlobalOptions GlobalOptions;
   if (std::error_code Err = parseLineFilter(LineFilter, GlobalOptions)) {
@@ -285,6 +360,7 @@ static std::unique_ptr<ClangTidyOptionsProvider> createOptionsProvider() {
     llvm::cl::PrintHelpMessage(/*Hidden=*/false, /*Categorized=*/true);
     return nullptr;
   }
+  GlobalOptions.DeduplicateHeaders = DeduplicateHeaders;
 
   ClangTidyOptions DefaultOptions;
   DefaultOptions.Checks = DefaultChecks;
@@ -401,11 +477,60 @@ static int clangTidyMain(int argc, const char **argv) {
     return 1;
   }
 
+  unsigned ShardIndex = 0;
+  unsigned ShardCount = 1;
+  if (!Shard.empty() && !parseShard(Shard, ShardIndex, ShardCount)) {
+    llvm::errs() << "Error: invalid -shard value '" << Shard
+                 << "', expected 'i/n' with 0 <= i < n.\n";
+    return 1;
+  }
+
+  TranslationUnitTimings History;
+  if (!TimingHistory.empty()) {
+    std::error_code EC = readTimingHistory(TimingHistory, History);
+    if (EC && EC != std::errc::no_such_file_or_directory)
+      llvm::errs() << "Error reading timing history: " << EC.message()
+                   << '\n';
+  }
+  if (!TimingHistory.empty() || ShardCount > 1)
+    PathList = scheduleByCost(PathList, History, ShardIndex, ShardCount);
+
+  // The fixes are streamed to a temporary file next to the export file, which
+  // replaces it only once the run has finished. An existing export file is
+  // kept intact if the run fails.
+  std::unique_ptr<llvm::raw_fd_ostream> ExportFixesOS;
+  SmallString<128> ExportFixesTempPath;
+  if (!ExportFixes.empty()) {
+    int FD;
+    if (std::error_code EC = llvm::sys::fs::createUniqueFile(
+            ExportFixes + "-%%%%%%.tmp", FD, ExportFixesTempPath)) {
+      llvm::errs() << "Error opening output file: " << EC.message() << '\n';
+      return 1;
+    }
+    ExportFixesOS =
+        llvm::make_unique<llvm::raw_fd_ostream>(FD, /*shouldClose=*/true);
+  }
+
   ProfileData Profile;
+  TranslationUnitTimings Timings;
+  std::vector<TranslationUnitMemoryUsage> MemoryUsage;
 
   ClangTidyContext Context(std::move(OwningOptionsProvider));
   runClangTidy(Context, OptionsParser.getCompilations(), PathList,
-               EnableCheckProfile ? &Profile : nullptr);
+               EnableCheckProfile ? &Profile : nullptr,
+               TimingHistory.empty() ? nullptr : &Timings,
+               ExportFixesOS.get(), MemoryReport ? &MemoryUsage : nullptr);
+
+  if (!TimingHistory.empty()) {
+    // Re-read the history to pick up timings of concurrently running shards.
+    TranslationUnitTimings Merged;
+    readTimingHistory(TimingHistory, Merged);
+    for (const auto &Entry : Timings.Seconds)
+      Merged.Seconds[Entry.getKey()] = Entry.getValue();
+    if (std::error_code EC = writeTimingHistory(TimingHistory, Merged))
+      llvm::errs() << "Error writing timing history: " << EC.message()
+                   << '\n';
+  }
   ArrayRef<ClangTidyError> Errors = Context.getErrors();
   bool FoundErrors =
       std::find_if(Errors.begin(), Errors.end(), [](const ClangTidyError &E) {
@@ -419,14 +544,24 @@ static int clangTidyMain(int argc, const char **argv) {
   // -fix-errors implies -fix.
   handleErrors(Context, (FixErrors || Fix) && !DisableFixes, WErrorCount);
 
-  if (!ExportFixes.empty() && !Errors.empty()) {
+  if (ExportFixesOS) {
+    // The fixes have been streamed out during the run. Don't create or
+    // overwrite the export file if there was nothing to export.
+    ExportFixesOS->close();
     std::error_code EC;
-    llvm::raw_fd_ostream OS(ExportFixes, EC, llvm::sys::fs::F_None);
+    if (ExportFixesOS->has_error()) {
+      EC = ExportFixesOS->error();
+      ExportFixesOS->clear_error();
+    }
+    ExportFixesOS.reset();
+    if (!EC && !Errors.empty())
+      EC = llvm::sys::fs::rename(ExportFixesTempPath, ExportFixes);
+    if (EC || Errors.empty())
+      llvm::sys::fs::remove(ExportFixesTempPath);
     if (EC) {
-      llvm::errs() << "Error opening output file: " << EC.message() << '\n';
+      llvm::errs() << "Error writing output file: " << EC.message() << '\n';
       return 1;
     }
-    exportReplacements(FilePath.str(), Errors, OS);
   }
 
   if (!Quiet) {
@@ -440,6 +575,9 @@ static int clangTidyMain(int argc, const char **argv) {
   if (EnableCheckProfile)
     printProfileData(Profile, llvm::errs());
 
+  if (MemoryReport)
+    printMemoryUsage(std::move(MemoryUsage), llvm::errs());
+
   if (WErrorCount) {
     if (!Quiet) {
       StringRef Plural = WErrorCount == 1 ? "" : "s";
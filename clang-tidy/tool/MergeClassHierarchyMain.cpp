@@ -0,0 +1,44 @@
+//===--- MergeClassHierarchyMain.cpp - clang-tidy -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+///  \file This file implements a tool merging the class hierarchy summaries
+///  written by the performance-devirtualization-final check into the list of
+///  classes and methods which can be declared final.
+///
+//===----------------------------------------------------------------------===//
+
+#include "../performance/hierarchy/ClassHierarchySummary.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+static cl::OptionCategory MergeCategory("clang-tidy-merge-class-hierarchy "
+                                        "options");
+
+static cl::opt<std::string> SummaryDir(cl::Positional, cl::Required,
+                                       cl::desc("<summary-dir>"),
+                                       cl::cat(MergeCategory));
+
+static cl::opt<std::string> OutputFile(cl::Positional, cl::Required,
+                                       cl::desc("<output-file>"),
+                                       cl::cat(MergeCategory));
+
+int main(int argc, const char **argv) {
+  cl::HideUnrelatedOptions(MergeCategory);
+  cl::ParseCommandLineOptions(argc, argv, R"(
+Merges the class hierarchy summaries written to <summary-dir> by
+performance-devirtualization-final with the SummaryDirectory option, and
+writes the classes and methods which have no derived classes or overriders
+to <output-file>. Pass it to the check with the HierarchySummary option.
+)");
+
+  return clang::tidy::performance::mergeClassSummaries(SummaryDir, OutputFile)
+             ? 0
+             : 1;
+}
@@ -30,6 +30,10 @@ Example invocations.
     run-clang-tidy.py -fix -checks=-*,llvm-header-guard extra/clang-tidy \
                       -header-filter=extra/clang-tidy
 
+- Run the second of four shards balanced by the timings of previous runs, most
+  expensive files first.
+    run-clang-tidy.py -timing-history=tidy-timings.txt -shard=1/4
+
 Compilation database setup:
 http://clang.llvm.org/docs/HowToSetupToolingForLLVM.html
 """
@@ -46,6 +50,7 @@ import subprocess
 import sys
 import tempfile
 import threading
+import time
 import traceback
 
 
@@ -60,6 +65,91 @@ def find_compilation_database(path):
   return os.path.realpath(result)
 
 
+def timing_history_key(entry):
+  """Returns the key of a compilation database entry in the timing history."""
+  return os.path.normpath(os.path.join(entry['directory'], entry['file']))
+
+
+def read_timing_history(path):
+  """Reads the time in seconds spent on each file from the history file.
+
+  Each line contains the time and the absolute file name separated by a tab,
+  which is the format clang-tidy -timing-history uses as well.
+  """
+  timings = {}
+  if path is None or not os.path.isfile(path):
+    return timings
+  with open(path) as f:
+    for line in f:
+      seconds, _, name = line.rstrip('\r\n').partition('\t')
+      try:
+        if name:
+          timings[name] = float(seconds)
+      except ValueError:
+        pass
+  return timings
+
+
+def write_timing_history(path, timings):
+  """Writes the timings to the history file, merging with existing ones."""
+  merged = read_timing_history(path)
+  merged.update(timings)
+  # Write to a temporary file and rename it, so that concurrently running
+  # shards never read a partially written history.
+  handle, temp_path = tempfile.mkstemp(
+      prefix=os.path.basename(path) + '-', suffix='.tmp',
+      dir=os.path.dirname(os.path.abspath(path)))
+  try:
+    with os.fdopen(handle, 'w') as f:
+      for name in sorted(merged):
+        f.write('%.3f\t%s\n' % (merged[name], name))
+    try:
+      os.rename(temp_path, path)
+    except OSError:
+      # Windows doesn't replace existing files when renaming.
+      os.remove(path)
+      os.rename(temp_path, path)
+  except:
+    if os.path.exists(temp_path):
+      os.remove(temp_path)
+    raise
+
+
+def schedule_by_cost(entries, timings, shard_index, shard_count):
+  """Returns the entries of the given shard, most expensive first.
+
+  Entries are assigned greedily, most expensive first, to the shard with the
+  smallest predicted total cost. Entries without history are assumed to cost
+  the average of the known ones. The assignment only depends on the inputs, so
+  independently started shards agree on it.
+  """
+  known = [timings[timing_history_key(e)] for e in entries
+           if timing_history_key(e) in timings]
+  default_cost = sum(known) / len(known) if known else 1.0
+  costs = [(timings.get(timing_history_key(e), default_cost), e)
+           for e in entries]
+  costs.sort(key=lambda c: (-c[0], timing_history_key(c[1])))
+  shard_costs = [0.0] * shard_count
+  result = []
+  for cost, entry in costs:
+    shard = shard_costs.index(min(shard_costs))
+    shard_costs[shard] += cost
+    if shard == shard_index:
+      result.append(entry)
+  return result
+
+
+def parse_shard(value):
+  """Parses a shard specification of the form 'i/n' with 0 <= i < n."""
+  try:
+    index, count = [int(x) for x in value.split('/')]
+  except ValueError:
+    raise argparse.ArgumentTypeError("expected 'i/n'")
+  if count <= 0 or not 0 <= index < count:
+    raise argparse.ArgumentTypeError("expected 'i/n' with 0 <= i < n")
+  return index, count
+
+
 def get_tidy_invocation(f, clang_tidy_binary, checks, tmpdir, build_path,
                         header_filter, extra_arg, extra_arg_before, quiet):
   """Gets a command line for clang-tidy."""
@@ -111,16 +201,97 @@ def apply_fixes(args, tmpdir):
   subprocess.call(invocation)
 
 
-def run_tidy(args, tmpdir, build_path, queue):
+def resident_memory(pid):
+  """Returns the resident set size of a process in bytes, 0 if the process has
+  already exited, or None if it can't be determined on this platform.
+
+  /proc is used where available. Otherwise ps is asked, which also works on
+  macOS and the BSDs."""
+  if os.path.exists('/proc/self/status'):
+    try:
+      with open('/proc/%d/status' % pid) as f:
+        for line in f:
+          if line.startswith('VmRSS:'):
+            return int(line.split()[1]) * 1024
+    except (IOError, ValueError, IndexError):
+      pass
+    return 0
+  try:
+    with open(os.devnull, 'w') as devnull:
+      output = subprocess.check_output(['ps', '-o', 'rss=', '-p', str(pid)],
+                                       stderr=devnull)
+    return int(output.split()[0]) * 1024
+  except subprocess.CalledProcessError:
+    # ps fails if the process doesn't exist anymore.
+    return 0
+  except (OSError, ValueError, IndexError):
+    return None
+
+
+class MemoryGovernor(object):
+  """Delays starting clang-tidy instances while memory is near the limit.
+
+  A new instance is only started if the memory of the running ones plus the
+  largest instance seen so far fits into the limit. One instance is always
+  allowed to run, so that progress is guaranteed."""
+
+  def __init__(self, limit):
+    self.limit = limit
+    self.lock = threading.Lock()
+    self.processes = set()
+    self.largest = 0
+
+  def _usage(self):
+    total = 0
+    for process in self.processes:
+      rss = resident_memory(process.pid)
+      if rss is None:
+        # Without a way to measure memory, the limit can't be enforced. Warn
+        # once and run as if no limit had been given.
+        sys.stderr.write('warning: cannot determine the memory usage of '
+                         'clang-tidy on this platform; ignoring '
+                         '-memory-limit\n')
+        self.limit = 0
+        return 0
+      self.largest = max(self.largest, rss)
+      total += rss
+    return total
+
+  def call(self, invocation):
+    """Runs invocation once there is enough memory for it.
+
+    Returns the seconds the invocation ran, not counting the time spent
+    waiting for memory."""
+    while True:
+      with self.lock:
+        if (not self.limit or not self.processes or
+            self._usage() + self.largest <= self.limit):
+          start = time.time()
+          process = subprocess.Popen(invocation)
+          self.processes.add(process)
+          break
+      time.sleep(0.5)
+    process.wait()
+    elapsed = time.time() - start
+    with self.lock:
+      self.processes.discard(process)
+    return elapsed
+
+
+def run_tidy(args, tmpdir, build_path, queue, timings, timings_lock,
+             governor):
   """Takes filenames out of queue and runs clang-tidy on them."""
   while True:
-    name = queue.get()
-    invocation = get_tidy_invocation(name, args.clang_tidy_binary, args.checks,
-                                     tmpdir, build_path, args.header_filter,
-                                     args.extra_arg, args.extra_arg_before,
-                                     args.quiet)
+    entry = queue.get()
+    invocation = get_tidy_invocation(entry['file'], args.clang_tidy_binary,
+                                     args.checks, tmpdir, build_path,
+                                     args.header_filter, args.extra_arg,
+                                     args.extra_arg_before, args.quiet)
     sys.stdout.write(' '.join(invocation) + '\n')
-    subprocess.call(invocation)
+    elapsed = governor.call(invocation)
+    with timings_lock:
+      key = timing_history_key(entry)
+      timings[key] = timings.get(key, 0.0) + elapsed
     queue.task_done()
 
 
@@ -164,6 +335,16 @@ def main():
                       'command line.')
   parser.add_argument('-quiet', action='store_true',
                       help='Run clang-tidy in quiet mode')
+  parser.add_argument('-timing-history', metavar='PATH', default=None,
+                      help='file to read and update the time spent on each '
+                      'file; used to run the most expensive files first')
+  parser.add_argument('-shard', type=parse_shard, default=(0, 1),
+                      metavar='i/n',
+                      help='only process the i-th (zero-based) of n shards, '
+                      'balanced by the predicted cost of the files')
+  parser.add_argument('-memory-limit', type=int, default=0, metavar='MB',
+                      help='do not start new clang-tidy instances while the '
+                      'running ones use close to this much memory')
   args = parser.parse_args()
 
   db_path = 'compile_commands.json'
@@ -187,7 +368,6 @@ def main():
 
   # Load the database and extract all files.
   database = json.load(open(os.path.join(build_path, db_path)))
-  files = [entry['file'] for entry in database]
 
   max_task = args.j
   if max_task == 0:
@@ -200,24 +380,37 @@ def main():
 
   # Build up a big regexy filter from all command line arguments.
   file_name_re = re.compile('|'.join(args.files))
+  entries = [entry for entry in database if file_name_re.search(entry['file'])]
+
+  # Start the most expensive files first so that a single slow file doesn't
+  # determine the total wall time, and only keep the files of our shard.
+  history = read_timing_history(args.timing_history)
+  shard_index, shard_count = args.shard
+  entries = schedule_by_cost(entries, history, shard_index, shard_count)
+  timings = {}
+  timings_lock = threading.Lock()
+  governor = MemoryGovernor(args.memory_limit * 1024 * 1024)
 
   try:
     # Spin up a bunch of tidy-launching threads.
     queue = Queue.Queue(max_task)
     for _ in range(max_task):
       t = threading.Thread(target=run_tidy,
-                           args=(args, tmpdir, build_path, queue))
+                           args=(args, tmpdir, build_path, queue, timings,
+                                 timings_lock, governor))
       t.daemon = True
       t.start()
 
     # Fill the queue with files.
-    for name in files:
-      if file_name_re.search(name):
-        queue.put(name)
+    for entry in entries:
+      queue.put(entry)
 
     # Wait for all threads to be done.
     queue.join()
 
+    if args.timing_history:
+      write_timing_history(args.timing_history, timings)
+
   except KeyboardInterrupt:
     # This is a sad hack. Unfortunately subprocess goes
     # bonkers with ctrl-c and we start forking merrily.
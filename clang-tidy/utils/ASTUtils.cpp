@@ -39,6 +39,36 @@ bool IsBinaryOrTernary(const Expr *E) {
   return false;
 }
 
+const Stmt *getParentStmt(const Stmt *S, ASTContext &Context) {
+  ASTContext::DynTypedNodeList Parents = Context.getParents(*S);
+  while (!Parents.empty()) {
+    if (const auto *Parent = Parents[0].get<Stmt>())
+      return Parent;
+    if (!Parents[0].get<VarDecl>())
+      return nullptr;
+    Parents = Context.getParents(Parents[0]);
+  }
+  return nullptr;
+}
+
+const Stmt *getRepeatingLoop(const Stmt *S, ASTContext &Context) {
+  for (const Stmt *Parent = getParentStmt(S, Context); Parent;
+       S = Parent, Parent = getParentStmt(Parent, Context)) {
+    if (isa<LambdaExpr>(Parent))
+      return nullptr;
+    if (const auto *For = dyn_cast<ForStmt>(Parent)) {
+      if (S != For->getInit())
+        return For;
+    } else if (const auto *RangeFor = dyn_cast<CXXForRangeStmt>(Parent)) {
+      if (S == RangeFor->getBody() || S == RangeFor->getLoopVarStmt())
+        return RangeFor;
+    } else if (isa<WhileStmt>(Parent) || isa<DoStmt>(Parent)) {
+      return Parent;
+    }
+  }
+  return nullptr;
+}
+
 } // namespace utils
 } // namespace tidy
 } // namespace clang
@@ -20,6 +20,12 @@ const FunctionDecl *getSurroundingFunction(ASTContext &Context,
                                            const Stmt &Statement);
 // Determine whether Expr is a Binary or Ternary expression.
 bool IsBinaryOrTernary(const Expr *E);
+// Returns the parent statement of \p S, looking through variable
+// declarations, or NULL at the boundary of a function.
+const Stmt *getParentStmt(const Stmt *S, ASTContext &Context);
+// Returns the innermost loop of the function \p S belongs to which executes
+// \p S repeatedly, or NULL.
+const Stmt *getRepeatingLoop(const Stmt *S, ASTContext &Context);
 } // namespace utils
 } // namespace tidy
 } // namespace clang
@@ -10,6 +10,8 @@
 #include "FixItHintUtils.h"
 #include "LexerUtils.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/TypeLoc.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
 
 namespace clang {
 namespace tidy {
@@ -26,10 +28,45 @@ FixItHint changeVarDeclToReference(const VarDecl &Var, ASTContext &Context) {
   return FixItHint::CreateInsertion(AmpLocation, "&");
 }
 
+FixItHint changeVarDeclToValue(const VarDecl &Var) {
+  auto Reference =
+      Var.getTypeSourceInfo()->getTypeLoc().getAs<LValueReferenceTypeLoc>();
+  if (!Reference)
+    return FixItHint();
+  return FixItHint::CreateRemoval(Reference.getSigilLoc());
+}
+
 FixItHint changeVarDeclToConst(const VarDecl &Var) {
   return FixItHint::CreateInsertion(Var.getTypeSpecStartLoc(), "const ");
 }
 
+std::string paramNameOrIndex(StringRef Name, size_t Index) {
+  return (Name.empty() ? llvm::Twine('#') + llvm::Twine(Index + 1)
+                       : llvm::Twine('\'') + Name + llvm::Twine('\''))
+      .str();
+}
+
+static bool isReferencedOutsideOfCallExpr(const FunctionDecl &Function,
+                                          ASTContext &Context) {
+  using namespace ast_matchers;
+  auto Matches = match(declRefExpr(to(functionDecl(equalsNode(&Function))),
+                                   unless(hasAncestor(callExpr()))),
+                       Context);
+  return !Matches.empty();
+}
+
+bool canChangeParamType(const FunctionDecl &Function, const ParmVarDecl &Param,
+                        ASTContext &Context) {
+  // Do not propose fixes when:
+  // 1. the ParmVarDecl is in a macro, since we cannot place them correctly
+  // 2. the function is virtual as it might break overrides
+  // 3. the function is referenced outside of a call expression within the
+  //    compilation unit as the signature change could introduce build errors.
+  const auto *Method = llvm::dyn_cast<CXXMethodDecl>(&Function);
+  return !Param.getLocStart().isMacroID() && !(Method && Method->isVirtual()) &&
+         !isReferencedOutsideOfCallExpr(Function, Context);
+}
+
 } // namespace fixit
 } // namespace utils
 } // namespace tidy
@@ -21,9 +21,26 @@ namespace fixit {
 /// \brief Creates fix to make ``VarDecl`` a reference by adding ``&``.
 FixItHint changeVarDeclToReference(const VarDecl &Var, ASTContext &Context);
 
+/// \brief Creates fix to make the reference ``VarDecl`` a value by removing
+/// ``&``.
+FixItHint changeVarDeclToValue(const VarDecl &Var);
+
 /// \brief Creates fix to make ``VarDecl`` const qualified.
 FixItHint changeVarDeclToConst(const VarDecl &Var);
 
+/// \brief Returns the quoted name of a parameter, or its 1-based index
+/// prefixed with ``#`` if it is unnamed.
+std::string paramNameOrIndex(StringRef Name, size_t Index);
+
+/// \brief Returns true if fixes changing the type of the parameter \p Param
+/// of \p Function in all of its declarations can be proposed.
+///
+/// This is not the case if the parameter is declared in a macro, if the
+/// function is virtual, or if the function is referenced outside of a call
+/// expression within the translation unit.
+bool canChangeParamType(const FunctionDecl &Function, const ParmVarDecl &Param,
+                        ASTContext &Context);
+
 } // namespace fixit
 } // namespace utils
 } // namespace tidy
@@ -0,0 +1,293 @@
+//===--- LoopTripCount.cpp - clang-tidy------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LoopTripCount.h"
+#include "ASTUtils.h"
+#include "DeclRefExprUtils.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include <algorithm>
+
+namespace clang {
+namespace tidy {
+namespace utils {
+using namespace ast_matchers;
+
+// Returns the source text of \p E, or an empty string if \p E is only part of
+// a macro expansion.
+static StringRef getText(const Expr &E, const ASTContext &Context) {
+  CharSourceRange Range = Lexer::makeFileCharRange(
+      CharSourceRange::getTokenRange(E.getSourceRange()),
+      Context.getSourceManager(), Context.getLangOpts());
+  if (Range.isInvalid())
+    return "";
+  return Lexer::getSourceText(Range, Context.getSourceManager(),
+                              Context.getLangOpts());
+}
+
+// Strips implicit nodes and elidable copies of \p E.
+static const Expr *stripElidable(const Expr *E) {
+  E = E->IgnoreImplicit()->IgnoreParens();
+  if (const auto *Construct = dyn_cast<CXXConstructExpr>(E))
+    if (Construct->isElidable() && Construct->getNumArgs() == 1)
+      return Construct->getArg(0)->IgnoreImplicit()->IgnoreParens();
+  return E;
+}
+
+static bool refersTo(const Expr *E, const VarDecl *Var) {
+  const auto *Ref =
+      dyn_cast<DeclRefExpr>(stripElidable(E)->IgnoreParenImpCasts());
+  return Ref && Ref->getDecl() == Var;
+}
+
+static bool references(const Expr &E, const VarDecl &Var,
+                       ASTContext &Context) {
+  return !match(findAll(declRefExpr(to(varDecl(equalsNode(&Var))))), E,
+                Context)
+              .empty();
+}
+
+static bool isIntegerValue(const Expr *E, int64_t Value,
+                           const ASTContext &Context) {
+  llvm::APSInt Result;
+  return !E->isValueDependent() && E->EvaluateAsInt(Result, Context) &&
+         Result == Value;
+}
+
+// Returns the operands of \p E if it's a built-in or overloaded binary
+// operator of kind \p Kind.
+static bool getOperands(const Expr *E, BinaryOperatorKind Kind,
+                        const Expr *&LHS, const Expr *&RHS) {
+  E = E->IgnoreImplicit()->IgnoreParens();
+  if (const auto *Operator = dyn_cast<BinaryOperator>(E)) {
+    if (Operator->getOpcode() != Kind)
+      return false;
+    LHS = Operator->getLHS();
+    RHS = Operator->getRHS();
+    return true;
+  }
+  if (const auto *Call = dyn_cast<CXXOperatorCallExpr>(E)) {
+    if (Call->getNumArgs() != 2 ||
+        Call->getOperator() != BinaryOperator::getOverloadedOperator(Kind))
+      return false;
+    LHS = Call->getArg(0);
+    RHS = Call->getArg(1);
+    return true;
+  }
+  return false;
+}
+
+// Returns true if \p E increments (or decrements) \p Var by one.
+static bool isStep(const Expr *E, const VarDecl *Var, bool Increment,
+                   const ASTContext &Context) {
+  E = E->IgnoreImplicit()->IgnoreParens();
+  if (const auto *Operator = dyn_cast<UnaryOperator>(E))
+    return (Increment ? Operator->isIncrementOp()
+                      : Operator->isDecrementOp()) &&
+           refersTo(Operator->getSubExpr(), Var);
+  if (const auto *Call = dyn_cast<CXXOperatorCallExpr>(E))
+    if (Call->getOperator() == (Increment ? OO_PlusPlus : OO_MinusMinus))
+      return refersTo(Call->getArg(0), Var);
+  const Expr *LHS, *RHS;
+  return getOperands(E, Increment ? BO_AddAssign : BO_SubAssign, LHS, RHS) &&
+         refersTo(LHS, Var) && isIntegerValue(RHS, 1, Context);
+}
+
+// Returns the variable initialized by the init statement of a 'for' loop
+// together with its initial value.
+static const VarDecl *getCounter(const Stmt *Init, const Expr *&InitValue) {
+  if (!Init)
+    return nullptr;
+  if (const auto *Decl = dyn_cast<DeclStmt>(Init)) {
+    const auto *Var = Decl->isSingleDecl()
+                          ? dyn_cast<VarDecl>(Decl->getSingleDecl())
+                          : nullptr;
+    if (!Var || !Var->getInit())
+      return nullptr;
+    InitValue = Var->getInit();
+    return Var;
+  }
+  const Expr *LHS, *RHS;
+  if (!isa<Expr>(Init) || !getOperands(cast<Expr>(Init), BO_Assign, LHS, RHS))
+    return nullptr;
+  const auto *Ref = dyn_cast<DeclRefExpr>(LHS->IgnoreParenImpCasts());
+  const auto *Var = Ref ? dyn_cast<VarDecl>(Ref->getDecl()) : nullptr;
+  if (Var)
+    InitValue = RHS;
+  return Var;
+}
+
+static bool hasSizeMethod(const CXXRecordDecl *Record) {
+  if (!Record || !Record->hasDefinition())
+    return false;
+  Record = Record->getDefinition();
+  for (const CXXMethodDecl *Method : Record->methods())
+    if (Method->getDeclName().isIdentifier() && Method->getName() == "size" &&
+        Method->getMinRequiredArguments() == 0)
+      return true;
+  for (const CXXBaseSpecifier &Base : Record->bases())
+    if (hasSizeMethod(Base.getType()->getAsCXXRecordDecl()))
+      return true;
+  return false;
+}
+
+// Returns the call if \p E is a call to one of the methods \p Names without
+// arguments, e.g. 'v.begin()'.
+static const CXXMemberCallExpr *getMethodCall(const Expr *E,
+                                              ArrayRef<StringRef> Names) {
+  const auto *Call = dyn_cast<CXXMemberCallExpr>(stripElidable(E));
+  if (!Call || Call->getNumArgs() != 0)
+    return nullptr;
+  const CXXMethodDecl *Method = Call->getMethodDecl();
+  if (!Method || !Method->getDeclName().isIdentifier() ||
+      std::find(Names.begin(), Names.end(), Method->getName()) == Names.end())
+    return nullptr;
+  return Call;
+}
+
+static bool areSameExprs(const Expr *LHS, const Expr *RHS,
+                         const ASTContext &Context) {
+  llvm::FoldingSetNodeID LHSID, RHSID;
+  LHS->IgnoreParenImpCasts()->Profile(LHSID, Context, /*Canonical=*/true);
+  RHS->IgnoreParenImpCasts()->Profile(RHSID, Context, /*Canonical=*/true);
+  return LHSID == RHSID;
+}
+
+// Handles 'for (auto it = v.begin(); it != v.end(); ++it)'.
+static llvm::Optional<LoopTripCount>
+getIteratorLoopTripCount(const ForStmt &Loop, const VarDecl *Counter,
+                         const Expr *InitValue, ASTContext &Context) {
+  const CXXMemberCallExpr *Begin =
+      getMethodCall(InitValue, {"begin", "cbegin"});
+  const Expr *LHS, *RHS;
+  if (!Begin || !isStep(Loop.getInc(), Counter, /*Increment=*/true, Context) ||
+      !getOperands(Loop.getCond(), BO_NE, LHS, RHS))
+    return llvm::None;
+  if (!refersTo(LHS, Counter))
+    std::swap(LHS, RHS);
+  const CXXMemberCallExpr *End = getMethodCall(RHS, {"end", "cend"});
+  if (!refersTo(LHS, Counter) || !End)
+    return llvm::None;
+
+  const Expr *Container = Begin->getImplicitObjectArgument();
+  if (!areSameExprs(Container, End->getImplicitObjectArgument(), Context) ||
+      Container->HasSideEffects(Context) ||
+      !hasSizeMethod(Begin->getRecordDecl()))
+    return llvm::None;
+  StringRef Text = getText(*Container, Context);
+  if (Text.empty())
+    return llvm::None;
+  bool IsArrow = cast<MemberExpr>(Begin->getCallee())->isArrow();
+  return LoopTripCount{Container,
+                       (Text + (IsArrow ? "->size()" : ".size()")).str()};
+}
+
+static llvm::Optional<LoopTripCount>
+getForLoopTripCount(const ForStmt &Loop, ASTContext &Context) {
+  const Expr *InitValue = nullptr;
+  const VarDecl *Counter = getCounter(Loop.getInit(), InitValue);
+  if (!Counter || !Loop.getCond() || !Loop.getInc() || !Loop.getBody() ||
+      !decl_ref_expr::isOnlyUsedAsConst(*Counter, *Loop.getBody(), Context))
+    return llvm::None;
+  if (!Counter->getType()->isIntegerType())
+    return getIteratorLoopTripCount(Loop, Counter, InitValue, Context);
+
+  const Expr *Cond = Loop.getCond();
+  const Expr *LHS, *RHS;
+  const Expr *Bound = nullptr;
+  if (isStep(Loop.getInc(), Counter, /*Increment=*/true, Context)) {
+    // for (int i = 0; i < n; ++i)
+    if (!isIntegerValue(InitValue, 0, Context))
+      return llvm::None;
+    if ((getOperands(Cond, BO_LT, LHS, RHS) ||
+         getOperands(Cond, BO_NE, LHS, RHS)) &&
+        refersTo(LHS, Counter))
+      Bound = RHS;
+    else if (getOperands(Cond, BO_GT, LHS, RHS) && refersTo(RHS, Counter))
+      Bound = LHS;
+  } else if (isStep(Loop.getInc(), Counter, /*Increment=*/false, Context)) {
+    // for (int i = n; i > 0; --i)
+    if ((getOperands(Cond, BO_GT, LHS, RHS) && refersTo(LHS, Counter) &&
+         isIntegerValue(RHS, 0, Context)) ||
+        (getOperands(Cond, BO_LT, LHS, RHS) && refersTo(RHS, Counter) &&
+         isIntegerValue(LHS, 0, Context)))
+      Bound = InitValue;
+  }
+  if (!Bound || Bound->isValueDependent() || Bound->HasSideEffects(Context) ||
+      references(*Bound, *Counter, Context))
+    return llvm::None;
+  StringRef Text = getText(*Bound, Context);
+  if (Text.empty())
+    return llvm::None;
+  return LoopTripCount{Bound, Text.str()};
+}
+
+static llvm::Optional<LoopTripCount>
+getRangeLoopTripCount(const CXXForRangeStmt &Loop, ASTContext &Context) {
+  const Expr *Range = Loop.getRangeInit();
+  if (!Range)
+    return llvm::None;
+  Range = Range->IgnoreParenImpCasts();
+  // FIXME: Support more complex range expressions.
+  if ((!isa<DeclRefExpr>(Range) && !isa<MemberExpr>(Range)) ||
+      Range->isTypeDependent() || Range->HasSideEffects(Context))
+    return llvm::None;
+  if (const ConstantArrayType *Array =
+          Context.getAsConstantArrayType(Range->getType()))
+    return LoopTripCount{Range, Array->getSize().toString(10, false)};
+  StringRef Text = getText(*Range, Context);
+  if (Text.empty() || !hasSizeMethod(Range->getType()->getAsCXXRecordDecl()))
+    return llvm::None;
+  return LoopTripCount{Range, (Text + ".size()").str()};
+}
+
+llvm::Optional<LoopTripCount> getLoopTripCount(const Stmt &Loop,
+                                               ASTContext &Context) {
+  if (const auto *For = dyn_cast<ForStmt>(&Loop))
+    return getForLoopTripCount(*For, Context);
+  if (const auto *RangeFor = dyn_cast<CXXForRangeStmt>(&Loop))
+    return getRangeLoopTripCount(*RangeFor, Context);
+  return llvm::None;
+}
+
+llvm::Optional<std::string>
+getNestedLoopTripCount(llvm::ArrayRef<const Stmt *> Loops,
+                       ASTContext &Context) {
+  std::string Result;
+  llvm::SmallPtrSet<const VarDecl *, 4> OuterVars;
+  for (const Stmt *Loop : Loops) {
+    llvm::Optional<LoopTripCount> TripCount = getLoopTripCount(*Loop, Context);
+    if (!TripCount)
+      return llvm::None;
+    for (const VarDecl *Var : OuterVars)
+      if (references(*TripCount->Bound, *Var, Context))
+        return llvm::None;
+
+    for (const auto &Match : match(findAll(varDecl().bind("var")), *Loop,
+                                   Context))
+      OuterVars.insert(Match.getNodeAs<VarDecl>("var"));
+    const Expr *InitValue;
+    if (const auto *For = dyn_cast<ForStmt>(Loop))
+      if (const VarDecl *Counter = getCounter(For->getInit(), InitValue))
+        OuterVars.insert(Counter);
+
+    if (!Result.empty())
+      Result += " * ";
+    if (Loops.size() > 1 && IsBinaryOrTernary(TripCount->Bound))
+      Result += "(" + TripCount->Text + ")";
+    else
+      Result += TripCount->Text;
+  }
+  return Result;
+}
+
+} // namespace utils
+} // namespace tidy
+} // namespace clang
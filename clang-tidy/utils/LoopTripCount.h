@@ -0,0 +1,58 @@
+//===--- LoopTripCount.h - clang-tidy----------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_UTILS_LOOP_TRIP_COUNT_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_UTILS_LOOP_TRIP_COUNT_H
+
+#include "clang/AST/ASTContext.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include <string>
+
+namespace clang {
+namespace tidy {
+namespace utils {
+
+/// The number of iterations of a loop, known before the loop starts.
+struct LoopTripCount {
+  /// The expression the trip count is computed from, e.g. ``n`` in
+  /// ``for (int i = 0; i < n; ++i)`` or ``v`` in ``for (auto &e : v)``.
+  const Expr *Bound;
+  /// The trip count as source text, e.g. ``n`` or ``v.size()``.
+  std::string Text;
+};
+
+/// \brief Returns the trip count of the ``for`` or range-based ``for``
+/// statement ``Loop``, if it is known before the loop starts.
+///
+/// The following loops are supported:
+///   - counted loops: ``for (int i = 0; i < n; ++i)``, with ``i != n`` or
+///     ``n > i`` as condition, and ``for (int i = n; i > 0; --i)``;
+///   - iterator loops: ``for (auto it = v.begin(); it != v.end(); ++it)``;
+///   - range-based loops over a container with a ``size()`` method or over an
+///     array.
+/// The counter of a counted or iterator loop must not be modified in the
+/// loop body.
+llvm::Optional<LoopTripCount> getLoopTripCount(const Stmt &Loop,
+                                               ASTContext &Context);
+
+/// \brief Returns the number of times the body of the last loop in ``Loops``
+/// is executed as source text, e.g. ``n * v.size()``.
+///
+/// Each loop in ``Loops`` must be nested in the previous one. Returns ``None``
+/// if the trip count of a loop is unknown or depends on an enclosing loop.
+llvm::Optional<std::string>
+getNestedLoopTripCount(llvm::ArrayRef<const Stmt *> Loops,
+                       ASTContext &Context);
+
+} // namespace utils
+} // namespace tidy
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_UTILS_LOOP_TRIP_COUNT_H
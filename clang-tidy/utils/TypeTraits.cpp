@@ -48,6 +48,21 @@ llvm::Optional<bool> isExpensiveToCopy(QualType Type,
          !hasDeletedCopyConstructor(Type);
 }
 
+llvm::Optional<bool> isCheapToPassByValue(QualType Type,
+                                          const ASTContext &Context,
+                                          uint64_t MaxSize) {
+  if (Type->isDependentType() || Type->isIncompleteType())
+    return llvm::None;
+  if (Type.isVolatileQualified() || Type->isArrayType() ||
+      hasDeletedCopyConstructor(Type))
+    return false;
+  if (!Type.isTriviallyCopyableType(Context) &&
+      !classHasTrivialCopyAndDestroy(Type))
+    return false;
+  return static_cast<uint64_t>(
+             Context.getTypeSizeInChars(Type).getQuantity()) <= MaxSize;
+}
+
 bool recordIsTriviallyDefaultConstructible(const RecordDecl &RecordDecl,
                                            const ASTContext &Context) {
   const auto *ClassDecl = dyn_cast<CXXRecordDecl>(&RecordDecl);
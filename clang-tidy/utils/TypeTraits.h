@@ -22,6 +22,12 @@ namespace type_traits {
 llvm::Optional<bool> isExpensiveToCopy(QualType Type,
                                        const ASTContext &Context);
 
+/// Returns `true` if `Type` is trivially copyable and at most `MaxSize` bytes
+/// large, so that passing it by value is cheaper than passing a reference.
+llvm::Optional<bool> isCheapToPassByValue(QualType Type,
+                                          const ASTContext &Context,
+                                          uint64_t MaxSize);
+
 /// Returns `true` if `Type` is trivially default constructible.
 bool isTriviallyDefaultConstructible(QualType Type, const ASTContext &Context);
 
@@ -0,0 +1,9 @@
+#ifndef MULTI_DOCUMENT_H
+#define MULTI_DOCUMENT_H
+
+int first = 0;
+// CHECK: int first = 1;
+int second = 0;
+// CHECK: int second = 2;
+
+#endif // MULTI_DOCUMENT_H
@@ -0,0 +1,8 @@
+// RUN: mkdir -p %T/Inputs/multi-document
+// RUN: grep -Ev "// *[A-Z-]+:" %S/Inputs/multi-document/multi-document.h > %T/Inputs/multi-document/multi-document.h
+// RUN: sed "s#\$(path)#%/T/Inputs/multi-document#" %S/Inputs/multi-document/file1.yaml > %T/Inputs/multi-document/file1.yaml
+// RUN: clang-apply-replacements %T/Inputs/multi-document
+// RUN: FileCheck -input-file=%T/Inputs/multi-document/multi-document.h %S/Inputs/multi-document/multi-document.h
+//
+// Check that all documents of a YAML stream are applied, as written by
+// clang-tidy -export-fixes with one document per translation unit.
@@ -0,0 +1,19 @@
+#ifndef DEDUPLICATE_HEADERS_HEADER_H
+#define DEDUPLICATE_HEADERS_HEADER_H
+
+struct S {
+  S();
+  S(const S &);
+};
+
+struct V {
+  S *begin();
+  S *end();
+};
+
+inline void header(V &v) {
+  for (const S s : v) {
+  }
+}
+
+#endif // DEDUPLICATE_HEADERS_HEADER_H
@@ -0,0 +1,11 @@
+#ifndef DEDUPLICATE_HEADERS_MACRO_H
+#define DEDUPLICATE_HEADERS_MACRO_H
+
+#include "header.h"
+
+inline void macro(V &v) {
+  for (ELEMENT e : v) {
+  }
+}
+
+#endif // DEDUPLICATE_HEADERS_MACRO_H
@@ -0,0 +1,2 @@
+#define ELEMENT const S &
+#include "macro.h"
@@ -0,0 +1,9 @@
+struct Shape {
+  virtual ~Shape();
+  virtual double area() const = 0;
+};
+
+struct Polygon : Shape {
+  double area() const override;
+  virtual int sides() const;
+};
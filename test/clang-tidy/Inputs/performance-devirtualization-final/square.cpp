@@ -0,0 +1,5 @@
+#include "shapes.h"
+
+struct Square final : Polygon {
+  int sides() const override;
+};
@@ -0,0 +1,10 @@
+// RUN: clang-tidy -checks='-*,performance-for-range-copy' -header-filter='.*' -deduplicate-headers %S/Inputs/deduplicate-headers/reference.cpp %s -- -std=c++11 -I %S/Inputs/deduplicate-headers 2>&1 | FileCheck %s
+
+// macro.h depends on a macro of the including file, so it is analyzed again.
+// header.h doesn't, so it is skipped.
+#define ELEMENT const S
+#include "macro.h"
+
+// CHECK: header.h:15:16: warning: the loop variable's type is not a reference type
+// CHECK: macro.h:7:16: warning: the loop variable's type is not a reference type
+// CHECK-NOT: header.h:15:16: warning:
@@ -0,0 +1,22 @@
+// RUN: clang-tidy -checks='-*,performance-for-range-copy' -header-filter='.*' %s %s -- -std=c++11 -I %S/Inputs/deduplicate-headers 2>&1 | FileCheck --check-prefix=CHECK-DUP %s
+// RUN: clang-tidy -checks='-*,performance-for-range-copy' -header-filter='.*' -deduplicate-headers %s %s -- -std=c++11 -I %S/Inputs/deduplicate-headers 2>&1 | FileCheck %s
+
+#include "header.h"
+
+void f(V &v) {
+  for (const S s : v) {
+  }
+}
+
+// Without -deduplicate-headers each translation unit reports the header.
+// CHECK-DUP: header.h:15:16: warning: the loop variable's type is not a reference type
+// CHECK-DUP: deduplicate-headers.cpp:7:16: warning: the loop variable's type is not a reference type
+// CHECK-DUP: header.h:15:16: warning: the loop variable's type is not a reference type
+// CHECK-DUP: deduplicate-headers.cpp:7:16: warning: the loop variable's type is not a reference type
+
+// The second translation unit skips the already analyzed header.
+// CHECK: header.h:15:16: warning: the loop variable's type is not a reference type
+// CHECK: deduplicate-headers.cpp:7:16: warning: the loop variable's type is not a reference type
+// CHECK-NOT: header.h:15:16: warning:
+// CHECK: deduplicate-headers.cpp:7:16: warning: the loop variable's type is not a reference type
+// CHECK-NOT: header.h:15:16: warning:
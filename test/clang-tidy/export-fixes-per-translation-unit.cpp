@@ -0,0 +1,24 @@
+// RUN: grep -Ev "// *[A-Z-]+:" %s > %t-a.cpp
+// RUN: grep -Ev "// *[A-Z-]+:" %s > %t-b.cpp
+// RUN: clang-tidy %t-a.cpp %t-b.cpp -checks='-*,google-explicit-constructor' -export-fixes=%t.yaml -- > %t.msg 2>&1
+// RUN: FileCheck -input-file=%t.yaml %s
+//
+// A failed run must not truncate an existing export file.
+// RUN: echo "previous fixes" > %t-kept.yaml
+// RUN: clang-tidy %t-missing.cpp -checks='-*,google-explicit-constructor' -export-fixes=%t-kept.yaml -- > %t-missing.msg 2>&1 || true
+// RUN: FileCheck -input-file=%t-kept.yaml -check-prefix=CHECK-KEPT %s
+
+class A { A(int i); };
+
+// Each translation unit is written as a separate document.
+// CHECK: ---
+// CHECK-NEXT: MainSourceFile: {{.*}}-a.cpp
+// CHECK: ReplacementText: 'explicit '
+// CHECK: ...
+// CHECK-NEXT: ---
+// CHECK-NEXT: MainSourceFile: {{.*}}-b.cpp
+// CHECK: ReplacementText: 'explicit '
+// CHECK: ...
+// CHECK-NOT: MainSourceFile
+
+// CHECK-KEPT: previous fixes
@@ -0,0 +1,8 @@
+// RUN: clang-tidy -checks='-*,llvm-namespace-comment' -memory-report %s -- 2>&1 | FileCheck %s
+
+// CHECK: ---AST MB---  --Source MB-  --Heap MB---  --Peak MB---  --- Name ---
+// CHECK: {{.*}}memory-report.cpp
+// CHECK: Peak resident memory: {{[0-9]+\.[0-9]}} MB
+
+namespace n {
+}
@@ -0,0 +1,83 @@
+// RUN: %check_clang_tidy %s performance-avoid-std-function-in-hot-paths %t -- -config="{CheckOptions: [{key: performance-avoid-std-function-in-hot-paths.AllowedTypes, value: 'Callback$'}]}" -- -std=c++11
+
+namespace std {
+template <typename T>
+class function;
+
+template <typename R, typename... Args>
+class function<R(Args...)> {
+public:
+  function();
+  function(decltype(nullptr));
+  function(const function &);
+  function(function &&);
+  template <typename F>
+  function(F);
+  R operator()(Args...) const;
+  explicit operator bool() const;
+};
+} // namespace std
+
+typedef std::function<void()> Callback;
+
+void store(std::function<int(int)>);
+
+int onlyCalled(const std::function<int(int)> &F) {
+  // CHECK-MESSAGES: :[[@LINE-1]]:47: warning: parameter 'F' of type 'const std::function<int (int)> &' is only called; consider a template parameter or a function reference type to avoid the type erasure [performance-avoid-std-function-in-hot-paths]
+  int Sum = 0;
+  for (int I = 0; I < 10; ++I)
+    Sum += F(I);
+  return Sum;
+}
+
+void byValue(std::function<void()> F) {
+  // CHECK-MESSAGES: :[[@LINE-1]]:36: warning: parameter 'F' of type 'std::function<void ()>' is only called
+  F();
+  (F)();
+}
+
+void stored(std::function<int(int)> F) {
+  F(1);
+  store(F);
+}
+
+void tested(std::function<void()> F) {
+  if (F)
+    F();
+}
+
+void captured(std::function<void()> F) {
+  auto L = [&] { F(); };
+  L();
+}
+
+void allowed(Callback F) {
+  F();
+}
+
+struct Base {
+  virtual void run(std::function<void()> F) { F(); }
+};
+
+void constructedInLoop(int N) {
+  int Sum = 0;
+  for (int I = 0; I < N; ++I) {
+    std::function<int(int)> F = [&](int X) { return X + I; };
+    // CHECK-MESSAGES: :[[@LINE-1]]:33: warning: 'std::function<int (int)>' is constructed inside a loop; construct it once before the loop or avoid the type erasure
+    Sum += F(I);
+  }
+  while (N--)
+    store([](int X) { return X; });
+    // CHECK-MESSAGES: :[[@LINE-1]]:11: warning: 'std::function<int (int)>' is constructed inside a loop
+}
+
+void constructedOutsideLoop(int N) {
+  std::function<int(int)> F = [](int X) { return X; };
+  for (int I = 0; I < N; ++I) {
+    std::function<int(int)> Empty;
+    std::function<int(int)> Null = nullptr;
+    F(I);
+  }
+  for (std::function<int(int)> G = [](int X) { return X; }; N > 0; --N)
+    G(N);
+}
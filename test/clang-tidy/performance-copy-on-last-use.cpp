@@ -0,0 +1,140 @@
+// RUN: %check_clang_tidy %s performance-copy-on-last-use %t -- -- -std=c++11
+
+// CHECK-FIXES: #include <utility>
+
+namespace std {
+struct string {
+  string();
+  string(const char *);
+  string(const string &);
+  string(string &&);
+  ~string();
+  string &operator=(const string &);
+  string &operator=(string &&);
+  string &operator+=(char);
+  unsigned size() const;
+  const char *c_str() const;
+  char *begin();
+};
+
+template <typename T> struct vector {
+  void push_back(const T &);
+  void push_back(T &&);
+};
+} // namespace std
+
+void takeByValue(std::string);
+void takeByConstRef(const std::string &);
+void use(const std::string &);
+
+void pushBack(std::vector<std::string> &Names, const char *First) {
+  std::string Name = First;
+  Name += ' ';
+  Names.push_back(Name);
+  // CHECK-MESSAGES: :[[@LINE-1]]:19: warning: 'Name' is copied on its last use; consider moving it [performance-copy-on-last-use]
+  // CHECK-FIXES: {{^}}  Names.push_back(std::move(Name));{{$}}
+}
+
+struct Foo {
+  Foo(std::string);
+};
+
+Foo construct(const char *Text) {
+  std::string Bar(Text);
+  return Foo(Bar);
+  // CHECK-MESSAGES: :[[@LINE-1]]:14: warning: 'Bar' is copied on its last use
+  // CHECK-FIXES: {{^}}  return Foo(std::move(Bar));{{$}}
+}
+
+class Widget {
+public:
+  void setTitle(std::string Title) {
+    use(Title);
+    Title_ = Title;
+    // CHECK-MESSAGES: :[[@LINE-1]]:14: warning: 'Title' is copied on its last use
+    // CHECK-FIXES: {{^}}    Title_ = std::move(Title);{{$}}
+  }
+
+private:
+  std::string Title_;
+};
+
+void branches(bool Flag, std::vector<std::string> &V) {
+  std::string S = "a";
+  if (Flag) {
+    takeByValue(S);
+    // CHECK-MESSAGES: :[[@LINE-1]]:17: warning: 'S' is copied on its last use
+    // CHECK-FIXES: {{^}}    takeByValue(std::move(S));{{$}}
+  } else {
+    V.push_back(S);
+    // CHECK-MESSAGES: :[[@LINE-1]]:17: warning: 'S' is copied on its last use
+    // CHECK-FIXES: {{^}}    V.push_back(std::move(S));{{$}}
+  }
+}
+
+void declaredInLoop(std::vector<std::string> &V, int N) {
+  for (int I = 0; I < N; ++I) {
+    std::string S = "a";
+    V.push_back(S);
+    // CHECK-MESSAGES: :[[@LINE-1]]:17: warning: 'S' is copied on its last use
+    // CHECK-FIXES: {{^}}    V.push_back(std::move(S));{{$}}
+  }
+}
+
+// Negatives.
+
+void usedAfterwards(std::vector<std::string> &V) {
+  std::string S = "a";
+  V.push_back(S);
+  use(S);
+}
+
+void usedOnOnePath(std::vector<std::string> &V, bool Flag) {
+  std::string S = "a";
+  V.push_back(S);
+  if (Flag)
+    use(S);
+}
+
+void declaredOutsideOfLoop(std::vector<std::string> &V, int N) {
+  std::string S = "a";
+  for (int I = 0; I < N; ++I)
+    V.push_back(S);
+}
+
+void usedLaterInExpression() {
+  std::string S = "a";
+  takeByValue(S), S.size();
+}
+
+void noRValueOverload() {
+  std::string S = "a";
+  takeByConstRef(S);
+}
+
+void aliases(std::vector<std::string> &V) {
+  std::string S1 = "a";
+  const std::string &Ref = S1;
+  V.push_back(S1);
+
+  std::string S2 = "b";
+  const char *Data = S2.c_str();
+  V.push_back(S2);
+
+  std::string S3 = "c";
+  std::string *Pointer = &S3;
+  V.push_back(S3);
+
+  std::string S4 = "d";
+  auto Lambda = [&] { return S4.size(); };
+  V.push_back(S4);
+}
+
+void constVariable(std::vector<std::string> &V) {
+  const std::string S = "a";
+  V.push_back(S);
+}
+
+void usedTwiceInCall(std::string S) {
+  S = S;
+}
@@ -0,0 +1,18 @@
+// RUN: rm -rf %T/devirtualization-final && mkdir -p %T/devirtualization-final/summaries
+// RUN: clang-tidy %s %S/Inputs/performance-devirtualization-final/square.cpp -checks='-*,performance-devirtualization-final' -config="{CheckOptions: [{key: performance-devirtualization-final.SummaryDirectory, value: '%T/devirtualization-final/summaries'}]}" -- -std=c++11 -I %S/Inputs/performance-devirtualization-final | count 0
+// RUN: echo 'Not a summary.' > %T/devirtualization-final/summaries/README
+// RUN: clang-tidy-merge-class-hierarchy %T/devirtualization-final/summaries %T/devirtualization-final/final.yaml
+// RUN: clang-tidy %s -checks='-*,performance-devirtualization-final' -config="{CheckOptions: [{key: performance-devirtualization-final.HierarchySummary, value: '%T/devirtualization-final/final.yaml'}]}" -header-filter='.*' -- -std=c++11 -I %S/Inputs/performance-devirtualization-final | FileCheck %s -implicit-check-not="{{warning|error}}:"
+
+// RUN: mkdir -p %T/devirtualization-final/malformed && echo '--- [' > %T/devirtualization-final/malformed/a.cpp-123456.yaml
+// RUN: not clang-tidy-merge-class-hierarchy %T/devirtualization-final/malformed %T/devirtualization-final/malformed.yaml 2>&1 | FileCheck -check-prefix=CHECK-MALFORMED %s
+// CHECK-MALFORMED: Can't parse the class hierarchy summary '{{.*}}a.cpp-123456.yaml'
+
+#include "shapes.h"
+
+// CHECK: shapes.h:7:10: warning: method 'area' is not overridden in any derived class; declare it 'final' to allow devirtualizing calls to it [performance-devirtualization-final]
+
+struct Circle : Shape {
+  // CHECK: :[[@LINE-1]]:8: warning: class 'Circle' has no derived classes; declare it 'final' to allow devirtualizing calls to its virtual methods [performance-devirtualization-final]
+  double area() const override;
+};
@@ -0,0 +1,104 @@
+// RUN: %check_clang_tidy %s performance-devirtualization-final %t
+
+namespace {
+
+struct Base {
+  virtual ~Base();
+  virtual void f();
+  virtual int g(int) const;
+};
+
+struct Leaf : Base {
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: class 'Leaf' has no derived classes; declare it 'final' to allow devirtualizing calls to its virtual methods [performance-devirtualization-final]
+  // CHECK-FIXES: {{^}}struct Leaf final : Base {
+  void f() override;
+};
+
+class Middle : public Base {
+public:
+  void f() override;
+  int g(int) const override;
+  // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: method 'g' is not overridden in any derived class; declare it 'final' to allow devirtualizing calls to it [performance-devirtualization-final]
+  // CHECK-FIXES: {{^}}  int g(int) const final;{{$}}
+};
+
+class Bottom : public Middle {
+  // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: class 'Bottom' has no derived
+  // CHECK-FIXES: {{^}}class Bottom final : public Middle {
+public:
+  void f() override;
+};
+
+struct NoOverride : Base {
+  virtual void f();
+  // CHECK-MESSAGES: :[[@LINE-1]]:16: warning: method 'f' is not overridden
+  // CHECK-FIXES: {{^}}  virtual void f();{{$}}
+};
+
+struct DerivedFromNoOverride : NoOverride {
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: class 'DerivedFromNoOverride' has no derived
+  int g(int) const override;
+};
+
+struct FinalMethods : Base {
+  void f() final;
+};
+
+struct FromFinalMethods : FinalMethods {
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: class 'FromFinalMethods' has no derived
+};
+
+// Negatives.
+
+struct Abstract : Base {
+  virtual void h() = 0;
+};
+
+struct AlreadyFinal final : Base {
+  void f() override;
+};
+
+template <typename T> struct Template : Base {
+  void f() override;
+};
+
+Template<int> Instance;
+
+#define DECLARE_CLASS(Name) struct Name : Base {};
+DECLARE_CLASS(FromMacro)
+
+struct NotPolymorphic {
+  void f();
+};
+
+struct DerivedLocally : Base {
+  void f() override;
+};
+
+void derivesLocally() {
+  struct Impl : DerivedLocally {
+    void f() override;
+  };
+}
+
+struct DerivedByUnnamed : Base {
+  void f() override;
+};
+
+struct : DerivedByUnnamed {
+  void f() override;
+} Unnamed;
+
+} // namespace
+
+// Classes with external linkage may have derived classes in other translation
+// units, so they're only reported with a hierarchy summary.
+struct External : Base {
+  void f() override;
+};
+
+void local() {
+  struct Local : Base {
+    void f() override;
+  };
+}
@@ -0,0 +1,120 @@
+// RUN: %check_clang_tidy %s performance-false-sharing %t -- -- -std=c++11 -target x86_64-unknown-linux-gnu
+
+namespace std {
+template <typename T>
+struct atomic {
+  atomic() {}
+  T operator++();
+  T Value;
+};
+
+struct mutex {
+  void lock();
+  void unlock();
+  int State[10];
+};
+} // namespace std
+
+struct Counters {
+  std::atomic<long> Reads;
+  std::atomic<long> Writes;
+  // CHECK-MESSAGES: :[[@LINE-1]]:21: warning: 'Writes' may share a cache line with 'Reads', which causes false sharing when they are modified by different threads [performance-false-sharing]
+  // CHECK-FIXES: {{^  alignas\(64\) std::atomic<long> Writes;$}}
+};
+
+struct Locks {
+  std::mutex First;
+  mutable std::mutex Second;
+  // CHECK-MESSAGES: :[[@LINE-1]]:22: warning: 'Second' may share a cache line with 'First'
+  // CHECK-FIXES: {{^  alignas\(64\) mutable std::mutex Second;$}}
+};
+
+struct SharedDeclaration {
+  std::atomic<int> X, Y;
+  // CHECK-MESSAGES: :[[@LINE-1]]:23: warning: 'Y' may share a cache line with 'X'
+  // CHECK-FIXES: {{^  std::atomic<int> X, Y;$}}
+};
+
+std::atomic<long> PerThread[8];
+// CHECK-MESSAGES: :[[@LINE-1]]:19: warning: elements of 'PerThread' may share a cache line, which causes false sharing when they are modified by different threads
+
+void increment(int ThreadId) {
+  ++PerThread[ThreadId];
+  ++PerThread[ThreadId + 1];
+}
+
+struct Workers {
+  std::mutex Lock;
+  std::atomic<long> Count;
+  // CHECK-MESSAGES: :[[@LINE-1]]:21: warning: 'Count' may share a cache line with 'Lock'
+  // CHECK-FIXES: {{^  alignas\(64\) std::atomic<long> Count;$}}
+};
+
+void produce(Workers &W) {
+  W.Lock.lock();
+  W.Lock.unlock();
+}
+
+void consume(Workers &W) {
+  ++W.Count;
+}
+
+// Negatives.
+
+struct FarApart {
+  std::mutex Lock;
+  int Data[100];
+  std::atomic<int> Flag;
+};
+
+struct Aligned {
+  std::atomic<long> A;
+  alignas(64) std::atomic<long> B;
+};
+
+struct ConstMember {
+  std::atomic<long> A;
+  const std::atomic<long> B;
+};
+
+// Only modified together by the same functions.
+struct Guarded {
+  std::mutex Lock;
+  std::atomic<long> Count;
+};
+
+void add(Guarded &G) {
+  G.Lock.lock();
+  ++G.Count;
+  G.Lock.unlock();
+}
+
+void addTwice(Guarded &G) {
+  G.Lock.lock();
+  ++G.Count;
+  ++G.Count;
+  G.Lock.unlock();
+}
+
+template <typename T>
+struct Dependent {
+  std::atomic<T> A;
+  std::atomic<T> B;
+};
+Dependent<int> Instance;
+
+std::atomic<long> ConstantIndexOnly[8];
+
+void touch() {
+  ++ConstantIndexOnly[0];
+  ++ConstantIndexOnly[1];
+}
+
+struct alignas(64) PaddedCounter {
+  std::atomic<long> Value;
+};
+PaddedCounter Padded[8];
+
+void incrementPadded(int ThreadId) {
+  ++Padded[ThreadId].Value;
+}
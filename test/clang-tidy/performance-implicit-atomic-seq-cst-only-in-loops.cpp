@@ -0,0 +1,33 @@
+// RUN: %check_clang_tidy %s performance-implicit-atomic-seq-cst %t -config="{CheckOptions: [{key: performance-implicit-atomic-seq-cst.OnlyInLoops, value: 1}]}" -- -std=c++11
+
+namespace std {
+enum memory_order { memory_order_relaxed, memory_order_seq_cst };
+
+template <typename T> struct atomic {
+  T operator++();
+  T fetch_add(T, memory_order = memory_order_seq_cst);
+  T exchange(T, memory_order = memory_order_seq_cst);
+};
+} // namespace std
+
+std::atomic<int> Processed;
+
+void process(int N) {
+  ++Processed;
+  for (int I = 0; I < N; ++I)
+    Processed.fetch_add(1);
+    // CHECK-MESSAGES: :[[@LINE-1]]:15: warning: atomic counter 'Processed' is incremented
+    // CHECK-FIXES: {{^}}    Processed.fetch_add(1, std::memory_order_relaxed);{{$}}
+  while (N--)
+    ++Processed;
+    // CHECK-MESSAGES: :[[@LINE-1]]:5: warning: atomic counter 'Processed' is incremented
+    // CHECK-FIXES: {{^}}    Processed.fetch_add(1, std::memory_order_relaxed);{{$}}
+}
+
+std::atomic<int> Ticket;
+
+void synchronizes(int N) {
+  for (int I = 0; I < N; ++I)
+    ++Ticket;
+  Ticket.exchange(0);
+}
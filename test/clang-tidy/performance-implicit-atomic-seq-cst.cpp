@@ -0,0 +1,151 @@
+// RUN: %check_clang_tidy %s performance-implicit-atomic-seq-cst %t -- -- -std=c++11
+
+namespace std {
+enum memory_order {
+  memory_order_relaxed,
+  memory_order_release,
+  memory_order_seq_cst
+};
+
+template <typename T> struct atomic {
+  atomic() = default;
+  constexpr atomic(T);
+  T operator++();
+  T operator++(int);
+  T operator--();
+  T operator+=(T);
+  T operator-=(T);
+  T operator|=(T);
+  T operator=(T);
+  operator T() const;
+  T load(memory_order = memory_order_seq_cst) const;
+  void store(T, memory_order = memory_order_seq_cst);
+  T fetch_add(T, memory_order = memory_order_seq_cst);
+  T fetch_sub(T, memory_order = memory_order_seq_cst);
+  T exchange(T, memory_order = memory_order_seq_cst);
+  bool compare_exchange_strong(T &, T, memory_order = memory_order_seq_cst);
+  bool is_lock_free() const;
+};
+} // namespace std
+
+std::atomic<unsigned> Hits;
+
+void hit(unsigned N) {
+  ++Hits;
+  // CHECK-MESSAGES: :[[@LINE-1]]:3: warning: atomic counter 'Hits' is incremented with the implicit sequentially consistent memory order; consider a relaxed operation [performance-implicit-atomic-seq-cst]
+  // CHECK-FIXES: {{^}}  Hits.fetch_add(1, std::memory_order_relaxed);{{$}}
+  Hits++;
+  // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: atomic counter 'Hits' is incremented
+  // CHECK-FIXES: {{^}}  Hits.fetch_add(1, std::memory_order_relaxed);{{$}}
+  Hits += N;
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: atomic counter 'Hits' is incremented
+  // CHECK-FIXES: {{^}}  Hits.fetch_add(N, std::memory_order_relaxed);{{$}}
+  Hits.fetch_add(2);
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: atomic counter 'Hits' is incremented
+  // CHECK-FIXES: {{^}}  Hits.fetch_add(2, std::memory_order_relaxed);{{$}}
+  --Hits;
+  // CHECK-MESSAGES: :[[@LINE-1]]:3: warning: atomic counter 'Hits' is decremented
+  // CHECK-FIXES: {{^}}  Hits.fetch_sub(1, std::memory_order_relaxed);{{$}}
+  Hits.fetch_add(1, std::memory_order_relaxed);
+}
+
+struct Stats {
+  void add(long N) {
+    Bytes -= N;
+    // CHECK-MESSAGES: :[[@LINE-1]]:11: warning: atomic counter 'Bytes' is decremented
+    // CHECK-FIXES: {{^}}    Bytes.fetch_sub(N, std::memory_order_relaxed);{{$}}
+  }
+  std::atomic<long> Bytes;
+};
+
+void addAll(Stats &S, const long *Sizes, int N) {
+  for (int I = 0; I < N; ++I)
+    S.Bytes.fetch_add(Sizes[I]);
+    // CHECK-MESSAGES: :[[@LINE-1]]:13: warning: atomic counter 'Bytes' is incremented
+    // CHECK-FIXES: {{^}}    S.Bytes.fetch_add(Sizes[I], std::memory_order_relaxed);{{$}}
+}
+
+std::atomic<unsigned> Misses;
+
+void miss() { Misses.fetch_add(1, std::memory_order_relaxed); }
+
+unsigned readMisses() {
+  unsigned Loaded = Misses.load();
+  // CHECK-MESSAGES: :[[@LINE-1]]:28: warning: atomic counter 'Misses' is loaded with the implicit sequentially consistent memory order, although it is only modified with relaxed operations; consider a relaxed load [performance-implicit-atomic-seq-cst]
+  // CHECK-FIXES: {{^}}  unsigned Loaded = Misses.load(std::memory_order_relaxed);{{$}}
+  return Loaded + Misses;
+  // CHECK-MESSAGES: :[[@LINE-1]]:19: warning: atomic counter 'Misses' is loaded
+  // CHECK-FIXES: {{^}}  return Loaded + Misses.load(std::memory_order_relaxed);{{$}}
+}
+
+// Negatives.
+
+unsigned readHits() {
+  // 'Hits' is still incremented with the sequentially consistent order.
+  return Hits.load() + Hits;
+}
+
+std::atomic<int> Flag;
+int Data;
+void use(int);
+void publish() {
+  Data = 42;
+  Flag.store(1);
+}
+void consume() {
+  while (!Flag.load())
+    ;
+  use(Data);
+}
+
+std::atomic<int> AssignedFlag;
+void assign() { AssignedFlag = 1; }
+int readAssigned() { return AssignedFlag; }
+
+std::atomic<unsigned> Resettable;
+void count() { ++Resettable; }
+void reset() { Resettable = 0; }
+
+std::atomic<int> Refs;
+void retain() { ++Refs; }
+bool release() { return --Refs == 0; }
+
+std::atomic<int> Tickets;
+int take() { return Tickets.fetch_add(1); }
+void skip() { Tickets++; }
+
+std::atomic<int> Released;
+void releaseOrder() {
+  Released.fetch_add(1, std::memory_order_release);
+  ++Released;
+}
+int loadReleased() { return Released.load(); }
+
+std::atomic<int> State;
+void compareExchange() {
+  int Expected = 0;
+  State.compare_exchange_strong(Expected, 1);
+  ++State;
+}
+
+std::atomic<int> Escaped;
+void escape(std::atomic<int> &);
+void escapes() {
+  escape(Escaped);
+  ++Escaped;
+}
+
+std::atomic<int> Referenced;
+void boundToReference() {
+  std::atomic<int> &Ref = Referenced;
+  ++Referenced;
+}
+
+std::atomic<int> Bits;
+void bitwise() {
+  Bits |= 1;
+  ++Bits;
+}
+
+std::atomic<bool> Ready;
+void flag() { Ready = true; }
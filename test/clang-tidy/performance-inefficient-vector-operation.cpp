@@ -48,6 +48,44 @@ class vector {
   const_iterator begin() const;
   const_iterator end() const;
 };
+
+template <class T1, class T2>
+struct pair {
+  pair(const T1 &, const T2 &);
+};
+
+template <class K, class V>
+class unordered_map {
+ public:
+  unordered_map();
+  void insert(const pair<K, V> &value);
+  template <class... Args> void emplace(Args &&... args);
+  void reserve(size_t n);
+};
+
+template <class K>
+class unordered_set {
+ public:
+  unordered_set();
+  void insert(const K &value);
+  template <class InputIt> void insert(InputIt first, InputIt last);
+  void reserve(size_t n);
+};
+
+template <class C>
+class basic_string {
+ public:
+  basic_string();
+  basic_string &operator+=(C c);
+  basic_string &operator+=(const basic_string &str);
+  basic_string &append(const basic_string &str);
+  void push_back(C c);
+  void reserve(size_t n);
+  size_t size() const;
+  const C *begin() const;
+  const C *end() const;
+};
+typedef basic_string<char> string;
 } // namespace std
 
 class Foo {
@@ -275,3 +313,132 @@ void f(std::vector<int>& t) {
     }
   }
 }
+
+void g(std::vector<int> &t, std::vector<std::vector<int>> &tt,
+       std::string &str, int n) {
+  {
+    std::vector<int> v0;
+    // CHECK-FIXES: v0.reserve(n);
+    for (int i = n; i > 0; --i)
+      v0.push_back(i);
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'push_back' is called
+  }
+  {
+    std::vector<int> v1;
+    // CHECK-FIXES: v1.reserve(t.size());
+    for (auto it = t.begin(); it != t.end(); ++it)
+      v1.push_back(*it);
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'push_back' is called
+  }
+  {
+    int a[8];
+    std::vector<int> v2;
+    // CHECK-FIXES: v2.reserve(8);
+    for (int e : a)
+      v2.push_back(e);
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'push_back' is called
+  }
+  {
+    std::vector<int> v3;
+    // CHECK-FIXES: v3.reserve(n * (n + 1));
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n + 1; ++j) {
+        v3.push_back(i * j);
+        // CHECK-MESSAGES: :[[@LINE-1]]:9: warning: 'push_back' is called
+      }
+    }
+  }
+  {
+    std::vector<int> v4;
+    // CHECK-FIXES: v4.reserve(n * t.size());
+    for (int i = 0; i < n; ++i)
+      for (int e : t)
+        v4.push_back(e);
+        // CHECK-MESSAGES: :[[@LINE-1]]:9: warning: 'push_back' is called
+  }
+  {
+    std::unordered_map<int, int> m0;
+    // CHECK-FIXES: m0.reserve(t.size());
+    for (int e : t)
+      m0.insert(std::pair<int, int>(e, 0));
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'insert' is called inside a loop; consider pre-allocating the container capacity before the loop
+  }
+  {
+    std::unordered_map<int, int> m1;
+    // CHECK-FIXES: m1.reserve(n);
+    for (int i = 0; i < n; ++i)
+      m1.emplace(i, i);
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'emplace' is called
+  }
+  {
+    std::unordered_set<int> s0;
+    // CHECK-FIXES: s0.reserve(t.size());
+    for (int e : t)
+      s0.insert(e);
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'insert' is called
+  }
+  {
+    std::string s1;
+    // CHECK-FIXES: s1.reserve(n);
+    for (int i = 0; i < n; ++i)
+      s1 += 'x';
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'operator+=' is called inside a loop; consider pre-allocating the string capacity before the loop
+  }
+  {
+    std::string s2;
+    // CHECK-FIXES: s2.reserve(str.size());
+    for (char c : str)
+      s2.push_back(c);
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'push_back' is called
+  }
+  {
+    std::string s3;
+    // CHECK-FIXES-NOT: s3.reserve(n);
+    // The number of appended characters is unknown.
+    for (int i = 0; i < n; ++i)
+      s3.append(str);
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'append' is called inside a loop; consider pre-allocating the string capacity before the loop
+  }
+
+  // ---- Non-fixed Cases ----
+  {
+    std::vector<int> z0;
+    // CHECK-FIXES-NOT: z0.reserve(
+    // The inner trip count depends on the outer loop.
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < i; ++j)
+        z0.push_back(j);
+  }
+  {
+    std::vector<int> z1;
+    // CHECK-FIXES-NOT: z1.reserve(
+    // The outer loop body has more than one statement.
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j)
+        z1.push_back(j);
+      z1.push_back(i);
+    }
+  }
+  {
+    std::vector<int> z2;
+    // CHECK-FIXES-NOT: z2.reserve(
+    // The loop counter is modified in the loop body.
+    for (int i = 0; i < n; ++i) {
+      z2.push_back(i++);
+    }
+  }
+  {
+    std::vector<int> z3;
+    // CHECK-FIXES-NOT: z3.reserve(
+    // Iterating over different containers.
+    for (auto it = t.begin(); it != tt[0].end(); ++it)
+      z3.push_back(*it);
+  }
+  {
+    std::unordered_set<int> z4;
+    // CHECK-FIXES-NOT: z4.reserve(
+    // Range insertion.
+    for (int i = 0; i < n; ++i)
+      z4.insert(t.begin(), t.end());
+  }
+}
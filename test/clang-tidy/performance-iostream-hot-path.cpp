@@ -0,0 +1,131 @@
+// RUN: %check_clang_tidy %s performance-iostream-hot-path %t -- -- -std=c++11
+
+namespace std {
+template <typename C> struct char_traits {};
+template <typename T> struct allocator {};
+
+template <typename C, typename T = char_traits<C>, typename A = allocator<C>>
+struct basic_string {
+  basic_string();
+  basic_string(const C *);
+};
+typedef basic_string<char> string;
+string operator+(const char *, const string &);
+string to_string(int);
+
+template <typename C, typename T = char_traits<C>> struct basic_ostream {
+  basic_ostream &operator<<(int);
+  basic_ostream &operator<<(double);
+  basic_ostream &operator<<(basic_ostream &(*)(basic_ostream &));
+};
+typedef basic_ostream<char> ostream;
+template <typename C, typename T>
+basic_ostream<C, T> &operator<<(basic_ostream<C, T> &, const C *);
+template <typename C, typename T>
+basic_ostream<C, T> &endl(basic_ostream<C, T> &);
+extern ostream cout;
+
+template <typename C, typename T = char_traits<C>> struct basic_istream {
+  basic_istream &operator>>(int &);
+};
+
+template <typename C, typename T = char_traits<C>, typename A = allocator<C>>
+struct basic_ostringstream : basic_ostream<C, T> {
+  basic_ostringstream(int Mode = 0);
+  basic_string<C, T, A> str() const;
+};
+typedef basic_ostringstream<char> ostringstream;
+typedef basic_ostringstream<wchar_t> wostringstream;
+
+template <typename C, typename T = char_traits<C>, typename A = allocator<C>>
+struct basic_istringstream : basic_istream<C, T> {
+  basic_istringstream(int Mode = 0);
+  explicit basic_istringstream(const basic_string<C, T, A> &);
+  basic_string<C, T, A> str() const;
+  void str(const basic_string<C, T, A> &);
+  void clear();
+};
+typedef basic_istringstream<char> istringstream;
+} // namespace std
+
+void use(const std::string &);
+
+void endlInLoop(std::ostream &Out, const int *Values, int N) {
+  for (int I = 0; I < N; ++I)
+    Out << Values[I] << std::endl;
+  // CHECK-MESSAGES: :[[@LINE-1]]:25: warning: 'std::endl' flushes the stream in each loop iteration; use '\n' instead and flush the stream after the loop if needed [performance-iostream-hot-path]
+  // CHECK-FIXES: {{^}}    Out << Values[I] << '\n';{{$}}
+  while (N--) {
+    std::cout << "line" << std::endl;
+    // CHECK-MESSAGES: :[[@LINE-1]]:28: warning: 'std::endl' flushes the stream
+    // CHECK-FIXES: {{^}}    std::cout << "line" << '\n';{{$}}
+  }
+  Out << "done" << std::endl;
+}
+
+// CHECK-MESSAGES: :[[@LINE+2]]:22: warning: string stream 'Stream' is only used to convert a single integer to a string; use 'std::to_string' instead [performance-iostream-hot-path]
+std::string integer(int Id) {
+  std::ostringstream Stream;
+  Stream << Id;
+  return "id-" + Stream.str();
+}
+// CHECK-FIXES: {{^}}std::string integer(int Id) {
+// CHECK-FIXES-NEXT: {{^}}  return "id-" + std::to_string(Id);{{$}}
+
+void floatingPoint(double Ratio) {
+  std::ostringstream Stream;
+  // CHECK-MESSAGES: :[[@LINE-1]]:22: warning: string stream 'Stream' is only used to convert a single floating-point value to a string; use 'std::to_chars' instead
+  Stream << Ratio;
+  use(Stream.str());
+}
+
+int parse(const std::string *Lines, int N) {
+  int Sum = 0;
+  for (int I = 0; I < N; ++I) {
+    std::istringstream In(Lines[I]);
+    // CHECK-MESSAGES: :[[@LINE-1]]:24: warning: string stream 'In' is constructed in each loop iteration; declare it before the loop and reset it with 'str("")' and 'clear()'
+    int Value;
+    In >> Value;
+    Sum += Value;
+  }
+  return Sum;
+}
+
+// Negatives.
+
+void endlOutsideLoop(std::ostream &Out) {
+  Out << "done" << std::endl;
+  for (int I = 0; I < 2; ++I)
+    auto Lambda = [&] { Out << std::endl; };
+}
+
+void notSingleConversion(int Id, int Other) {
+  std::ostringstream Several;
+  Several << Id << Other;
+  use(Several.str());
+
+  std::ostringstream Text;
+  Text << "text";
+  use(Text.str());
+
+  std::ostringstream SideEffects;
+  SideEffects << Id++;
+  use(SideEffects.str());
+
+  std::ostringstream Reused;
+  Reused << Id;
+  use(Reused.str());
+  use(Reused.str());
+
+  std::wostringstream Wide;
+  Wide << Id;
+  Wide.str();
+}
+
+void staticStream(int N) {
+  for (int I = 0; I < N; ++I) {
+    static std::istringstream In;
+    int Value;
+    In >> Value;
+  }
+}
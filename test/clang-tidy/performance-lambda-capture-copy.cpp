@@ -0,0 +1,128 @@
+// RUN: %check_clang_tidy %s performance-lambda-capture-copy %t -- -- -std=c++14
+
+// CHECK-FIXES: #include <utility>
+
+namespace std {
+struct string {
+  string();
+  string(const string &);
+  string(string &&);
+  ~string();
+  string &operator=(const string &);
+  unsigned size() const;
+  void clear();
+};
+
+template <typename T> struct vector {
+  vector();
+  vector(const vector &);
+  ~vector();
+  T *begin();
+  T *end();
+  const T &operator[](unsigned) const;
+};
+
+template <typename It, typename F> F for_each(It First, It Last, F Fn);
+template <typename It, typename Out, typename F>
+Out transform(It First, It Last, Out Result, F Fn);
+} // namespace std
+
+void use(const std::string &);
+template <typename F> void submit(F Task);
+
+void byReference(int *First, int *Last) {
+  std::string Names;
+  [Names]() { use(Names); }();
+  // CHECK-MESSAGES: :[[@LINE-1]]:4: warning: 'Names' of type 'std::string' is copied into the lambda which only reads it; consider capturing it by reference [performance-lambda-capture-copy]
+  // CHECK-FIXES: {{^}}  [&Names]() { use(Names); }();{{$}}
+
+  std::for_each(First, Last, [=](int) { use(Names); });
+  // CHECK-MESSAGES: :[[@LINE-1]]:45: warning: 'Names' of type 'std::string' is copied into the lambda which only reads it; consider capturing it by reference
+  // CHECK-FIXES: {{^}}  std::for_each(First, Last, [=, &Names](int) { use(Names); });{{$}}
+
+  std::for_each(First, Last, [&, Names](int) { use(Names); });
+  // CHECK-MESSAGES: :[[@LINE-1]]:34: warning: 'Names' of type 'std::string' is copied
+  // CHECK-FIXES: {{^}}  std::for_each(First, Last, [&](int) { use(Names); });{{$}}
+
+  std::vector<int> Weights;
+  std::transform(First, Last, First, [Weights](int X) { return Weights[0] * X; });
+  // CHECK-MESSAGES: :[[@LINE-1]]:39: warning: 'Weights' of type 'std::vector<int>' is copied
+  // CHECK-FIXES: {{^}}  std::transform(First, Last, First, [&Weights](int X) { return Weights[0] * X; });{{$}}
+
+  std::string Title;
+  auto Print = [Title] { use(Title); };
+  // CHECK-MESSAGES: :[[@LINE-1]]:17: warning: 'Title' of type 'std::string' is copied into the lambda which only reads it; consider capturing it by reference
+  // CHECK-FIXES: {{^}}  auto Print = [&Title] { use(Title); };{{$}}
+  Print();
+  Print();
+}
+
+void byMove() {
+  std::string Names;
+  submit([Names] { use(Names); });
+  // CHECK-MESSAGES: :[[@LINE-1]]:11: warning: 'Names' of type 'std::string' is copied into the lambda which only reads it; consider moving it into an init-capture
+  // CHECK-FIXES: {{^}}  submit([Names = std::move(Names)] { use(Names); });{{$}}
+
+  std::string Title, Body;
+  submit([=] {
+    use(Title);
+    // CHECK-MESSAGES: :[[@LINE-1]]:9: warning: 'Title' of type 'std::string' is copied into the lambda which only reads it; consider moving it into an init-capture
+    use(Body);
+    // CHECK-MESSAGES: :[[@LINE-1]]:9: warning: 'Body' of type 'std::string' is copied
+  });
+  // CHECK-FIXES: {{^}}  submit([=, Title = std::move(Title), Body = std::move(Body)] {
+}
+
+// Negatives.
+
+void stillUsed() {
+  std::string Names;
+  submit([Names] { use(Names); });
+  use(Names);
+}
+
+void modifiedBeforeCall() {
+  std::for_each(First, Last, [&, Names](int) { use(Names); });
+  // CHECK-MESSAGES: :[[@LINE-1]]:34: warning: 'Names' of type 'std::string' is copied
+  // CHECK-FIXES: {{^}}  std::for_each(First, Last, [&](int) { use(Names); });{{$}}
+
+  std::vector<int> Weights;
+  std::transform(First, Last, First, [Weights](int X) { return Weights[0] * X; });
+  // CHECK-MESSAGES: :[[@LINE-1]]:39: warning: 'Weights' of type 'std::vector<int>' is copied
+  // CHECK-FIXES: {{^}}  std::transform(First, Last, First, [&Weights](int X) { return Weights[0] * X; });{{$}}
+
+  std::string Title;
+  auto Print = [Title] { use(Title); };
+  Title.clear();
+  Print();
+}
+
+void modifiedThroughArgument() {
+  std::vector<int> V;
+  std::transform(V.begin(), V.end(), V.begin(), [V](int X) { return V[0] + X; });
+}
+
+void modifiedInLambda() {
+  std::string Names;
+  submit([Names]() mutable { Names.clear(); });
+}
+
+void inLoop(int N) {
+  std::string Names;
+  for (int I = 0; I < N; ++I)
+    submit([Names] { use(Names); });
+}
+
+void aliased() {
+  std::string Names;
+  const std::string &Alias = Names;
+  submit([Names] { use(Names); });
+  use(Alias);
+}
+
+void cheapOrConst(int Value) {
+  const std::string Constant;
+  submit([Constant, Value] { use(Constant); return Value; });
+  std::string ByRef;
+  submit([&ByRef] { use(ByRef); });
+}
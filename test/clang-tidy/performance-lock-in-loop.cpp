@@ -0,0 +1,136 @@
+// RUN: %check_clang_tidy %s performance-lock-in-loop %t -- -- -std=c++11
+
+namespace std {
+struct mutex {
+  void lock();
+  void unlock();
+};
+
+template <typename Mutex> struct lock_guard {
+  explicit lock_guard(Mutex &);
+  ~lock_guard();
+};
+
+struct defer_lock_t {};
+template <typename Mutex> struct unique_lock {
+  explicit unique_lock(Mutex &);
+  unique_lock(Mutex &, defer_lock_t);
+  ~unique_lock();
+  void unlock();
+};
+
+template <typename T> struct vector {
+  void push_back(const T &);
+  unsigned size() const;
+};
+
+struct basic_ostream {
+  basic_ostream &operator<<(int);
+  basic_ostream &operator<<(const char *);
+};
+extern basic_ostream cout;
+} // namespace std
+
+int printf(const char *, ...);
+void process(int);
+
+struct Queue {
+  void drain(const std::vector<int> &Items) {
+    for (unsigned I = 0; I < Items.size(); ++I) {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: mutex 'Mutex' is locked and unlocked in each iteration of the loop; consider locking it once around the loop [performance-lock-in-loop]
+      Total += I;
+    }
+  }
+
+  void explicitLock(int N) {
+    while (N--) {
+      Mutex.lock();
+      // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: mutex 'Mutex' is locked
+      ++Total;
+      Mutex.unlock();
+    }
+  }
+
+  void log(int Value) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    // CHECK-MESSAGES: :[[@LINE+3]]:5: warning: call to 'printf' doesn't access state guarded by 'Mutex'; consider releasing the lock before it [performance-lock-in-loop]
+    // CHECK-MESSAGES: :[[@LINE-2]]:5: note: the critical section spans 2 statements
+    Total += Value;
+    printf("%d\n", Value);
+  }
+
+  void stream(int Value) {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    std::cout << "value: " << Value;
+    // CHECK-MESSAGES: :[[@LINE-1]]:5: warning: stream I/O doesn't access state guarded by 'Mutex'; consider acquiring the lock after it
+    Total += Value;
+    Lock.unlock();
+    std::cout << Total;
+  }
+
+  void allocate(int N) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    std::vector<int> Local;
+    Total = N;
+    for (int I = 0; I < N; ++I)
+    // CHECK-MESSAGES: :[[@LINE-1]]:5: warning: loop allocating memory doesn't access state guarded by 'Mutex'; consider releasing the lock before it
+      Local.push_back(I);
+  }
+
+  int Total;
+  std::mutex Mutex;
+};
+
+// Negatives.
+
+std::mutex Global;
+int Shared;
+
+void perIterationMutex(std::mutex *Mutexes, int N) {
+  for (int I = 0; I < N; ++I) {
+    std::lock_guard<std::mutex> Lock(Mutexes[I]);
+    ++Shared;
+  }
+}
+
+void notTheWholeBody(int N) {
+  for (int I = 0; I < N; ++I) {
+    process(I);
+    std::lock_guard<std::mutex> Lock(Global);
+    ++Shared;
+  }
+}
+
+void deferred(int N) {
+  for (int I = 0; I < N; ++I) {
+    std::unique_lock<std::mutex> Lock(Global, std::defer_lock_t());
+    ++Shared;
+  }
+}
+
+void accessesAfter(int Value) {
+  std::lock_guard<std::mutex> Lock(Global);
+  ++Shared;
+  printf("%d\n", Value);
+  ++Shared;
+}
+
+void unknownCall(int Value) {
+  std::lock_guard<std::mutex> Lock(Global);
+  ++Shared;
+  printf("%d\n", Value);
+  process(Value);
+}
+
+void guardedArgument() {
+  std::lock_guard<std::mutex> Lock(Global);
+  printf("%d\n", Shared);
+}
+
+void afterUnlock(int Value) {
+  Global.lock();
+  ++Shared;
+  Global.unlock();
+  printf("%d\n", Value);
+}
@@ -0,0 +1,107 @@
+// RUN: %check_clang_tidy %s performance-missing-noexcept-move %t -- -- -std=c++11
+
+namespace std {
+struct string {
+  string();
+  string(const string &);
+  string(string &&) noexcept;
+  ~string();
+  int Size;
+};
+
+template <typename T> struct allocator {};
+template <typename T, typename A = allocator<T>> struct vector {
+  T *Begin;
+};
+template <typename T, typename A = allocator<T>> struct deque {
+  T *Begin;
+};
+} // namespace std
+
+struct Legacy {
+  Legacy(const Legacy &);
+  Legacy(Legacy &&);
+  int Value;
+};
+
+struct Holder {
+  std::string Name;
+  Legacy Value;
+};
+
+std::vector<Holder> Holders;
+std::vector<Holder> MoreHolders;
+// CHECK-MESSAGES: :[[@LINE-7]]:8: warning: 'Holder' has no noexcept move constructor, so 'std::vector' copies its elements when it grows (8 bytes and 2 user-provided copy constructor calls per element) [performance-missing-noexcept-move]
+// CHECK-MESSAGES: :[[@LINE-3]]:{{[0-9]+}}: note: 'Holder' is used as an element type of 'std::vector' here
+// CHECK-MESSAGES: :[[@LINE-7]]:10: note: member 'Value' of type 'Legacy' has no noexcept move constructor
+// CHECK-MESSAGES: :[[@LINE-14]]:3: note: move constructor of 'Legacy' is not noexcept
+
+struct Logged {
+  ~Logged();
+  std::string Text;
+};
+
+void log() {
+  std::vector<Logged> Messages;
+}
+// CHECK-MESSAGES: :[[@LINE-8]]:8: warning: 'Logged' has no noexcept move constructor, so 'std::vector' copies its elements when it grows (4 bytes and 1 user-provided copy constructor call per element)
+// CHECK-MESSAGES: :[[@LINE-3]]:{{[0-9]+}}: note: 'Logged' is used as an element type of 'std::vector' here
+// CHECK-MESSAGES: :[[@LINE-9]]:3: note: 'Logged' has no move constructor because of this user-declared destructor, so it is copied instead
+// CHECK-MESSAGES: :[[@LINE-9]]:15: note: member 'Text' of type 'std::string' has no noexcept copy constructor
+// CHECK-MESSAGES: :[[@LINE-45]]:3: note: copy constructor of 'std::string' is not noexcept
+
+struct Base {
+  Base(const Base &);
+  Base(Base &&);
+};
+
+struct Derived : Base {
+  int X;
+};
+
+std::deque<Derived> Queue;
+// CHECK-MESSAGES: :[[@LINE-5]]:8: warning: 'Derived' has no noexcept move constructor, so 'std::deque' copies its elements in 'shrink_to_fit' (4 bytes and 1 user-provided copy constructor call per element)
+// CHECK-MESSAGES: :[[@LINE-2]]:{{[0-9]+}}: note: 'Derived' is used as an element type of 'std::deque' here
+// CHECK-MESSAGES: :[[@LINE-7]]:18: note: base class 'Base' has no noexcept move constructor
+// CHECK-MESSAGES: :[[@LINE-11]]:3: note: move constructor of 'Base' is not noexcept
+
+// Negatives.
+
+struct Good {
+  std::string Name;
+  int Values[4];
+};
+
+struct NoexceptMove {
+  NoexceptMove(const NoexceptMove &);
+  NoexceptMove(NoexceptMove &&) noexcept;
+};
+
+struct MoveOnly {
+  MoveOnly(MoveOnly &&);
+};
+
+struct Shape {
+  virtual ~Shape() = default;
+};
+
+struct Circle : Shape {
+  std::string Name;
+};
+
+struct Trivial {
+  Trivial(const Trivial &) = default;
+  int X;
+};
+
+struct NotInstantiated {
+  NotInstantiated(const NotInstantiated &);
+  NotInstantiated(NotInstantiated &&);
+};
+
+std::vector<Good> Goods;
+std::vector<NoexceptMove> NoexceptMoves;
+std::vector<MoveOnly> MoveOnlys;
+std::vector<Circle> Circles;
+std::deque<Trivial> Trivials;
+std::vector<NotInstantiated> *Pointer;
@@ -0,0 +1,232 @@
+// RUN: %check_clang_tidy %s performance-ordered-container-only-used-for-lookup %t
+
+// CHECK-FIXES: #include <unordered_map>
+// CHECK-FIXES: #include <unordered_set>
+
+namespace std {
+template <typename T> struct less {};
+template <typename T> struct allocator {};
+template <typename T> struct hash;
+template <typename T1, typename T2> struct pair {
+  T1 first;
+  T2 second;
+};
+
+template <> struct hash<int> {};
+
+struct string {
+  string(const char *);
+};
+template <> struct hash<string> {};
+
+template <typename Key, typename Value, typename Compare = less<Key>,
+          typename Alloc = allocator<pair<const Key, Value>>>
+struct map {
+  struct iterator {
+    pair<const Key, Value> *operator->() const;
+    iterator &operator++();
+    iterator &operator--();
+    bool operator==(const iterator &) const;
+    bool operator!=(const iterator &) const;
+  };
+  map();
+  map(const map &);
+  template <typename It> map(It, It);
+  Value &operator[](const Key &);
+  pair<iterator, bool> insert(const pair<const Key, Value> &);
+  iterator find(const Key &);
+  unsigned count(const Key &) const;
+  unsigned erase(const Key &);
+  iterator erase(iterator);
+  iterator begin();
+  iterator end();
+  iterator lower_bound(const Key &);
+  unsigned size() const;
+};
+
+template <typename Key, typename Compare = less<Key>,
+          typename Alloc = allocator<Key>>
+struct set {
+  struct iterator {
+    const Key &operator*() const;
+    iterator &operator++();
+    bool operator!=(const iterator &) const;
+  };
+  pair<iterator, bool> insert(const Key &);
+  iterator find(const Key &);
+  unsigned count(const Key &) const;
+  unsigned erase(const Key &);
+  iterator begin();
+  iterator end();
+  bool empty() const;
+};
+
+template <typename It> It next(It);
+} // namespace std
+
+struct Point {
+  int X, Y;
+};
+enum Color { Red, Green };
+
+void consume(const std::map<int, int> &);
+
+void lookups(int K) {
+  std::map<int, int> Counts;
+  // CHECK-MESSAGES: :[[@LINE-1]]:22: warning: 'Counts' is only used for lookups which don't depend on the ordering of its elements; consider using 'std::unordered_map' [performance-ordered-container-only-used-for-lookup]
+  // CHECK-FIXES: {{^}}  std::unordered_map<int, int> Counts;{{$}}
+  Counts[K] = 1;
+  Counts.erase(K);
+  if (Counts.find(K) != Counts.end())
+    Counts.insert({K, 2});
+  auto It = Counts.find(K);
+  if (It != Counts.end())
+    It->second = Counts.size();
+
+  std::set<Color> Seen;
+  // CHECK-MESSAGES: :[[@LINE-1]]:19: warning: 'Seen' is only used for lookups
+  // CHECK-FIXES: {{^}}  std::unordered_set<Color> Seen;{{$}}
+  if (!Seen.count(Red))
+    Seen.insert(Green);
+
+  std::map<std::string, int> Ids;
+  // CHECK-MESSAGES: :[[@LINE-1]]:30: warning: 'Ids' is only used for lookups
+  // CHECK-FIXES: {{^}}  std::unordered_map<std::string, int> Ids;{{$}}
+  Ids["a"] = 1;
+
+  std::set<Point *> Pointers;
+  // CHECK-MESSAGES: :[[@LINE-1]]:21: warning: 'Pointers' is only used
+  // CHECK-FIXES: {{^}}  std::unordered_set<Point *> Pointers;{{$}}
+  Pointers.insert(nullptr);
+}
+
+void noFix(int K) {
+  // No std::hash specialization for the key.
+  std::map<Point, int> Points;
+  // CHECK-MESSAGES: :[[@LINE-1]]:24: warning: 'Points' is only used
+  // CHECK-FIXES: {{^}}  std::map<Point, int> Points;{{$}}
+  Points.size();
+
+  typedef std::map<int, int> IntMap;
+  IntMap Aliased;
+  // CHECK-MESSAGES: :[[@LINE-1]]:10: warning: 'Aliased' is only used
+  // CHECK-FIXES: {{^}}  IntMap Aliased;{{$}}
+  Aliased[K] = K;
+
+  std::map<int, int> Spelled;
+  // CHECK-MESSAGES: :[[@LINE-1]]:22: warning: 'Spelled' is only used
+  // CHECK-FIXES: {{^}}  std::map<int, int> Spelled;{{$}}
+  std::map<int, int>::iterator SpelledIt = Spelled.find(K);
+  if (SpelledIt != Spelled.end())
+    SpelledIt->second = 0;
+}
+
+class Cache {
+public:
+  int get(int Key) {
+    auto It = Entries.find(Key);
+    return It != Entries.end() ? It->second : 0;
+  }
+  void put(int Key, int Value);
+
+private:
+  std::map<int, int> Entries;
+  // CHECK-MESSAGES: :[[@LINE-1]]:22: warning: 'Entries' is only used
+  // CHECK-FIXES: {{^}}  std::unordered_map<int, int> Entries;{{$}}
+};
+
+void Cache::put(int Key, int Value) { Entries[Key] = Value; }
+
+void insertAfterLastUse(int K) {
+  std::map<int, int> Values;
+  // CHECK-MESSAGES: :[[@LINE-1]]:22: warning: 'Values' is only used for lookups
+  // CHECK-FIXES: {{^}}  std::unordered_map<int, int> Values;{{$}}
+  auto It = Values.find(K);
+  if (It != Values.end())
+    It->second = K;
+  Values.insert({K, K});
+}
+
+// Negatives.
+
+void ordered(int K) {
+  std::map<int, int> Iterated;
+  Iterated[K] = K;
+  for (auto It = Iterated.begin(); It != Iterated.end(); ++It) {
+  }
+
+  std::set<int> RangeFor;
+  RangeFor.insert(K);
+  for (int I : RangeFor) {
+  }
+
+  std::map<int, int> Bounded;
+  Bounded.lower_bound(K);
+
+  std::map<int, int> Advanced;
+  auto It = Advanced.find(K);
+  ++It;
+
+  std::map<int, int> NextElement;
+  auto Found = NextElement.find(K);
+  std::next(Found);
+
+  std::map<int, int> LastElement;
+  --LastElement.end();
+
+  std::map<int, int> Passed;
+  consume(Passed);
+
+  std::map<int, int> Copied;
+  std::map<int, int> Copy(Copied);
+
+  std::map<int, int, std::less<long>> CustomComparator;
+  CustomComparator[K] = K;
+}
+
+void invalidated(int K, int L) {
+  std::map<int, int> InsertedAfterFind;
+  auto It = InsertedAfterFind.find(K);
+  InsertedAfterFind.insert({L, L});
+  It->second = 0;
+
+  std::map<int, int> InsertedInLoop;
+  auto Found = InsertedInLoop.find(K);
+  for (int I = 0; I < L; ++I) {
+    Found->second = I;
+    InsertedInLoop[I] = I;
+  }
+}
+
+void parameter(std::map<int, int> Param, int K) { Param[K] = K; }
+
+class Declared {
+public:
+  void put(int Key);
+  // Not defined in this translation unit.
+  void unknown();
+
+private:
+  std::map<int, int> Entries;
+};
+
+void Declared::put(int Key) { Entries[Key] = Key; }
+
+class WithFriend {
+  friend void peek(WithFriend &);
+  std::set<int> Keys;
+
+public:
+  void add(int K) { Keys.insert(K); }
+};
+
+class PublicField {
+public:
+  std::set<int> Keys;
+  void add(int K) { Keys.insert(K); }
+};
+
+template <typename T> void dependent(T K) {
+  std::map<int, int> Counts;
+  Counts[K] = 1;
+}
@@ -0,0 +1,136 @@
+// RUN: %check_clang_tidy %s performance-pass-small-trivial-by-value %t
+
+struct Point {
+  int X, Y;
+};
+
+struct Large {
+  int Data[16];
+};
+
+struct NonTrivial {
+  NonTrivial(const NonTrivial &);
+  int X;
+};
+
+int addOne(const int &I) {
+  // CHECK-MESSAGES: :[[@LINE-1]]:23: warning: the parameter 'I' of the trivially copyable type 'const int' is passed by const reference; consider passing it by value [performance-pass-small-trivial-by-value]
+  // CHECK-FIXES: {{^}}int addOne(const int I) {{{$}}
+  return I + 1;
+}
+
+int manhattan(const Point &A, const Point& B) {
+  // CHECK-MESSAGES: :[[@LINE-1]]:28: warning: the parameter 'A'
+  // CHECK-MESSAGES: :[[@LINE-2]]:44: warning: the parameter 'B'
+  // CHECK-FIXES: {{^}}int manhattan(const Point A, const Point B) {{{$}}
+  return A.X - B.X + A.Y - B.Y;
+}
+
+int unnamed(const double &) {
+  // CHECK-MESSAGES: :[[@LINE-1]]:27: warning: the parameter #1
+  // CHECK-FIXES: {{^}}int unnamed(const double ) {{{$}}
+  return 0;
+}
+
+int declaredFirst(const Point &P);
+// CHECK-FIXES: {{^}}int declaredFirst(const Point P);{{$}}
+
+int declaredFirst(const Point &P) {
+  // CHECK-MESSAGES: :[[@LINE-1]]:32: warning: the parameter 'P'
+  // CHECK-FIXES: {{^}}int declaredFirst(const Point P) {{{$}}
+  return P.X;
+}
+
+struct Widget {
+  int scale(const float &Factor) const;
+  // CHECK-FIXES: {{^}}  int scale(const float Factor) const;{{$}}
+  virtual void move(const Point &To);
+};
+
+int Widget::scale(const float &Factor) const {
+  // CHECK-MESSAGES: :[[@LINE-1]]:32: warning: the parameter 'Factor'
+  // CHECK-FIXES: {{^}}int Widget::scale(const float Factor) const {{{$}}
+  return static_cast<int>(Factor);
+}
+
+void Widget::move(const Point &To) {
+  // CHECK-MESSAGES: :[[@LINE-1]]:32: warning: the parameter 'To'
+  // CHECK-FIXES: {{^}}void Widget::move(const Point &To) {{{$}}
+}
+
+void referencedOutsideOfCall(const int &I) {
+  // CHECK-MESSAGES: :[[@LINE-1]]:41: warning: the parameter 'I'
+  // CHECK-FIXES: {{^}}void referencedOutsideOfCall(const int &I) {{{$}}
+}
+void (*FunctionPointer)(const int &) = referencedOutsideOfCall;
+
+// Negatives.
+
+int large(const Large &L) { return L.Data[0]; }
+
+int nonTrivial(const NonTrivial &N) { return N.X; }
+
+int nonConst(int &I) { return ++I; }
+
+const int &returnsReference(const int &I) { return I; }
+
+const int *returnsPointer(const int &I) { return &I; }
+
+const int *Global;
+void addressTaken(const int &I) { Global = &I; }
+
+void memberAddressTaken(const Point &P) { Global = &P.X; }
+
+void boundToReference(const Point &P) {
+  const int &X = P.X;
+  (void)X;
+}
+
+struct Holder {
+  Holder(const int &I) : Ref(I) {}
+  const int &Ref;
+};
+
+struct PointView {
+  PointView(const Point &P) : P(P) {}
+  const Point &P;
+};
+
+PointView makeView(const Point &P);
+
+struct Wrapper {
+  Wrapper(const Point &P) : View(P) {}
+  PointView View;
+};
+
+struct FactoryWrapper {
+  FactoryWrapper(const Point &P) : View(makeView(P)) {}
+  PointView View;
+};
+
+void capturedByLambda(const int &I) {
+  auto L = [&] { return I; };
+  (void)L;
+}
+
+struct Copyable {
+  Copyable(const Copyable &Other) : X(Other.X) {}
+  Copyable &operator=(const Copyable &Other) {
+    X = Other.X;
+    return *this;
+  }
+  int X;
+};
+
+struct Derived : Widget {
+  void move(const Point &To) override;
+};
+void Derived::move(const Point &To) {}
+
+template <typename T>
+T templated(const T &V) { return V; }
+int instantiate() { return templated(1); }
+
+void volatileParam(const volatile int &I) {}
+
+void arrayParam(const int (&A)[2]) {}
@@ -0,0 +1,136 @@
+// RUN: %check_clang_tidy %s performance-pessimizing-move-in-return %t -- -- -std=c++14
+
+namespace std {
+template <typename T>
+struct remove_reference {
+  typedef T type;
+};
+template <typename T>
+struct remove_reference<T &> {
+  typedef T type;
+};
+template <typename T>
+struct remove_reference<T &&> {
+  typedef T type;
+};
+
+template <typename T>
+constexpr typename remove_reference<T>::type &&move(T &&t);
+} // namespace std
+
+struct A {
+  A();
+  A(int);
+  A(const A &);
+  A(A &&);
+};
+
+struct Base {
+  Base();
+  Base(Base &&);
+};
+
+struct Derived : Base {};
+
+template <typename T>
+struct Ptr {
+  Ptr();
+  Ptr(Ptr &&);
+  template <typename U>
+  Ptr(Ptr<U> &&);
+};
+
+struct FromCopy {
+  FromCopy(const A &);
+};
+
+A makeA();
+
+A returnLocal() {
+  A a;
+  return std::move(a);
+  // CHECK-MESSAGES: :[[@LINE-1]]:10: warning: moving local object 'a' in return statement prevents copy elision; remove std::move() [performance-pessimizing-move-in-return]
+  // CHECK-FIXES: {{^  return a;$}}
+}
+
+A returnParam(A a) {
+  return std::move(a);
+  // CHECK-MESSAGES: :[[@LINE-1]]:10: warning: redundant move of 'a' in return statement; remove std::move()
+  // CHECK-FIXES: {{^  return a;$}}
+}
+
+Base returnSlice() {
+  Derived d;
+  return std::move(d);
+}
+
+Ptr<Base> returnConverted() {
+  Ptr<Derived> p;
+  return std::move(p);
+  // CHECK-MESSAGES: :[[@LINE-1]]:10: warning: redundant move of 'p' in return statement; remove std::move()
+  // CHECK-FIXES: {{^  return p;$}}
+}
+
+FromCopy returnConvertedByCopy() {
+  A a;
+  return std::move(a);
+}
+
+A returnTemporary() {
+  return std::move(A(1));
+  // CHECK-MESSAGES: :[[@LINE-1]]:10: warning: std::move of a temporary object prevents copy elision; remove std::move()
+  // CHECK-FIXES: {{^  return A\(1\);$}}
+}
+
+A returnCallResult() {
+  return std::move(makeA());
+  // CHECK-MESSAGES: :[[@LINE-1]]:10: warning: std::move of a temporary object
+  // CHECK-FIXES: {{^  return makeA\(\);$}}
+}
+
+void initializeFromTemporary() {
+  A a = std::move(makeA());
+  // CHECK-MESSAGES: :[[@LINE-1]]:9: warning: std::move of a temporary object
+  // CHECK-FIXES: {{^  A a = makeA\(\);$}}
+  A b(std::move(A()));
+  // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: std::move of a temporary object
+  // CHECK-FIXES: {{^  A b\(A\(\)\);$}}
+  A c = std::move(a);
+}
+
+A global;
+
+A returnGlobal() {
+  return std::move(global);
+}
+
+A returnReference(A &a) {
+  return std::move(a);
+}
+
+A returnVolatile() {
+  volatile A a;
+  return std::move(const_cast<A &>(a));
+}
+
+A returnCatchParameter() {
+  try {
+  } catch (A a) {
+    return std::move(a);
+  }
+  return A();
+}
+
+A returnCaptured() {
+  A a;
+  auto L = [a]() mutable { return std::move(a); };
+  return L();
+}
+
+template <typename T>
+T returnInTemplate() {
+  T t;
+  return std::move(t);
+}
+
+A instantiate() { return returnInTemplate<A>(); }
@@ -0,0 +1,156 @@
+// RUN: %check_clang_tidy %s performance-quadratic-erase-in-loop %t -- -- -std=c++14
+
+// CHECK-FIXES: #include <algorithm>
+
+namespace std {
+template <typename T> struct vector {
+  struct iterator {
+    T &operator*() const;
+    T *operator->() const;
+    iterator &operator++();
+    iterator &operator--();
+    iterator operator-(int) const;
+    bool operator!=(const iterator &) const;
+  };
+  iterator begin();
+  iterator end();
+  iterator erase(iterator);
+  iterator erase(iterator, iterator);
+  unsigned size() const;
+  bool empty() const;
+};
+
+template <typename T> struct deque {
+  typedef T *iterator;
+  iterator begin();
+  iterator end();
+  iterator erase(iterator);
+  bool empty() const;
+};
+
+template <typename T> T prev(T, int = 1);
+
+template <typename T> struct basic_string {
+  basic_string &erase(unsigned = 0, unsigned = -1);
+  unsigned size() const;
+  bool empty() const;
+  T operator[](unsigned) const;
+};
+typedef basic_string<char> string;
+} // namespace std
+
+struct Request {
+  bool Expired;
+  int Id;
+};
+
+bool isBad(int);
+
+void iteratorLoop(std::vector<Request> &Requests) {
+  for (auto It = Requests.begin(); It != Requests.end();) {
+    if (It->Expired)
+      It = Requests.erase(It);
+      // CHECK-MESSAGES: :[[@LINE-1]]:21: warning: 'erase' is called inside a loop over the same container, which has quadratic complexity; consider the erase-remove idiom [performance-quadratic-erase-in-loop]
+    else
+      ++It;
+  }
+  // CHECK-FIXES: {{^}}  Requests.erase(std::remove_if(Requests.begin(), Requests.end(), [&](auto &Element) { return Element.Expired; }), Requests.end());{{$}}
+}
+
+struct Queue {
+  void prune(int Limit) {
+    for (auto It = Items.begin(); It != Items.end();) {
+      if (isBad(*It) || *It > Limit) {
+        It = Items.erase(It);
+        // CHECK-MESSAGES: :[[@LINE-1]]:20: warning: 'erase' is called
+      } else {
+        ++It;
+      }
+    }
+    // CHECK-FIXES: {{^}}    Items.erase(std::remove_if(Items.begin(), Items.end(), [&](auto &Element) { return isBad(Element) || Element > Limit; }), Items.end());{{$}}
+  }
+  std::deque<int> Items;
+};
+
+void indexLoop(std::vector<int> &V, std::string &S) {
+  for (unsigned I = 0; I < V.size(); ++I)
+    if (isBad(I))
+      V.erase(V.begin());
+      // CHECK-MESSAGES: :[[@LINE-1]]:9: warning: 'erase' is called
+  unsigned I = 0;
+  while (I < S.size()) {
+    if (S[I] == ' ')
+      S.erase(I, 1);
+      // CHECK-MESSAGES: :[[@LINE-1]]:9: warning: 'erase' is called
+    else
+      ++I;
+  }
+}
+
+void iteratorUsedInCondition(std::vector<int> &V) {
+  for (auto It = V.begin(); It != V.end();) {
+    if (isBad(It != V.begin()))
+      It = V.erase(It);
+      // CHECK-MESSAGES: :[[@LINE-1]]:14: warning: 'erase' is called
+    else
+      ++It;
+  }
+  // CHECK-FIXES: {{^}}  for (auto It = V.begin(); It != V.end();) {{{$}}
+}
+
+void eraseFront(std::vector<int> &V) {
+  // Only a deque erases the first element in constant time.
+  while (!V.empty())
+    V.erase(V.begin());
+    // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'erase' is called
+}
+
+// Negatives.
+
+void eraseOnce(std::vector<int> &V) {
+  for (auto It = V.begin(); It != V.end(); ++It) {
+    if (*It == 0) {
+      V.erase(It);
+      break;
+    }
+  }
+  for (auto It = V.begin(); It != V.end(); ++It)
+    if (*It == 0)
+      return (void)V.erase(It);
+}
+
+void truncate(std::vector<int> &V, int N) {
+  for (int I = 0; I < N; ++I)
+    V.erase(V.begin(), V.end());
+}
+
+void otherContainer(std::vector<int> &V, std::vector<int> &W) {
+  for (auto It = V.begin(); It != V.end(); ++It)
+    W.erase(W.begin());
+}
+
+void process(int);
+
+void dequeEnds(std::deque<int> &Q) {
+  while (!Q.empty()) {
+    process(*Q.begin());
+    Q.erase(Q.begin());
+  }
+  while (!Q.empty())
+    Q.erase(Q.end() - 1);
+  while (!Q.empty())
+    Q.erase(std::prev(Q.end()));
+}
+
+void lastElement(std::vector<int> &V, std::string &S) {
+  while (!V.empty())
+    V.erase(V.end() - 1);
+  while (!V.empty())
+    V.erase(--V.end());
+  while (!V.empty())
+    V.erase(std::prev(V.end()));
+  while (!S.empty())
+    S.erase(S.size() - 1);
+  while (!S.empty())
+    S.erase(S.size() - 1, 1);
+}
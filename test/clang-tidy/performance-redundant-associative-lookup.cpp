@@ -0,0 +1,246 @@
+// RUN: %check_clang_tidy %s performance-redundant-associative-lookup %t -- -- -std=c++11
+
+namespace std {
+template <typename T1, typename T2>
+struct pair {
+  pair(const T1 &, const T2 &);
+  T1 first;
+  T2 second;
+};
+
+template <typename T1, typename T2>
+pair<T1, T2> make_pair(T1 First, T2 Second);
+
+template <typename K, typename V>
+struct map {
+  struct iterator {
+    pair<K, V> *operator->();
+    bool operator!=(const iterator &) const;
+    bool operator==(const iterator &) const;
+  };
+  V &operator[](const K &);
+  V &at(const K &);
+  iterator find(const K &);
+  unsigned long count(const K &) const;
+  iterator begin();
+  iterator end();
+  pair<iterator, bool> insert(const pair<K, V> &);
+  template <typename... Args>
+  pair<iterator, bool> try_emplace(const K &, Args &&...);
+  unsigned long erase(const K &);
+  void clear();
+};
+
+template <typename K>
+struct set {
+  struct iterator {
+    bool operator!=(const iterator &) const;
+    bool operator==(const iterator &) const;
+  };
+  iterator find(const K &) const;
+  unsigned long count(const K &) const;
+  iterator end() const;
+  pair<iterator, bool> insert(const K &);
+};
+} // namespace std
+
+void modify(std::map<int, int> &);
+void publish(std::map<int, int> *);
+std::map<int, int> &globalMap();
+void g();
+int next();
+
+int countThenSubscript(int K) {
+  std::map<int, int> M;
+  if (M.count(K))
+    return M[K];
+  // CHECK-MESSAGES: :[[@LINE-1]]:13: warning: redundant lookup of the same key in 'M'; use 'find' for the previous lookup and reuse the iterator [performance-redundant-associative-lookup]
+  // CHECK-MESSAGES: :[[@LINE-3]]:9: note: previous lookup of the key is here
+  return 0;
+}
+
+void countThenInsert(int K) {
+  std::map<int, int> M;
+  if (!M.count(K))
+    M[K] = 1;
+  // CHECK-MESSAGES: :[[@LINE-1]]:6: warning: redundant lookup of the same key in 'M'; use 'insert' or 'try_emplace', which only insert if the key is missing, instead of checking with 'count' first
+  // CHECK-MESSAGES: :[[@LINE-3]]:10: note: previous lookup of the key is here
+  std::set<int> S;
+  if (S.count(K) == 0)
+    S.insert(K);
+  // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: redundant lookup of the same key in 'S'; use 'insert' or 'try_emplace', which only insert if the key is missing, instead of checking with 'count' first
+  if (!S.count(K + 1)) {
+    S.insert(K + 1);
+  }
+  // CHECK-MESSAGES: :[[@LINE-2]]:7: warning: redundant lookup of the same key in 'S'; use 'insert'
+}
+// CHECK-FIXES: {{^}}void countThenInsert(int K) {
+// CHECK-FIXES-NEXT: {{^}}  std::map<int, int> M;
+// CHECK-FIXES-NEXT: {{^}}  M.try_emplace(K, 1);
+// CHECK-FIXES: {{^}}  std::set<int> S;
+// CHECK-FIXES-NEXT: {{^}}  S.insert(K);
+// CHECK-FIXES: {{^}}  S.insert(K + 1);{{$}}
+
+void countThenInsertWithoutFix(int K) {
+  std::map<int, int> M;
+  if (!M.count(K))
+    M[K] = next();
+  // CHECK-MESSAGES: :[[@LINE-1]]:6: warning: redundant lookup of the same key in 'M'; use 'insert'
+  if (!M.count(K + 1)) {
+    M[K + 1] = 1;
+    g();
+  }
+  // CHECK-MESSAGES: :[[@LINE-3]]:6: warning: redundant lookup of the same key in 'M'; use 'insert'
+}
+// CHECK-FIXES: {{^}}  if (!M.count(K)){{$}}
+// CHECK-FIXES-NEXT: {{^}}    M[K] = next();
+// CHECK-FIXES: {{^}}  if (!M.count(K + 1)) {
+// CHECK-FIXES-NEXT: {{^}}    M[K + 1] = 1;
+
+int countElseSubscript(int K) {
+  std::map<int, int> M;
+  if (M.count(K))
+    return 0;
+  else
+    return M[K];
+  // CHECK-MESSAGES: :[[@LINE-1]]:13: warning: redundant lookup of the same key in 'M'; use 'insert' or 'try_emplace'
+}
+
+int findThenAt(int K) {
+  std::map<int, int> M;
+  if (M.find(K) != M.end())
+    return M.at(K);
+  // CHECK-MESSAGES: :[[@LINE-1]]:14: warning: redundant lookup of the same key in 'M'; reuse the result of the previous 'find'
+  return 0;
+}
+
+void findThenInsert(int K) {
+  std::map<int, int> M;
+  if (M.find(K) == M.end())
+    M.insert(std::make_pair(K, 0));
+  // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: redundant lookup of the same key in 'M'; 'insert' doesn't replace an existing element and returns its position
+}
+
+bool insertThenFind(int K) {
+  std::set<int> S;
+  S.insert(K);
+  return S.find(K) != S.end();
+  // CHECK-MESSAGES: :[[@LINE-1]]:12: warning: redundant lookup of the same key in 'S'; reuse the result of the previous 'insert'
+}
+
+int subscriptTwice(int K) {
+  std::map<int, int> M;
+  M[K] = 1;
+  return M[K];
+  // CHECK-MESSAGES: :[[@LINE-1]]:11: warning: redundant lookup of the same key in 'M'; reuse the result of the previous 'operator[]'
+}
+
+int differentKeys(int K, int L) {
+  std::map<int, int> M;
+  if (M.count(K))
+    return M[L];
+  return 0;
+}
+
+int containerModified(int K) {
+  std::map<int, int> M;
+  if (M.count(K)) {
+    M.erase(K);
+    return M[K];
+  }
+  return 0;
+}
+
+int containerModifiedByCall(int K) {
+  std::map<int, int> M;
+  if (M.count(K)) {
+    modify(M);
+    return M[K];
+  }
+  return 0;
+}
+
+int modifiedThroughReference(int K) {
+  std::map<int, int> M;
+  std::map<int, int> &Alias = M;
+  if (M.count(K)) {
+    Alias.erase(K);
+    return M[K];
+  }
+  return 0;
+}
+
+int escapedAndCall(int K) {
+  std::map<int, int> M;
+  publish(&M);
+  if (M.count(K)) {
+    g();
+    return M[K];
+  }
+  return 0;
+}
+
+int escapedWithoutCall(int K) {
+  std::map<int, int> M;
+  publish(&M);
+  if (M.count(K))
+    return M[K];
+  // CHECK-MESSAGES: :[[@LINE-1]]:13: warning: redundant lookup of the same key in 'M'; use 'find'
+  return 0;
+}
+
+int callWithoutEscape(int K) {
+  std::map<int, int> M;
+  if (M.count(K)) {
+    g();
+    return M[K];
+  }
+  // CHECK-MESSAGES: :[[@LINE-2]]:13: warning: redundant lookup of the same key in 'M'; use 'find'
+  return 0;
+}
+
+int keyModified(int K) {
+  std::map<int, int> M;
+  if (M.count(K)) {
+    ++K;
+    return M[K];
+  }
+  return 0;
+}
+
+int conditionalFirstLookup(int K, bool B) {
+  std::map<int, int> M;
+  if (B)
+    M.find(K);
+  return M[K];
+}
+
+int notLocal(std::map<int, int> &M, int K) {
+  if (M.count(K))
+    return M[K];
+  return 0;
+}
+
+int localReference(int K) {
+  std::map<int, int> &M = globalMap();
+  if (M.count(K))
+    return M[K];
+  return 0;
+}
+
+int byValue(std::map<int, int> M, int K) {
+  if (M.count(K))
+    return M[K];
+  // CHECK-MESSAGES: :[[@LINE-1]]:13: warning: redundant lookup of the same key in 'M'; use 'find'
+  return 0;
+}
+
+template <typename T>
+int inTemplate(T K) {
+  std::map<T, int> M;
+  if (M.count(K))
+    return M[K];
+  return 0;
+}
+
+int instantiate() { return inTemplate(1); }
@@ -0,0 +1,116 @@
+// RUN: %check_clang_tidy %s performance-regex-or-locale-construction-in-loop %t
+
+namespace std {
+template <typename T> struct basic_string {
+  basic_string(const T *);
+  basic_string(const basic_string &);
+  const T *c_str() const;
+  void append(const T *);
+};
+typedef basic_string<char> string;
+template <typename T>
+basic_string<T> operator+(const basic_string<T> &, const T *);
+
+template <typename T> struct basic_regex {
+  basic_regex(const T *);
+  basic_regex(const basic_string<T> &);
+  basic_regex(const basic_regex &);
+};
+typedef basic_regex<char> regex;
+bool regex_match(const string &, const regex &);
+
+struct locale {
+  locale();
+  locale(const char *);
+  locale(const locale &);
+};
+
+template <typename T> struct basic_ostringstream {
+  basic_ostringstream();
+};
+typedef basic_ostringstream<char> ostringstream;
+
+struct random_device {
+  random_device(const string &Token = "default");
+  unsigned operator()();
+};
+} // namespace std
+
+const char *getPattern();
+void use(const std::locale &);
+void use(const std::ostringstream &);
+
+int literalPattern(const std::string *Lines, int N) {
+  int Count = 0;
+  for (int I = 0; I < N; ++I) {
+    std::regex Pattern("^[0-9]+$");
+    // CHECK-MESSAGES: :[[@LINE-1]]:16: warning: 'std::regex' is constructed in each loop iteration from loop-invariant arguments; construct it once before the loop or make it static [performance-regex-or-locale-construction-in-loop]
+    if (std::regex_match(Lines[I], Pattern))
+      ++Count;
+  }
+  return Count;
+}
+
+int parameterPattern(const std::string (&Lines)[4], const std::string &Suffix) {
+  int Count = 0;
+  for (const std::string &Line : Lines) {
+    if (std::regex_match(Line, std::regex(Suffix + "$")))
+      // CHECK-MESSAGES: :[[@LINE-1]]:32: warning: 'std::regex' is constructed
+      ++Count;
+  }
+  return Count;
+}
+
+void locales(int N) {
+  while (N--) {
+    std::locale Locale("C");
+    // CHECK-MESSAGES: :[[@LINE-1]]:17: warning: 'std::locale' is constructed
+    use(Locale);
+  }
+}
+
+unsigned nested(int N, int M) {
+  unsigned Sum = 0;
+  for (int I = 0; I < N; ++I)
+    for (int J = 0; J < M; ++J) {
+      std::random_device Device;
+      // CHECK-MESSAGES: :[[@LINE-1]]:26: warning: 'std::random_device' is constructed
+      Sum += Device();
+    }
+  return Sum;
+}
+
+// Negatives.
+
+int loopVariant(const std::string *Patterns, int N, std::string Pattern,
+                const std::string (&Names)[2]) {
+  int Count = 0;
+  for (int I = 0; I < N; ++I) {
+    std::regex FromLoopVariable(Patterns[I]);
+    std::string Local = Patterns[I];
+    std::regex FromLoopLocal(Local);
+    std::regex FromCall(getPattern());
+    std::regex FromModified(Pattern);
+    Pattern.append("x");
+  }
+  for (const std::string &P : Names)
+    std::regex FromRangeVariable(P);
+  return Count;
+}
+
+void stringStream(int N) {
+  do {
+    std::ostringstream Stream;
+    use(Stream);
+  } while (N++ < 10);
+}
+
+void notRepeated(int N) {
+  std::regex BeforeLoop("a+");
+  for (std::regex InInit("a+"); N > 0; --N) {
+    static const std::regex Static("a+");
+    std::regex Copy(BeforeLoop);
+    auto Lambda = [] { std::regex InLambda("a+"); };
+  }
+}
+
@@ -0,0 +1,177 @@
+// RUN: %check_clang_tidy %s performance-small-fixed-size-container %t -- -config="{CheckOptions: [{key: performance-small-fixed-size-container.SmallVectorType, value: 'llvm::SmallVector'}, {key: performance-small-fixed-size-container.SmallVectorHeader, value: 'llvm/ADT/SmallVector.h'}]}" -- -std=c++11
+
+// CHECK-FIXES-DAG: #include <array>
+// CHECK-FIXES-DAG: #include "llvm/ADT/SmallVector.h"
+
+namespace std {
+typedef decltype(sizeof(int)) size_t;
+
+template <typename T> class initializer_list {
+  const T *Begin;
+  size_t Size;
+
+public:
+  initializer_list();
+  size_t size() const;
+  const T *begin() const;
+  const T *end() const;
+};
+
+template <typename T> struct allocator {};
+
+template <typename T, typename Alloc = allocator<T>> class vector {
+public:
+  struct iterator {
+    T &operator*() const;
+    iterator &operator++();
+    bool operator!=(const iterator &) const;
+  };
+
+  vector();
+  explicit vector(size_t);
+  vector(size_t, const T &);
+  vector(initializer_list<T>);
+  vector(const vector &);
+  ~vector();
+
+  iterator begin();
+  iterator end();
+  void push_back(const T &);
+  template <typename... Args> void emplace_back(Args &&...);
+  void pop_back();
+  void clear();
+  void resize(size_t);
+  T &operator[](size_t);
+  const T &operator[](size_t) const;
+  size_t size() const;
+  bool empty() const;
+};
+} // namespace std
+
+struct Point {
+  Point(int, int);
+  int X, Y;
+};
+
+struct Big {
+  char Data[256];
+};
+
+void use(int);
+void consume(const std::vector<int> &);
+
+int initializerList() {
+  std::vector<int> Values = {1, 2, 3};
+  // CHECK-MESSAGES: :[[@LINE-1]]:20: warning: 'Values' never holds more than 3 elements but allocates them on the heap; consider using 'std::array<int, 3>' [performance-small-fixed-size-container]
+  // CHECK-FIXES: {{^}}  std::array<int, 3> Values = {1, 2, 3};{{$}}
+  int Sum = 0;
+  for (int V : Values)
+    Sum += V;
+  for (auto It = Values.begin(); It != Values.end(); ++It)
+    Sum += *It;
+  return Sum + Values[0] + Values.size();
+}
+
+bool constVector(char C) {
+  const std::vector<char> Vowels{'a', 'e'};
+  // CHECK-MESSAGES: :[[@LINE-1]]:27: warning: 'Vowels' never holds more than 2 elements but allocates them on the heap; consider using 'std::array<char, 2>'
+  // CHECK-FIXES: {{^}}  const std::array<char, 2> Vowels{'a', 'e'};{{$}}
+  return Vowels[0] == C || Vowels[1] == C;
+}
+
+void constantTripCount() {
+  std::vector<int> Squares;
+  // CHECK-MESSAGES: :[[@LINE-1]]:20: warning: 'Squares' never holds more than 8 elements but allocates them on the heap; consider using 'llvm::SmallVector<int, 8>'
+  // CHECK-FIXES: {{^}}  llvm::SmallVector<int, 8> Squares;{{$}}
+  for (int I = 0; I < 8; ++I)
+    Squares.push_back(I * I);
+  use(Squares[3]);
+}
+
+void nestedLoops() {
+  const int Rows = 3;
+  std::vector<Point> Grid;
+  // CHECK-MESSAGES: :[[@LINE-1]]:22: warning: 'Grid' never holds more than 12 elements
+  // CHECK-FIXES: {{^}}  llvm::SmallVector<Point, 12> Grid;{{$}}
+  for (int X = 0; X < Rows; ++X) {
+    for (int Y = 4; Y > 0; --Y)
+      Grid.emplace_back(X, Y);
+  }
+  use(Grid.size());
+}
+
+void branches(bool Flag) {
+  std::vector<int> Ids{1};
+  // CHECK-MESSAGES: :[[@LINE-1]]:20: warning: 'Ids' never holds more than 3 elements
+  // CHECK-FIXES: {{^}}  llvm::SmallVector<int, 3> Ids{1};{{$}}
+  if (Flag)
+    Ids.push_back(2);
+  Ids.push_back(3);
+  Ids.pop_back();
+}
+
+void count() {
+  std::vector<double> Weights(4);
+  // CHECK-MESSAGES: :[[@LINE-1]]:23: warning: 'Weights' never holds more than 4 elements
+  // CHECK-FIXES: {{^}}  llvm::SmallVector<double, 4> Weights(4);{{$}}
+  Weights[0] = 1;
+}
+
+void rangeLoop() {
+  int Input[5] = {};
+  std::vector<int> Copy;
+  // CHECK-MESSAGES: :[[@LINE-1]]:20: warning: 'Copy' never holds more than 5 elements
+  for (int I : Input)
+    Copy.push_back(I);
+  Copy.clear();
+}
+
+// Negatives.
+
+void unboundedLoop(int N) {
+  std::vector<int> V;
+  for (int I = 0; I < N; ++I)
+    V.push_back(I);
+
+  std::vector<int> W;
+  while (W.size() < 4)
+    W.push_back(0);
+}
+
+std::vector<int> escapes() {
+  std::vector<int> Passed = {1, 2};
+  consume(Passed);
+
+  std::vector<int> Copied = {1, 2};
+  std::vector<int> Copy(Copied);
+
+  std::vector<int> Resized = {1, 2};
+  Resized.resize(1);
+
+  std::vector<int> Spelled = {1, 2};
+  std::vector<int>::iterator It = Spelled.begin();
+
+  std::vector<int> Captured = {1, 2};
+  auto Lambda = [&] { Captured.push_back(3); };
+
+  std::vector<int> Returned = {1, 2};
+  return Returned;
+}
+
+void tooLarge() {
+  std::vector<Big> Blocks(8);
+  Blocks[0].Data[0] = 0;
+}
+
+void unsupported() {
+  std::vector<bool> Flags = {true, false};
+  Flags.size();
+
+  std::vector<int> Empty;
+  Empty.size();
+}
+
+template <typename T> void dependent(T Value) {
+  std::vector<T> Values = {Value};
+  Values.size();
+}
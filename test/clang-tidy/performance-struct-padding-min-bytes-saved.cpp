@@ -0,0 +1,18 @@
+// RUN: %check_clang_tidy %s performance-struct-padding %t -- -config="{CheckOptions: [{key: performance-struct-padding.MinBytesSaved, value: 16}]}" -- -std=c++11 -target x86_64-unknown-linux-gnu
+
+class SavesEight {
+  SavesEight();
+  char a;
+  double b;
+  char c;
+};
+
+class SavesSixteen {
+  // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'SavesSixteen' can shrink from 40 to 24 bytes by reordering its fields [performance-struct-padding]
+  SavesSixteen();
+  char a;
+  double b;
+  char c;
+  double d;
+  char e;
+};
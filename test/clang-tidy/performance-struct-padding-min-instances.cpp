@@ -0,0 +1,22 @@
+// RUN: %check_clang_tidy %s performance-struct-padding %t -- -config="{CheckOptions: [{key: performance-struct-padding.MinInstances, value: 4}]}" -- -std=c++11 -target x86_64-unknown-linux-gnu
+
+template <typename T> struct vector {};
+
+struct Rare {
+  char a;
+  double b;
+  char c;
+};
+
+Rare R;
+Rare *P = new Rare;
+
+struct Common {
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: 'Common' can shrink from 24 to 16 bytes by reordering its fields [performance-struct-padding]
+  char a;
+  double b;
+  char c;
+};
+
+Common Array[3];
+vector<Common> Elements;
@@ -0,0 +1,98 @@
+// RUN: %check_clang_tidy %s performance-struct-padding %t -- -- -std=c++11 -target x86_64-unknown-linux-gnu
+
+// Aggregates can be brace-initialized in other translation units, so they
+// aren't fixed.
+struct S {
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: 'S' can shrink from 24 to 16 bytes by reordering its fields [performance-struct-padding]
+  // CHECK-MESSAGES: :[[@LINE-2]]:8: note: suggested field order: d, i, c
+  char c;
+  double d;
+  int i;
+  // CHECK-FIXES: {{^  char c;$}}
+  // CHECK-FIXES-NEXT: {{^  double d;$}}
+  // CHECK-FIXES-NEXT: {{^  int i;$}}
+};
+
+S s = {'a', 1.0, 2};
+// CHECK-FIXES: {{^}}S s = {'a', 1.0, 2};
+
+class C {
+  // CHECK-MESSAGES: :[[@LINE-1]]:7: warning: 'C' can shrink from 24 to 16 bytes
+public:
+  C() : a(0), b(0), c(0) {}
+  // CHECK-FIXES: {{^}}  C() : b(0), a(0), c(0) {}
+  char a;
+  long b;
+  char c;
+  // CHECK-FIXES: {{^  long b;$}}
+  // CHECK-FIXES-NEXT: {{^  char a;$}}
+  // CHECK-FIXES-NEXT: {{^  char c;$}}
+};
+
+struct Access {
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: 'Access' can shrink from 24 to 16 bytes
+  // CHECK-MESSAGES: :[[@LINE-2]]:8: note: suggested field order: b, a, c
+  char a;
+private:
+  double b;
+public:
+  char c;
+};
+
+struct Multi {
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: 'Multi' can shrink from 24 to 16 bytes
+  // CHECK-MESSAGES: :[[@LINE-2]]:8: note: suggested field order: d, a, b, c
+  char a, b;
+  double d;
+  char c;
+};
+
+struct Derived : S {
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: 'Derived' can shrink from 48 to 40 bytes
+  char x;
+  double y;
+  char z;
+  // CHECK-FIXES: {{^  double y;$}}
+  // CHECK-FIXES-NEXT: {{^  char x;$}}
+  // CHECK-FIXES-NEXT: {{^  char z;$}}
+};
+
+// Negatives.
+
+struct Optimal {
+  double d;
+  int i;
+  char c;
+};
+
+struct TailPaddingOnly {
+  int i;
+  char c;
+};
+
+union U {
+  char c;
+  double d;
+  int i;
+};
+
+struct BitFields {
+  char c : 4;
+  double d;
+  int i : 3;
+};
+
+struct __attribute__((packed)) Packed {
+  char c;
+  double d;
+  int i;
+};
+
+template <typename T>
+struct Template {
+  char a;
+  T b;
+  char c;
+};
+
+Template<double> t;
@@ -0,0 +1,80 @@
+// RUN: %check_clang_tidy %s performance-temporary-string-materialization %t -- -config="{CheckOptions: [{key: performance-temporary-string-materialization.HotFunctions, value: '^parse$'}]}" --
+
+namespace std {
+template <typename T> struct allocator {};
+template <typename C, typename A = allocator<C>> struct basic_string {
+  basic_string();
+  basic_string(const C *, const A &Alloc = A());
+  basic_string(const basic_string &);
+  ~basic_string();
+  basic_string substr(unsigned Pos, unsigned Count) const;
+  basic_string &append(const basic_string &);
+  unsigned size() const;
+};
+typedef basic_string<char> string;
+
+bool operator==(const string &, const string &);
+} // namespace std
+
+struct StringView {
+  operator std::string() const;
+};
+
+bool isKeyword(const std::string &Word);
+void byValue(std::string Word);
+
+struct Token {
+  Token(const std::string &Text);
+};
+
+void loops(const char **Words, int N, const std::string &Line, StringView V) {
+  for (int I = 0; I < N; ++I) {
+    isKeyword(Words[I]);
+    // CHECK-MESSAGES: :[[@LINE-1]]:15: warning: implicit conversion from 'const char *' allocates a temporary std::string to bind to the const reference parameter 'Word' of 'isKeyword'; consider a std::string_view overload [performance-temporary-string-materialization]
+    // CHECK-MESSAGES: :23:36: note: parameter 'Word' declared here
+    isKeyword("for");
+    // CHECK-MESSAGES: :[[@LINE-1]]:15: warning: implicit conversion from 'const char *' allocates
+    isKeyword(Line.substr(I, 4));
+    // CHECK-MESSAGES: :[[@LINE-1]]:20: warning: 'substr' call allocates a temporary std::string to bind to the const reference parameter 'Word' of 'isKeyword'
+    isKeyword(V);
+    // CHECK-MESSAGES: :[[@LINE-1]]:15: warning: implicit conversion from 'StringView' allocates
+    Token T(Words[I]);
+    // CHECK-MESSAGES: :[[@LINE-1]]:13: warning: implicit conversion from 'const char *' allocates a temporary std::string to bind to the const reference parameter 'Text' of 'Token'
+  }
+
+  int I = 0;
+  while (I < N)
+    isKeyword(Words[I++]);
+  // CHECK-MESSAGES: :[[@LINE-1]]:15: warning: implicit conversion
+}
+
+void parse(const char *Word) {
+  isKeyword(Word);
+  // CHECK-MESSAGES: :[[@LINE-1]]:13: warning: implicit conversion
+}
+
+// Negatives.
+
+void outsideLoops(const char *Word, const std::string &Line) {
+  isKeyword(Word);
+  isKeyword(Line);
+}
+
+void noTemporary(const char **Words, int N, std::string &S) {
+  for (int I = 0; I < N; ++I) {
+    // Passing a string or an explicitly constructed one.
+    isKeyword(S);
+    isKeyword(std::string(Words[I]));
+    // The parameter is a copy anyway.
+    byValue(Words[I]);
+    // Members of std::string can't be overloaded.
+    S.append(Words[I]);
+  }
+}
+
+template <typename T> void instantiated(T Word) {
+  for (int I = 0; I < 3; ++I)
+    isKeyword(Word);
+}
+
+void use() { instantiated("a"); }
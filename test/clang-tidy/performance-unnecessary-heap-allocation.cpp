@@ -0,0 +1,157 @@
+// RUN: %check_clang_tidy %s performance-unnecessary-heap-allocation %t -- -- -std=c++14
+
+namespace std {
+template <typename T>
+struct remove_reference {
+  typedef T type;
+};
+template <typename T>
+struct remove_reference<T &> {
+  typedef T type;
+};
+
+template <typename T>
+typename remove_reference<T>::type &&move(T &&);
+
+template <typename T>
+class unique_ptr {
+public:
+  unique_ptr();
+  explicit unique_ptr(T *);
+  unique_ptr(unique_ptr &&);
+  template <typename U>
+  unique_ptr(unique_ptr<U> &&);
+  ~unique_ptr();
+  T *operator->() const;
+  T &operator*() const;
+  T *get() const;
+};
+
+template <typename T, typename... Args>
+unique_ptr<T> make_unique(Args &&... args);
+} // namespace std
+
+struct S {
+  S();
+  S(int, int);
+  void f();
+  int A, B;
+};
+
+struct Aggregate {
+  int A, B;
+};
+
+struct Big {
+  char Data[2048];
+};
+
+struct Base {
+  virtual ~Base();
+};
+struct Derived : Base {};
+
+void take(S &);
+void consume(std::unique_ptr<S>);
+
+int makeUnique() {
+  auto P = std::make_unique<S>(1, 2);
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: 'P' is allocated on the heap but doesn't escape the function; consider declaring it as an automatic object [performance-unnecessary-heap-allocation]
+  // CHECK-FIXES: {{^  S P\(1, 2\);$}}
+  return P->A + (*P).B;
+  // CHECK-FIXES: {{^  return P.A \+ \(P\).B;$}}
+}
+
+void makeUniqueNoArgs() {
+  auto P = std::make_unique<S>();
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: 'P' is allocated on the heap
+  // CHECK-FIXES: {{^  S P\{\};$}}
+  P->f();
+  // CHECK-FIXES: {{^  P.f\(\);$}}
+}
+
+void uniquePtrFromNew() {
+  std::unique_ptr<S> P(new S);
+  // CHECK-MESSAGES: :[[@LINE-1]]:22: warning: 'P' is allocated on the heap
+  // CHECK-FIXES: {{^  S P;$}}
+  P->f();
+  // CHECK-FIXES: {{^  P.f\(\);$}}
+}
+
+void rawPointer(int &Sum) {
+  Aggregate *P = new Aggregate{1, 2};
+  // CHECK-MESSAGES: :[[@LINE-1]]:14: warning: 'P' is allocated on the heap
+  // CHECK-FIXES: {{^  Aggregate P\{1, 2\};$}}
+  Sum = P->A + P->B;
+  delete P;
+}
+// CHECK-FIXES: {{^  Sum = P.A \+ P.B;$}}
+// CHECK-FIXES-NEXT: {{^}$}}
+
+S copy() {
+  auto P = std::make_unique<S>(1, 2);
+  // CHECK-MESSAGES: :[[@LINE-1]]:8: warning: 'P' is allocated on the heap
+  // CHECK-FIXES: {{^  S P\(1, 2\);$}}
+  P->A = 3;
+  return *P;
+}
+
+std::unique_ptr<S> returned() {
+  auto P = std::make_unique<S>(1, 2);
+  return P;
+}
+
+void moved() {
+  auto P = std::make_unique<S>(1, 2);
+  consume(std::move(P));
+}
+
+void passedByReference() {
+  auto P = std::make_unique<S>(1, 2);
+  take(*P);
+}
+
+S *get() {
+  auto P = std::make_unique<S>(1, 2);
+  return P.get();
+}
+
+void tooLarge() {
+  auto P = std::make_unique<Big>();
+  P->Data[0] = 0;
+}
+
+void differentType() {
+  std::unique_ptr<Base> P = std::make_unique<Derived>();
+}
+
+int notDeleted() {
+  S *P = new S(1, 2);
+  return P->A;
+}
+
+void deletedConditionally(bool B) {
+  S *P = new S(1, 2);
+  P->f();
+  if (B)
+    delete P;
+}
+
+int deletedBeforeEndOfScope() {
+  S *P = new S(1, 2);
+  int A = P->A;
+  delete P;
+  return A;
+}
+
+void captured() {
+  auto P = std::make_unique<S>(1, 2);
+  auto L = [&] { P->f(); };
+  L();
+}
+
+template <typename T>
+void inTemplate() {
+  auto P = std::make_unique<T>(1, 2);
+  P->f();
+}
@@ -29,6 +29,94 @@ TEST(ClangTidyDiagnosticConsumer, SortsErrors) {
   EXPECT_EQ("variable", Errors[1].Message.Message);
 }
 
+TEST(ClangTidyDiagnosticConsumer, CachesHeaderFilterDecisionsPerFile) {
+  std::vector<ClangTidyError> Errors;
+  ClangTidyOptions Options;
+  Options.HeaderFilterRegex = "a\\.h";
+  runCheckOnCode<TestCheck>("#include \"a.h\"\n"
+                            "#include \"b.h\"\n"
+                            "int c;",
+                            &Errors, "input.cc", None, Options,
+                            {{"a.h", "int a1;\nint a2;"},
+                             {"b.h", "int b1;\nint b2;"}});
+  ASSERT_EQ(6ul, Errors.size());
+  for (const ClangTidyError &Error : Errors)
+    EXPECT_FALSE(StringRef(Error.Message.FilePath).endswith("b.h"));
+  EXPECT_TRUE(StringRef(Errors[0].Message.FilePath).endswith("a.h"));
+  EXPECT_TRUE(StringRef(Errors[3].Message.FilePath).endswith("a.h"));
+  EXPECT_EQ("input.cc", Errors[5].Message.FilePath);
+}
+
+TEST(ClangTidyDiagnosticConsumer, SkipsSystemHeaders) {
+  std::vector<ClangTidyError> Errors;
+  ClangTidyOptions Options;
+  Options.HeaderFilterRegex = ".*";
+  runCheckOnCode<TestCheck>("#include <s.h>\nint c;", &Errors, "input.cc",
+                            {"-isystem", "include/sys"}, Options,
+                            {{"sys/s.h", "int s1;\nint s2;"}});
+  ASSERT_EQ(2ul, Errors.size());
+  EXPECT_EQ("input.cc", Errors[0].Message.FilePath);
+  EXPECT_EQ("input.cc", Errors[1].Message.FilePath);
+}
+
+TEST(ClangTidyDiagnosticConsumer, LineMarkersBypassFileCache) {
+  // The line marker turns the rest of the main file into a system header, so
+  // the decision cached for the first declaration must not be reused.
+  std::vector<ClangTidyError> Errors;
+  runCheckOnCode<TestCheck>("int c;\n"
+                            "# 1 \"remapped.h\" 1 3\n"
+                            "int d;",
+                            &Errors);
+  ASSERT_EQ(2ul, Errors.size());
+  EXPECT_EQ("type specifier", Errors[0].Message.Message);
+  EXPECT_EQ("variable", Errors[1].Message.Message);
+}
+
+namespace {
+class PerFileOptionsProvider : public ClangTidyOptionsProvider {
+public:
+  const ClangTidyGlobalOptions &getGlobalOptions() override {
+    return GlobalOptions;
+  }
+  std::vector<OptionsSource> getRawOptions(StringRef FileName) override {
+    ClangTidyOptions Options;
+    if (FileName.startswith("a/")) {
+      Options.Checks = "-*,misc-*";
+      Options.WarningsAsErrors = "misc-a";
+    } else {
+      Options.Checks = "-*,google-*";
+      Options.WarningsAsErrors = "";
+    }
+    return {OptionsSource(Options, "test")};
+  }
+
+private:
+  ClangTidyGlobalOptions GlobalOptions;
+};
+} // namespace
+
+TEST(ClangTidyContext, SharesFiltersBetweenFiles) {
+  ClangTidyContext Context(llvm::make_unique<PerFileOptionsProvider>());
+
+  Context.setCurrentFile("a/1.cc");
+  EXPECT_TRUE(Context.isCheckEnabled("misc-a"));
+  EXPECT_FALSE(Context.isCheckEnabled("google-a"));
+  EXPECT_TRUE(Context.treatAsError("misc-a"));
+
+  Context.setCurrentFile("b/1.cc");
+  EXPECT_FALSE(Context.isCheckEnabled("misc-a"));
+  EXPECT_TRUE(Context.isCheckEnabled("google-a"));
+  EXPECT_FALSE(Context.treatAsError("misc-a"));
+
+  // Switching back to a file with the same options reuses the filters, whose
+  // memoized results must still match the options of that file.
+  Context.setCurrentFile("a/2.cc");
+  EXPECT_TRUE(Context.isCheckEnabled("misc-a"));
+  EXPECT_FALSE(Context.isCheckEnabled("google-a"));
+  EXPECT_TRUE(Context.treatAsError("misc-a"));
+  EXPECT_FALSE(Context.treatAsError("misc-b"));
+}
+
 TEST(GlobList, Empty) {
   GlobList Filter("");
 
@@ -73,6 +161,21 @@ TEST(GlobList, WhitespacesAtBegin) {
   EXPECT_FALSE(Filter.contains("b.c"));
 }
 
+TEST(GlobList, MultipleWildcards) {
+  GlobList Filter("a*b*c,-*bb*, x**y");
+
+  EXPECT_TRUE(Filter.contains("abc"));
+  EXPECT_TRUE(Filter.contains("a-b-c"));
+  EXPECT_TRUE(Filter.contains("acbc"));
+  EXPECT_FALSE(Filter.contains("ab"));
+  EXPECT_FALSE(Filter.contains("abcd"));
+  EXPECT_FALSE(Filter.contains("abbc"));
+  EXPECT_TRUE(Filter.contains("xy"));
+  EXPECT_TRUE(Filter.contains("x.y"));
+  EXPECT_FALSE(Filter.contains("x"));
+  EXPECT_FALSE(Filter.contains("yx"));
+}
+
 TEST(GlobList, Complex) {
   GlobList Filter("*,-a.*, -b.*,   a.1.* ,-a.1.A.*,-..,-...,-..+,-*$, -*qwe* ");
 
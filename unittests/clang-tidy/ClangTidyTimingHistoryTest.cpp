@@ -0,0 +1,174 @@
+//===---- ClangTidyTimingHistoryTest.cpp - clang-tidy ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ClangTidy.h"
+#include "gtest/gtest.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+namespace clang {
+namespace tidy {
+namespace test {
+
+TEST(ParseShard, Valid) {
+  unsigned Index, Count;
+  EXPECT_TRUE(parseShard("0/1", Index, Count));
+  EXPECT_EQ(0u, Index);
+  EXPECT_EQ(1u, Count);
+  EXPECT_TRUE(parseShard(" 2 / 3 ", Index, Count));
+  EXPECT_EQ(2u, Index);
+  EXPECT_EQ(3u, Count);
+}
+
+TEST(ParseShard, Invalid) {
+  unsigned Index, Count;
+  EXPECT_FALSE(parseShard("", Index, Count));
+  EXPECT_FALSE(parseShard("1", Index, Count));
+  EXPECT_FALSE(parseShard("a/b", Index, Count));
+  EXPECT_FALSE(parseShard("-1/2", Index, Count));
+  EXPECT_FALSE(parseShard("0/0", Index, Count));
+  EXPECT_FALSE(parseShard("2/2", Index, Count));
+  EXPECT_FALSE(parseShard("1/2/3", Index, Count));
+}
+
+class ScheduleByCostTest : public ::testing::Test {
+protected:
+  void setCost(StringRef File, double Seconds) {
+    History.Seconds[getTimingHistoryKey(File)] = Seconds;
+  }
+
+  TranslationUnitTimings History;
+};
+
+TEST_F(ScheduleByCostTest, MostExpensiveFirst) {
+  setCost("a.cc", 1);
+  setCost("b.cc", 3);
+  setCost("c.cc", 2);
+  EXPECT_EQ(std::vector<std::string>({"b.cc", "c.cc", "a.cc"}),
+            scheduleByCost({"a.cc", "b.cc", "c.cc"}, History));
+}
+
+TEST_F(ScheduleByCostTest, UnknownFilesCostTheAverage) {
+  setCost("a.cc", 4);
+  setCost("b.cc", 2);
+  EXPECT_EQ(std::vector<std::string>({"a.cc", "c.cc", "b.cc"}),
+            scheduleByCost({"a.cc", "b.cc", "c.cc"}, History));
+}
+
+TEST_F(ScheduleByCostTest, NoHistoryKeepsNameOrder) {
+  EXPECT_EQ(std::vector<std::string>({"a.cc", "b.cc", "c.cc"}),
+            scheduleByCost({"c.cc", "a.cc", "b.cc"}, History));
+}
+
+TEST_F(ScheduleByCostTest, TiesUseNormalizedPath) {
+  setCost("/src/a.cc", 1);
+  setCost("/src/b.cc", 1);
+  // "/src/x/../a.cc" sorts after "/src/b.cc" as given, but it is "/src/a.cc".
+  EXPECT_EQ(std::vector<std::string>({"/src/x/../a.cc", "/src/b.cc"}),
+            scheduleByCost({"/src/b.cc", "/src/x/../a.cc"}, History));
+}
+
+TEST_F(ScheduleByCostTest, BalancesShardsByCost) {
+  setCost("a.cc", 8);
+  setCost("b.cc", 4);
+  setCost("c.cc", 4);
+  std::vector<std::string> Files = {"a.cc", "b.cc", "c.cc"};
+  EXPECT_EQ(std::vector<std::string>({"a.cc"}),
+            scheduleByCost(Files, History, 0, 2));
+  EXPECT_EQ(std::vector<std::string>({"b.cc", "c.cc"}),
+            scheduleByCost(Files, History, 1, 2));
+}
+
+TEST_F(ScheduleByCostTest, ShardsPartitionFiles) {
+  std::vector<std::string> Files;
+  for (unsigned I = 0; I < 10; ++I) {
+    Files.push_back("file" + std::to_string(I) + ".cc");
+    setCost(Files.back(), I % 4);
+  }
+  std::vector<std::string> All;
+  for (unsigned Shard = 0; Shard < 3; ++Shard) {
+    std::vector<std::string> ShardFiles =
+        scheduleByCost(Files, History, Shard, 3);
+    EXPECT_FALSE(ShardFiles.empty());
+    All.insert(All.end(), ShardFiles.begin(), ShardFiles.end());
+  }
+  std::sort(All.begin(), All.end());
+  std::vector<std::string> Expected = Files;
+  std::sort(Expected.begin(), Expected.end());
+  EXPECT_EQ(Expected, All);
+}
+
+class TimingHistoryFileTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(
+        llvm::sys::fs::createTemporaryFile("timing-history", "txt", Path));
+  }
+  void TearDown() override { llvm::sys::fs::remove(Path); }
+
+  SmallString<128> Path;
+};
+
+TEST_F(TimingHistoryFileTest, RoundTrip) {
+  TranslationUnitTimings Written;
+  Written.Seconds["/src/a.cc"] = 1.5;
+  Written.Seconds["/src/b.cc"] = 0.25;
+  ASSERT_FALSE(writeTimingHistory(Path, Written));
+
+  TranslationUnitTimings Read;
+  Read.Seconds["/src/c.cc"] = 3;
+  ASSERT_FALSE(readTimingHistory(Path, Read));
+  EXPECT_EQ(3u, Read.Seconds.size());
+  EXPECT_EQ(1.5, Read.Seconds.lookup("/src/a.cc"));
+  EXPECT_EQ(0.25, Read.Seconds.lookup("/src/b.cc"));
+  EXPECT_EQ(3, Read.Seconds.lookup("/src/c.cc"));
+}
+
+TEST_F(TimingHistoryFileTest, OverwritesExistingHistory) {
+  TranslationUnitTimings First;
+  First.Seconds["/src/a.cc"] = 1;
+  ASSERT_FALSE(writeTimingHistory(Path, First));
+  TranslationUnitTimings Second;
+  Second.Seconds["/src/b.cc"] = 2;
+  ASSERT_FALSE(writeTimingHistory(Path, Second));
+
+  TranslationUnitTimings Read;
+  ASSERT_FALSE(readTimingHistory(Path, Read));
+  EXPECT_EQ(1u, Read.Seconds.size());
+  EXPECT_EQ(2, Read.Seconds.lookup("/src/b.cc"));
+}
+
+TEST_F(TimingHistoryFileTest, IgnoresMalformedLines) {
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+    ASSERT_FALSE(EC);
+    OS << "garbage\n"
+       << "1.0\t/src/a.cc\r\n"
+       << "-1\t/src/negative.cc\n"
+       << "x\t/src/nan.cc\n"
+       << "2.5\n"
+       << "\n";
+  }
+  TranslationUnitTimings Read;
+  ASSERT_FALSE(readTimingHistory(Path, Read));
+  EXPECT_EQ(1u, Read.Seconds.size());
+  EXPECT_EQ(1.0, Read.Seconds.lookup("/src/a.cc"));
+}
+
+TEST(TimingHistory, MissingFile) {
+  TranslationUnitTimings Read;
+  EXPECT_TRUE(bool(readTimingHistory("/nonexistent/timing-history", Read)));
+  EXPECT_TRUE(Read.Seconds.empty());
+}
+
+} // namespace test
+} // namespace tidy
+} // namespace clang